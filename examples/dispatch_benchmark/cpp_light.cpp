@@ -0,0 +1,25 @@
+/**
+ * @file cpp_light.cpp
+ * @brief C++ light for the dispatch benchmark
+ *
+ * Same capabilities and callbacks as the C light in main.c, declared with
+ * the header-only C++ API.
+ */
+
+#include "sinricpro/sinricpro.hpp"
+
+extern "C" volatile int light_output;
+
+static sinricpro::Device light{
+    "000000000000000000000002", SINRICPRO_DEVICE_TYPE_LIGHT,
+    sinricpro::PowerState{[](bool &on) { light_output = on ? 100 : 0; return true; }},
+    sinricpro::Brightness{[](int &level) { light_output = level; return true; }},
+    sinricpro::ColorTemperature{[](int &kelvin) { light_output = kelvin; return true; }}};
+
+extern "C" sinricpro_device_t *cpp_light_device(void) {
+    return light.device();
+}
+
+extern "C" size_t cpp_light_size(void) {
+    return sizeof(light);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file main.c
+ * @brief SinricPro Action Dispatch Benchmark for Raspberry Pi Pico W
+ *
+ * Compares two ways of getting from an action string to its handler:
+ * - chain: strcmp against each supported action in turn (the old
+ *          per-device dispatch)
+ * - table: sinricpro_action_from_name() plus one handler table load
+ *
+ * For every action in the vocabulary it prints the average cost of both.
+ * The chain grows with the action's position in the list; the table stays
+ * flat, so adding actions to a device type does not slow dispatch.
+ *
+ * It then runs the same requests through a full light handler twice: the
+ * C light (capability routing, callbacks through function pointers) and
+ * the C++ light in cpp_light.cpp (constexpr handler table, inlined
+ * lambdas), and prints each device's static storage. For code size,
+ * compare the light functions in the build's .map file.
+ *
+ * No WiFi or SinricPro account needed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "sinricpro/sinricpro.h"
+#include "sinricpro/sinricpro_light.h"
+#include "sinricpro/sinricpro_capability.h"
+
+#define ITERATIONS  10000
+
+// =============================================================================
+// Dispatch Variants
+// =============================================================================
+
+static volatile uint32_t hits[SINRICPRO_ACTION_COUNT];
+
+static bool count_hit(sinricpro_device_t *device, const cJSON *request, cJSON *response) {
+    hits[(uintptr_t)device]++;
+    return true;
+}
+
+// Every action handled, as a device supporting the whole vocabulary would
+static sinricpro_action_handler_t handlers[SINRICPRO_ACTION_COUNT];
+
+static bool dispatch_chain(const char *action) {
+    for (int i = 1; i < SINRICPRO_ACTION_COUNT; i++) {
+        if (strcmp(action, sinricpro_action_name((sinricpro_action_t)i)) == 0) {
+            return count_hit((sinricpro_device_t *)(uintptr_t)i, NULL, NULL);
+        }
+    }
+    return false;
+}
+
+static bool dispatch_table(const char *action) {
+    sinricpro_action_t id = sinricpro_action_from_name(action, strlen(action));
+    sinricpro_action_handler_t handler = handlers[id];
+    return handler ? handler((sinricpro_device_t *)(uintptr_t)id, NULL, NULL) : false;
+}
+
+// =============================================================================
+// Device Handlers (C vs C++)
+// =============================================================================
+
+volatile int light_output;
+
+// cpp_light.cpp
+sinricpro_device_t *cpp_light_device(void);
+size_t cpp_light_size(void);
+
+static sinricpro_light_t c_light;
+
+static bool on_power_state(sinricpro_device_t *device, bool *state) {
+    light_output = *state ? 100 : 0;
+    return true;
+}
+
+static bool on_brightness(sinricpro_device_t *device, int *brightness) {
+    light_output = *brightness;
+    return true;
+}
+
+static bool on_color_temperature(sinricpro_device_t *device, int *color_temp) {
+    light_output = *color_temp;
+    return true;
+}
+
+static cJSON *request;
+static cJSON *response;
+
+static void handler_setup(void) {
+    sinricpro_light_init(&c_light, "000000000000000000000001");
+    sinricpro_light_on_power_state(&c_light, on_power_state);
+    sinricpro_light_on_brightness(&c_light, on_brightness);
+    sinricpro_light_on_color_temperature(&c_light, on_color_temperature);
+
+    request = cJSON_CreateObject();
+    cJSON *value = cJSON_AddObjectToObject(cJSON_AddObjectToObject(request, "payload"), "value");
+    cJSON_AddStringToObject(value, "state", "On");
+    cJSON_AddNumberToObject(value, "brightness", 50);
+    cJSON_AddNumberToObject(value, "colorTemperature", 4000);
+
+    response = cJSON_CreateObject();
+    cJSON_AddObjectToObject(response, "payload");
+}
+
+// Each handler adds the response value; drop it so every iteration starts equal
+static void response_reset(void) {
+    cJSON_DeleteItemFromObject(cJSON_GetObjectItem(response, "payload"), "value");
+}
+
+static uint32_t time_c_handler(sinricpro_action_t action) {
+    bool routed;
+    uint32_t start = time_us_32();
+    for (int i = 0; i < ITERATIONS; i++) {
+        sinricpro_device_route_request(&c_light.base, action, request, response, &routed);
+        response_reset();
+    }
+    return (uint32_t)(((uint64_t)(time_us_32() - start) * 1000) / ITERATIONS);
+}
+
+static uint32_t time_cpp_handler(sinricpro_action_t action) {
+    sinricpro_device_t *device = cpp_light_device();
+    uint32_t start = time_us_32();
+    for (int i = 0; i < ITERATIONS; i++) {
+        device->actions[action](device, request, response);
+        response_reset();
+    }
+    return (uint32_t)(((uint64_t)(time_us_32() - start) * 1000) / ITERATIONS);
+}
+
+static uint32_t time_ns(bool (*dispatch)(const char *), const char *action) {
+    uint32_t start = time_us_32();
+    for (int i = 0; i < ITERATIONS; i++) {
+        dispatch(action);
+    }
+    uint32_t elapsed_us = time_us_32() - start;
+    return (uint32_t)(((uint64_t)elapsed_us * 1000) / ITERATIONS);
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);  // Wait for USB serial
+
+    printf("\nSinricPro Action Dispatch Benchmark (%d iterations)\n\n", ITERATIONS);
+
+    for (int i = 1; i < SINRICPRO_ACTION_COUNT; i++) {
+        handlers[i] = count_hit;
+    }
+
+    printf("%-3s %-26s %10s %10s\n", "#", "action", "chain ns", "table ns");
+
+    uint32_t table_min = UINT32_MAX, table_max = 0;
+    for (int i = 1; i < SINRICPRO_ACTION_COUNT; i++) {
+        const char *action = sinricpro_action_name((sinricpro_action_t)i);
+        uint32_t chain = time_ns(dispatch_chain, action);
+        uint32_t table = time_ns(dispatch_table, action);
+
+        if (table < table_min) table_min = table;
+        if (table > table_max) table_max = table;
+
+        printf("%-3d %-26s %10lu %10lu\n", i, action,
+               (unsigned long)chain, (unsigned long)table);
+    }
+
+    uint32_t unknown_chain = time_ns(dispatch_chain, "notAnAction");
+    uint32_t unknown_table = time_ns(dispatch_table, "notAnAction");
+    printf("%-3s %-26s %10lu %10lu\n", "-", "(unknown)",
+           (unsigned long)unknown_chain, (unsigned long)unknown_table);
+
+    printf("\ntable spread: %lu..%lu ns across %d actions\n",
+           (unsigned long)table_min, (unsigned long)table_max,
+           SINRICPRO_ACTION_COUNT - 1);
+
+    // Full request handling, C light vs C++ light
+    handler_setup();
+
+    static const sinricpro_action_t light_actions[] = {
+        SINRICPRO_ACTION_SET_POWER_STATE,
+        SINRICPRO_ACTION_SET_BRIGHTNESS,
+        SINRICPRO_ACTION_ADJUST_BRIGHTNESS,
+        SINRICPRO_ACTION_SET_COLOR_TEMPERATURE,
+        SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE,
+    };
+
+    printf("\n%-26s %10s %10s\n", "light handler", "C ns", "C++ ns");
+    for (size_t i = 0; i < sizeof(light_actions) / sizeof(light_actions[0]); i++) {
+        uint32_t c = time_c_handler(light_actions[i]);
+        uint32_t cpp = time_cpp_handler(light_actions[i]);
+        printf("%-26s %10lu %10lu\n", sinricpro_action_name(light_actions[i]),
+               (unsigned long)c, (unsigned long)cpp);
+    }
+
+    printf("\nstorage: C light %u bytes, C++ light %u bytes\n",
+           (unsigned)sizeof(c_light), (unsigned)cpp_light_size());
+
+    while (1) {
+        tight_loop_contents();
+    }
+
+    return 0;
+}
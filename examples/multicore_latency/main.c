@@ -0,0 +1,245 @@
+/**
+ * @file main.c
+ * @brief SinricPro Dual-Core Latency Example for Raspberry Pi Pico W
+ *
+ * Measures how the network stack and the application interfere with each
+ * other under mixed load:
+ * - A slow PWM fade runs inside the power state callback
+ * - A simulated sensor read blocks the main loop every 100 ms
+ * - Network traffic (TLS records, pings, events) is serviced meanwhile
+ *
+ * Every 10 seconds it prints:
+ * - handle:  worst time spent inside sinricpro_handle() (GPIO reaction delay)
+ * - loop:    worst main loop period (how late a button press can be seen)
+ * - rx / tx: queue latency between the network and the application
+ *
+ * Build once with -DSINRICPRO_MULTICORE=OFF and once with ON and compare.
+ * With SINRICPRO_MULTICORE=ON, core 0 must not call cyw43/lwIP functions
+ * after sinricpro_begin() (the onboard LED is on the cyw43 chip, so this
+ * example uses GPIO 15 instead).
+ *
+ * Hardware:
+ * - Raspberry Pi Pico W
+ * - LED connected to GPIO 15 (PWM fade)
+ * - Button connected to GPIO 14 (optional)
+ */
+
+// Uncomment the following line to enable/disable sdk debug output
+// #define ENABLE_DEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+
+#include "sinricpro/sinricpro.h"
+#include "sinricpro/sinricpro_switch.h"
+
+// =============================================================================
+// Configuration - UPDATE THESE VALUES
+// =============================================================================
+
+#define WIFI_SSID       "YOUR_WIFI_SSID"
+#define WIFI_PASSWORD   "YOUR_WIFI_PASSWORD"
+
+// Get these from https://sinric.pro
+#define APP_KEY         "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+#define APP_SECRET      "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx-xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+#define DEVICE_ID       "xxxxxxxxxxxxxxxxxxxxxxxx"  // 24-character device ID
+
+// =============================================================================
+// Hardware / Load Configuration
+// =============================================================================
+
+#define LED_PIN             15      // PWM output
+#define BUTTON_PIN          14      // Physical button input
+#define FADE_STEPS          100     // PWM fade inside the callback
+#define FADE_STEP_US        400     // 100 x 400us = 40ms per fade
+#define SENSOR_PERIOD_MS    100     // Simulated sensor read period
+#define SENSOR_BLOCK_US     5000    // Simulated sensor read duration
+#define EVENT_PERIOD_MS     5000    // Send a state event this often
+#define REPORT_PERIOD_MS    10000   // Print measurements this often
+
+// =============================================================================
+// Global Variables
+// =============================================================================
+
+static sinricpro_switch_t my_switch;
+static bool current_state = false;
+
+// Measurement window
+static uint32_t max_handle_us = 0;
+static uint32_t max_loop_us = 0;
+static uint32_t callbacks = 0;
+
+// =============================================================================
+// Hardware Functions
+// =============================================================================
+
+static void init_hardware(void) {
+    gpio_set_function(LED_PIN, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(LED_PIN);
+    pwm_set_wrap(slice, 65535);
+    pwm_set_enabled(slice, true);
+    pwm_set_gpio_level(LED_PIN, 0);
+
+    gpio_init(BUTTON_PIN);
+    gpio_set_dir(BUTTON_PIN, GPIO_IN);
+    gpio_pull_up(BUTTON_PIN);
+}
+
+// Blocking fade, the kind of work that delays network servicing on one core
+static void fade_led(bool on) {
+    for (int i = 0; i <= FADE_STEPS; i++) {
+        int step = on ? i : FADE_STEPS - i;
+        pwm_set_gpio_level(LED_PIN, (uint16_t)((step * 65535) / FADE_STEPS));
+        busy_wait_us(FADE_STEP_US);
+    }
+}
+
+// =============================================================================
+// Callbacks
+// =============================================================================
+
+bool on_power_state(sinricpro_device_t *device, bool *state) {
+    callbacks++;
+    fade_led(*state);
+    current_state = *state;
+    return true;
+}
+
+// =============================================================================
+// WiFi Functions
+// =============================================================================
+
+static bool connect_wifi(void) {
+    if (cyw43_arch_init()) {
+        printf("ERROR: Failed to initialize WiFi hardware\n");
+        return false;
+    }
+
+    cyw43_arch_enable_sta_mode();
+
+    printf("Connecting to WiFi: %s\n", WIFI_SSID);
+    if (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD,
+                                           CYW43_AUTH_WPA2_AES_PSK, 30000) != 0) {
+        printf("ERROR: WiFi connection failed\n");
+        return false;
+    }
+
+    return true;
+}
+
+// =============================================================================
+// Reporting
+// =============================================================================
+
+static void print_report(void) {
+    sinricpro_stats_t stats;
+    sinricpro_get_stats(&stats);
+
+    printf("[Latency] mode=%s handle_max=%luus loop_max=%luus callbacks=%lu\n",
+           SINRICPRO_MULTICORE ? "dual-core" : "single-core",
+           (unsigned long)max_handle_us, (unsigned long)max_loop_us,
+           (unsigned long)callbacks);
+    printf("[Latency] rx avg=%luus max=%luus drop=%lu | tx avg=%luus max=%luus drop=%lu\n",
+           (unsigned long)stats.rx_latency_avg_us, (unsigned long)stats.rx_latency_max_us,
+           (unsigned long)stats.rx_dropped,
+           (unsigned long)stats.tx_latency_avg_us, (unsigned long)stats.tx_latency_max_us,
+           (unsigned long)stats.tx_dropped);
+
+    max_handle_us = 0;
+    max_loop_us = 0;
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);  // Wait for USB serial
+
+    printf("\nSinricPro Dual-Core Latency Example (%s)\n\n",
+           SINRICPRO_MULTICORE ? "SINRICPRO_MULTICORE=ON" : "SINRICPRO_MULTICORE=OFF");
+
+    init_hardware();
+
+    if (!connect_wifi()) {
+        while (1) tight_loop_contents();
+    }
+
+    sinricpro_config_t config = {
+        .app_key = APP_KEY,
+        .app_secret = APP_SECRET,
+        .use_ssl = true,    // TLS makes the network side CPU-heavy
+#ifdef ENABLE_DEBUG
+        .enable_debug = true
+#else
+        .enable_debug = false
+#endif
+    };
+
+    if (!sinricpro_init(&config) ||
+        !sinricpro_switch_init(&my_switch, DEVICE_ID)) {
+        printf("ERROR: Failed to initialize SinricPro\n");
+        while (1) tight_loop_contents();
+    }
+
+    sinricpro_switch_on_power_state(&my_switch, on_power_state);
+    sinricpro_add_device((sinricpro_device_t *)&my_switch);
+
+    if (!sinricpro_begin()) {
+        printf("ERROR: Failed to connect to SinricPro\n");
+        while (1) tight_loop_contents();
+    }
+
+    uint32_t last_loop = time_us_32();
+    uint32_t last_sensor = 0;
+    uint32_t last_event = 0;
+    uint32_t last_report = 0;
+
+    while (1) {
+        uint32_t loop_start = time_us_32();
+        uint32_t loop_us = loop_start - last_loop;
+        last_loop = loop_start;
+        if (loop_us > max_loop_us) max_loop_us = loop_us;
+
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+
+        // Network servicing (and, in single-core mode, TLS decryption)
+        uint32_t t0 = time_us_32();
+        sinricpro_handle();
+        uint32_t handle_us = time_us_32() - t0;
+        if (handle_us > max_handle_us) max_handle_us = handle_us;
+
+        // Simulated blocking sensor read
+        if (now - last_sensor >= SENSOR_PERIOD_MS) {
+            last_sensor = now;
+            busy_wait_us(SENSOR_BLOCK_US);
+        }
+
+        // Button toggles locally and reports the new state
+        if (!gpio_get(BUTTON_PIN)) {
+            current_state = !current_state;
+            fade_led(current_state);
+            sinricpro_switch_send_power_state_event(&my_switch, current_state);
+            while (!gpio_get(BUTTON_PIN)) tight_loop_contents();
+        }
+
+        // Periodic outgoing traffic
+        if (now - last_event >= EVENT_PERIOD_MS && sinricpro_is_connected()) {
+            last_event = now;
+            sinricpro_switch_send_power_state_event(&my_switch, current_state);
+        }
+
+        if (now - last_report >= REPORT_PERIOD_MS) {
+            last_report = now;
+            print_report();
+        }
+    }
+
+    return 0;
+}
@@ -56,6 +56,7 @@ extern "C" {
 #include <stdbool.h>
 #include "sinricpro_config.h"
 #include "sinricpro_device.h"
+#include "sinricpro_actions.h"
 
 /**
  * @brief Connection state
@@ -69,6 +70,23 @@ typedef enum {
     SINRICPRO_STATE_ERROR
 } sinricpro_state_t;
 
+/**
+ * @brief Which device states a snapshot publishes
+ */
+typedef enum {
+    SINRICPRO_SNAPSHOT_OFF = 0,
+    SINRICPRO_SNAPSHOT_CHANGED,     // Values the server hasn't confirmed
+    SINRICPRO_SNAPSHOT_ALL          // Every value
+} sinricpro_snapshot_mode_t;
+
+/**
+ * @brief Server endpoint for failover lists
+ */
+typedef struct {
+    const char *url;             // Hostname, e.g. "ws.sinric.pro"
+    uint16_t port;               // 0 = derive from use_ssl
+} sinricpro_server_t;
+
 /**
  * @brief SDK configuration structure
  *
@@ -79,6 +97,37 @@ typedef enum {
  * - Set use_ssl = true for secure WebSocket (wss://) on port 443 (default)
  * - Set use_ssl = false for plain WebSocket (ws://) on port 80
  * - Tip: Define SINRICPRO_NOSSL at the top of your sketch to default to non-secure mode
+ *
+ * Failover:
+ * - servers/server_count give an ordered list tried in turn; server_url is used when empty
+ * - warm_standby keeps a second transport connected so a dropped link is
+ *   replaced with only the HTTP upgrade instead of DNS + TCP + TLS. It
+ *   needs two distinct servers in the list and is ignored otherwise
+ *
+ * Express dispatch:
+ * - express_dispatch verifies and runs requests from the lwIP receive
+ *   callback and writes the response there, skipping the queue round trip
+ *   through sinricpro_handle(). Device callbacks then run inside the network
+ *   stack and must be short. Falls back to the queue when a write is in
+ *   progress or earlier messages are still queued. Ignored with
+ *   SINRICPRO_MULTICORE, where requests already leave the network core, and
+ *   when PICO_STACK_SIZE is below SINRICPRO_EXPRESS_STACK_SIZE. Callbacks
+ *   may not call sinricpro_handle() or sinricpro_stop() (ignored);
+ *   sinricpro_disconnect() takes effect on the next sinricpro_handle().
+ *
+ * State restore:
+ * - restore_states asks the server to send each device's last state after
+ *   connecting. The burst is applied one property per
+ *   SINRICPRO_RESTORE_APPLY_INTERVAL_MS once it settles, and each request
+ *   answered with the callback's result; the events device callbacks raise
+ *   while reporting a restored state are not sent back. A request from
+ *   another source, or repeating a property, ends the burst and is handled
+ *   at once.
+ *
+ * State snapshot:
+ * - snapshot_on_connect sends every capability's current value after each
+ *   connect (SINRICPRO_SNAPSHOT_ALL), or only values the server hasn't
+ *   confirmed (SINRICPRO_SNAPSHOT_CHANGED), see sinricpro_publish_snapshot().
  */
 typedef struct {
     // Credentials (required)
@@ -89,21 +138,214 @@ typedef struct {
     const char *server_url;      // Default: ws.sinric.pro
     uint16_t server_port;        // Default: 443 if use_ssl=true, 80 if use_ssl=false
     bool use_ssl;                // true = port 443 (secure), false = port 80 (non-secure)
+    const sinricpro_server_t *servers;  // Optional ordered failover list (max SINRICPRO_MAX_SERVERS)
+    size_t server_count;
+    bool warm_standby;           // Keep a pre-connected standby transport (default: false)
 
     // Connection settings (optional)
     uint32_t connect_timeout_ms;     // Default: 30000
     uint32_t ping_interval_ms;       // Default: 300000 (5 min)
     uint32_t reconnect_delay_ms;     // Default: 5000
 
+    // Request handling (optional)
+    bool express_dispatch;           // Handle requests in the receive callback (default: false)
+    bool restore_states;             // Ask the server for each device's last state (default: false)
+    sinricpro_snapshot_mode_t snapshot_on_connect;  // Publish device states (default: off)
+
     // Debug settings (optional)
     bool enable_debug;               // Enable WebSocket message logging (default: false)
 } sinricpro_config_t;
 
+/**
+ * @brief Event classes of the connection-wide event budget
+ *
+ * In priority order: alerts are released first, telemetry last. Responses
+ * to requests rank above all of them and never wait for the event budget.
+ */
+typedef enum {
+    SINRICPRO_EVENT_CLASS_ALERT = 0,    // Doorbell press, motion
+    SINRICPRO_EVENT_CLASS_STATE,        // Power, level, lock, contact...
+    SINRICPRO_EVENT_CLASS_TELEMETRY,    // Temperature, air quality, power usage readings
+    SINRICPRO_EVENT_CLASS_COUNT
+} sinricpro_event_class_t;
+
+/**
+ * @brief Request latency histogram buckets
+ *
+ * Bucket 0 counts requests answered in under 0.5 ms, bucket i under
+ * 0.5 ms << i; the last bucket counts everything slower.
+ */
+#define SINRICPRO_LATENCY_BUCKETS 10
+
+/**
+ * @brief Connection and failover statistics
+ */
+typedef struct {
+    uint8_t active_server;           // Index into the server list
+    bool standby_ready;              // Standby transport is connected
+    uint32_t failovers;              // Recoveries by promoting the standby
+    uint32_t cold_reconnects;        // Recoveries by a full reconnect
+    uint32_t connect_failures;       // Connect attempts that failed or timed out
+    uint32_t standby_drops;          // Standby connections lost while idle
+    uint32_t last_recovery_ms;       // Link loss to connected, most recent recovery
+    uint32_t reannounces;            // Reconnects to announce added devices
+
+    // Queue latency, push to pop (crosses cores with SINRICPRO_MULTICORE)
+    uint32_t rx_latency_avg_us;      // Network receive to request processing
+    uint32_t rx_latency_max_us;
+    uint32_t rx_dropped;             // Incoming messages lost to a full queue
+    uint32_t tx_latency_avg_us;      // Event/response queued to written to the socket
+    uint32_t tx_latency_max_us;
+    uint32_t tx_dropped;             // Outgoing messages lost to a full queue
+
+    // sinricpro_post_event()
+    uint32_t events_posted;          // Descriptors accepted into the ring
+    uint32_t events_dropped;         // Posts rejected because the ring was full
+
+    // Inbound pre-filter, before JSON parsing and HMAC verification
+    uint32_t rx_malformed;           // Unterminated strings or unbalanced brackets
+    uint32_t rx_not_request;         // Payload type other than "request"
+    uint32_t rx_unknown_device;      // deviceId not registered
+    uint32_t rx_unsupported_action;  // Action the device doesn't handle
+    uint32_t rx_rate_limited;        // Over SINRICPRO_RX_RATE_PER_SEC / SINRICPRO_RX_BURST
+    uint32_t rx_bad_signature;       // Passed the pre-filter, failed HMAC verification
+
+    // Response cache (retried requests answered without the device)
+    uint32_t reply_cache_hits;
+    uint32_t reply_cache_misses;
+    uint32_t reply_cache_expired;    // Retries that arrived after SINRICPRO_RESPONSE_CACHE_TTL_MS
+
+    // Connection-wide event budget, per sinricpro_event_class_t
+    uint32_t events_released[SINRICPRO_EVENT_CLASS_COUNT];
+    uint32_t events_shed[SINRICPRO_EVENT_CLASS_COUNT];          // Dropped by the class's policy
+    uint32_t events_coalesced[SINRICPRO_EVENT_CLASS_COUNT];     // Replaced by a newer value
+    uint32_t event_delay_avg_ms[SINRICPRO_EVENT_CLASS_COUNT];   // Sent to released for sending
+    uint32_t event_delay_max_ms[SINRICPRO_EVENT_CLASS_COUNT];
+
+    // sinricpro_defer_response()
+    uint32_t responses_deferred;
+    uint32_t responses_timed_out;    // Failed after SINRICPRO_PENDING_RESPONSE_TIMEOUT_MS
+    uint32_t deferrals_rejected;     // SINRICPRO_MAX_PENDING_RESPONSES already pending
+    uint32_t responses_dropped;      // Transmit queue full (the server retries)
+
+    // Server clock, synced from the timestamp sent on every connect
+    uint32_t clock_syncs;
+    uint32_t clock_steps;            // Corrections over SINRICPRO_CLOCK_STEP_MS
+    int32_t clock_drift_ppm;         // Estimated local timer rate error (+: runs slow)
+    int32_t clock_last_correction_ms;    // Server time minus the clock's estimate, last sync
+
+    // Server responses to sent events, see sinricpro_on_event_delivery()
+    uint32_t events_acked;
+    uint32_t events_rejected;        // Answered with success = false
+    uint32_t events_retransmitted;   // Sent again after a reconnect or SINRICPRO_EVENT_ACK_TIMEOUT_MS
+    uint32_t events_superseded;      // Unanswered, outdated by a newer value of the property
+    uint32_t events_unanswered;      // Given up after SINRICPRO_EVENT_MAX_ATTEMPTS sends
+    uint32_t event_ack_latency_avg_ms;   // First send to response
+    uint32_t event_ack_latency_max_ms;
+
+    // Server state restore after connecting (restore_states)
+    uint32_t restores_received;
+    uint32_t restores_coalesced;     // Replaced by a later request for the same property
+    uint32_t restores_applied;
+    uint32_t restore_echoes_dropped; // Events reporting a state just restored
+
+    // sinricpro_publish_snapshot() and snapshot_on_connect
+    uint32_t snapshots_started;
+    uint32_t snapshot_events;        // Values queued by snapshots
+
+    // Offline event journal (SINRICPRO_JOURNAL_ENABLED)
+    uint32_t journal_appended;
+    uint32_t journal_replayed;
+    uint32_t journal_compacted;      // Skipped for a newer value of the same property
+    uint32_t journal_lost;           // Overwritten before replay
+    uint32_t journal_corrupt;        // Records failing the CRC check
+
+    // Request received to response handed to the transport (express) or
+    // queued for it (normal path), see SINRICPRO_LATENCY_BUCKETS
+    uint32_t requests_express;
+    uint32_t requests_queued;
+    uint32_t latency_express[SINRICPRO_LATENCY_BUCKETS];
+    uint32_t latency_queued[SINRICPRO_LATENCY_BUCKETS];
+} sinricpro_stats_t;
+
+/**
+ * @brief Device registry storage
+ *
+ * Define with SINRICPRO_DEVICE_POOL_DEFINE() and pass to
+ * sinricpro_set_device_pool() to register more than SINRICPRO_MAX_DEVICES
+ * devices without growing the built-in registry.
+ */
+typedef struct {
+    sinricpro_device_t **devices;    // capacity entries
+    uint8_t *table;                  // table_size lookup slots
+    size_t capacity;
+    size_t table_size;               // Power of two, >= 2x capacity
+} sinricpro_device_pool_t;
+
+/**
+ * @brief Lookup slots needed for a pool of n devices
+ */
+#define SINRICPRO_DEVICE_POOL_TABLE_SIZE(n) \
+    ((n) <= 4 ? 8 : (n) <= 8 ? 16 : (n) <= 16 ? 32 : (n) <= 32 ? 64 : (n) <= 64 ? 128 : 256)
+
+#ifdef __cplusplus
+#define SINRICPRO_STATIC_ASSERT(cond, msg) static_assert(cond, msg)
+#else
+#define SINRICPRO_STATIC_ASSERT(cond, msg) _Static_assert(cond, msg)
+#endif
+
+/**
+ * @brief Define static registry storage for up to max_devices devices
+ *
+ * Example: SINRICPRO_DEVICE_POOL_DEFINE(relay_pool, 48);
+ *          sinricpro_set_device_pool(&relay_pool);
+ */
+#define SINRICPRO_DEVICE_POOL_DEFINE(name, max_devices) \
+    SINRICPRO_STATIC_ASSERT((max_devices) > 0 && (max_devices) <= SINRICPRO_DEVICE_POOL_MAX, \
+                            "Device pool size out of range"); \
+    static sinricpro_device_t *name##_devices[(max_devices)]; \
+    static uint8_t name##_table[SINRICPRO_DEVICE_POOL_TABLE_SIZE(max_devices)]; \
+    static sinricpro_device_pool_t name = { \
+        name##_devices, name##_table, (max_devices), sizeof(name##_table) \
+    }
+
+/**
+ * @brief Handle to a deferred response (see sinricpro_defer_response())
+ */
+typedef uint32_t sinricpro_pending_t;
+
+#define SINRICPRO_PENDING_NONE 0
+
 /**
  * @brief Connection state change callback
  */
 typedef void (*sinricpro_state_callback_t)(sinricpro_state_t state, void *user_data);
 
+/**
+ * @brief What became of a sent event
+ */
+typedef enum {
+    SINRICPRO_DELIVERY_ACKED = 0,       // The server accepted it
+    SINRICPRO_DELIVERY_REJECTED,        // The server answered success = false
+    SINRICPRO_DELIVERY_SUPERSEDED,      // Unanswered when a newer value of the property was sent
+    SINRICPRO_DELIVERY_FAILED           // Unanswered after SINRICPRO_EVENT_MAX_ATTEMPTS sends
+} sinricpro_delivery_status_t;
+
+/**
+ * @brief Event delivery callback
+ *
+ * @param device_id  Device ID of the event
+ * @param action     Event action name
+ * @param status     Outcome
+ * @param latency_ms First send to the server's response (ACKED and REJECTED only)
+ * @param user_data  User data given to sinricpro_on_event_delivery()
+ */
+typedef void (*sinricpro_delivery_callback_t)(const char *device_id,
+                                              const char *action,
+                                              sinricpro_delivery_status_t status,
+                                              uint32_t latency_ms,
+                                              void *user_data);
+
 /**
  * @brief Initialize SinricPro SDK
  *
@@ -135,6 +377,21 @@ bool sinricpro_begin(void);
  */
 void sinricpro_handle(void);
 
+/**
+ * @brief Process SinricPro events within a time budget
+ *
+ * Same work as sinricpro_handle(), split into units (one timeout, restore,
+ * snapshot value or journal entry, one received message, one posted event,
+ * one outgoing frame) and stopped once budget_us has been used; the next
+ * call resumes where this one stopped. Network polling and
+ * at least one unit always run, so a call can overrun the budget by one
+ * unit (a request with its HMAC and device callback is the largest).
+ *
+ * @param budget_us Time budget in microseconds
+ * @return Units of work still waiting (0 when everything was processed)
+ */
+size_t sinricpro_handle_budget(uint32_t budget_us);
+
 /**
  * @brief Disconnect from SinricPro
  *
@@ -149,17 +406,40 @@ void sinricpro_disconnect(void);
  */
 void sinricpro_stop(void);
 
+/**
+ * @brief Use caller-supplied storage for the device registry
+ *
+ * Call after sinricpro_init(). Devices already registered are moved into
+ * the pool. Without a pool, the built-in registry holds
+ * SINRICPRO_MAX_DEVICES devices.
+ *
+ * @param pool Pool defined with SINRICPRO_DEVICE_POOL_DEFINE()
+ *             (must remain valid for SDK lifetime)
+ * @return true on success, false if the pool is invalid or too small
+ */
+bool sinricpro_set_device_pool(sinricpro_device_pool_t *pool);
+
 /**
  * @brief Add a device to SinricPro
  *
+ * May be called while connected. The server only learns about devices
+ * from the connection handshake, so once additions settle for
+ * SINRICPRO_REANNOUNCE_DELAY_MS the connection is re-established to
+ * announce them (using the warm standby when available).
+ *
  * @param device Device to add (must remain valid for SDK lifetime)
- * @return true on success, false if max devices reached
+ * @return true on success, false if the registry is full
  */
 bool sinricpro_add_device(sinricpro_device_t *device);
 
 /**
  * @brief Remove a device from SinricPro
  *
+ * Constant time: the last device takes the freed position. Does not
+ * reconnect; requests for the removed device are ignored. Its events not
+ * yet sent are dropped and its deferred responses are answered with
+ * failure. Call from core 0 (the sinricpro_handle() side).
+ *
  * @param device_id Device ID to remove
  * @return true if found and removed, false otherwise
  */
@@ -194,6 +474,14 @@ sinricpro_state_t sinricpro_get_state(void);
  */
 bool sinricpro_is_connected(void);
 
+/**
+ * @brief Get connection statistics
+ *
+ * @param stats Output structure
+ * @return true on success, false if SDK not initialized
+ */
+bool sinricpro_get_stats(sinricpro_stats_t *stats);
+
 /**
  * @brief Set state change callback
  *
@@ -202,10 +490,23 @@ bool sinricpro_is_connected(void);
  */
 void sinricpro_on_state_change(sinricpro_state_callback_t callback, void *user_data);
 
+/**
+ * @brief Set event delivery callback
+ *
+ * Called once for every event sent to the server, when its response
+ * arrives or it is given up. Events dropped before they were sent (event
+ * budget policies, a full queue) are not reported.
+ *
+ * @param callback Callback function
+ * @param user_data User data passed to callback
+ */
+void sinricpro_on_event_delivery(sinricpro_delivery_callback_t callback, void *user_data);
+
 /**
  * @brief Send a raw event message
  *
- * Typically use device-specific event functions instead.
+ * Typically use device-specific event functions instead. The event waits
+ * for the connection-wide event budget (see sinricpro_event_class_t).
  *
  * @param device_id Device ID
  * @param action Event action name
@@ -214,6 +515,97 @@ void sinricpro_on_state_change(sinricpro_state_callback_t callback, void *user_d
  */
 bool sinricpro_send_event(const char *device_id, const char *action, cJSON *value_json);
 
+/**
+ * @brief Set the capture time of the next event
+ *
+ * Events are stamped (createdAt) with the time they were measured, not the
+ * time they are sent. By default that is when sinricpro_send_event() is
+ * called; call this first when the value was read earlier, e.g. a sensor
+ * sampled before a slow computation. Applies to the next
+ * sinricpro_send_event() (and so the next device send function) only, and
+ * is cleared by sinricpro_handle().
+ *
+ * @param captured_us time_us_64() when the value was measured, 0 for now
+ */
+void sinricpro_set_capture_time(uint64_t captured_us);
+
+/**
+ * @brief Get server-synchronized time
+ *
+ * The 64-bit local timer mapped to server time, with millisecond
+ * resolution and corrected for the measured clock drift.
+ *
+ * @return Unix time in milliseconds, or 0 until server time has arrived
+ */
+uint64_t sinricpro_get_time_ms(void);
+
+/**
+ * @brief Publish the current state of every device
+ *
+ * Queues one event per capability value: SET_POWER_STATE, levels, color,
+ * lock and door state, motion and contact. With SINRICPRO_SNAPSHOT_CHANGED,
+ * only values whose last event the server hasn't acknowledged (or, for
+ * requests, answered successfully) are sent; at boot that is all of them.
+ * Values go through the connection-wide event budget, not the capability
+ * rate limits, a few at a time from sinricpro_handle(). A capability with
+ * a rate-limited value waiting sends that value instead. Restarts a
+ * snapshot still in progress.
+ *
+ * @param mode Values to publish
+ * @return false if not connected or mode is SINRICPRO_SNAPSHOT_OFF
+ */
+bool sinricpro_publish_snapshot(sinricpro_snapshot_mode_t mode);
+
+/**
+ * @brief Post an event from any context
+ *
+ * Safe to call from GPIO interrupt handlers and from either core. Only a
+ * small binary descriptor is recorded; sinricpro_handle() later builds the
+ * JSON, signs it and sends it, using the capture time as createdAt.
+ * Posted events share a per-device state-rate limiter, applied when the
+ * event is expanded.
+ *
+ * @param device Registered device
+ * @param action Event action (see sinricpro_event_value_t for the value used)
+ * @param value  Event value, or NULL for DOORBELL_PRESS
+ * @return true if recorded, false if the ring is full or arguments are invalid
+ */
+bool sinricpro_post_event(const sinricpro_device_t *device,
+                          sinricpro_action_t action,
+                          const sinricpro_event_value_t *value);
+
+/**
+ * @brief Defer the response to the request being handled
+ *
+ * Call from a device request callback whose action takes longer than the
+ * loop can wait (a door or lock moving). The callback's return value is
+ * then ignored and no response is sent until sinricpro_complete_response();
+ * the value the callback filled in is kept. Unanswered responses are sent
+ * with success = false after SINRICPRO_PENDING_RESPONSE_TIMEOUT_MS. Server
+ * retries of a pending request are dropped.
+ *
+ * @param device Device whose callback is running
+ * @return Handle, or SINRICPRO_PENDING_NONE when not called from that
+ *         device's request callback, while applying a restored state, or
+ *         when too many responses are pending (the response is then sent
+ *         normally)
+ */
+sinricpro_pending_t sinricpro_defer_response(const sinricpro_device_t *device);
+
+/**
+ * @brief Send a deferred response
+ *
+ * Call from the same context as sinricpro_handle(), after the request
+ * callback has returned.
+ *
+ * @param handle  Handle from sinricpro_defer_response()
+ * @param success Outcome of the action
+ * @param value   Final response value (ownership taken), or NULL to keep
+ *                the value set by the callback
+ * @return false if the handle is unknown or already completed/timed out
+ */
+bool sinricpro_complete_response(sinricpro_pending_t handle, bool success, cJSON *value);
+
 /**
  * @brief Get SDK version string
  *
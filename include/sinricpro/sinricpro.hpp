@@ -0,0 +1,609 @@
+/**
+ * @file sinricpro.hpp
+ * @brief Header-only C++17 API for SinricPro devices
+ *
+ * Devices are compositions of capabilities fixed at compile time. Each
+ * capability carries its callback (usually a lambda) in its type, so the
+ * callback is called directly and can be inlined; the device's handler
+ * table is a constexpr array built from the capabilities' actions. No
+ * storage is allocated: a device is one static object holding the C core's
+ * sinricpro_device_t plus each capability's state.
+ *
+ * Requests and events use the same wire format as the C capabilities.
+ *
+ * @code
+ * static sinricpro::Device light{
+ *     DEVICE_ID, SINRICPRO_DEVICE_TYPE_LIGHT,
+ *     sinricpro::PowerState{[](bool &on) { gpio_put(LED_PIN, on); return true; }},
+ *     sinricpro::Brightness{[](int &level) { pwm_set(level); return true; }}};
+ *
+ * sinricpro_init(&config);
+ * light.add();
+ * light.send<sinricpro::PowerState>(true);
+ * @endcode
+ */
+
+#ifndef SINRICPRO_HPP
+#define SINRICPRO_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <strings.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "sinricpro.h"
+#include "sinricpro_actions.h"
+#include "event_limiter.h"
+#include "capabilities/color.h"
+#include "cJSON.h"
+
+namespace sinricpro {
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+/**
+ * @brief Callback type for capabilities constructed without a callback
+ */
+struct NoCallback {};
+
+namespace detail {
+
+inline const cJSON *request_value(const cJSON *request) {
+    const cJSON *payload = cJSON_GetObjectItem(request, "payload");
+    return payload ? cJSON_GetObjectItem(payload, "value") : nullptr;
+}
+
+inline cJSON *response_value(cJSON *response) {
+    cJSON *payload = cJSON_GetObjectItem(response, "payload");
+    if (!payload) return nullptr;
+
+    cJSON *value = cJSON_GetObjectItem(payload, "value");
+    if (!value) {
+        value = cJSON_AddObjectToObject(payload, "value");
+    }
+    return value;
+}
+
+inline bool get_int(const cJSON *object, const char *key, int &out) {
+    const cJSON *item = object ? cJSON_GetObjectItem(object, key) : nullptr;
+    if (!item || !cJSON_IsNumber(item)) return false;
+    out = item->valueint;
+    return true;
+}
+
+constexpr int clamp(int value, int lo, int hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// Call the user callback; capabilities without one accept every request
+template <typename F, typename... Args>
+inline bool invoke(F &callback, Args &... args) {
+    if constexpr (std::is_same_v<F, NoCallback>) {
+        return true;
+    } else {
+        return callback(args...);
+    }
+}
+
+// Rate-limited send of a value built by the capability (ownership passes on)
+inline bool send(sinricpro_event_limiter_t &limiter,
+                 const char *device_id,
+                 sinricpro_action_t action,
+                 cJSON *value) {
+    if (!value) return false;
+    if (sinricpro_event_limiter_check(&limiter)) {
+        cJSON_Delete(value);
+        return false;
+    }
+    return sinricpro_send_event(device_id, sinricpro_action_name(action), value);
+}
+
+// State kept by every capability: its callback and its event limiter
+template <typename F>
+class Base {
+public:
+    explicit Base(F callback, bool sensor = false) : callback_(std::move(callback)) {
+        if (sensor) {
+            sinricpro_event_limiter_init_sensor(&limiter_);
+        } else {
+            sinricpro_event_limiter_init_state(&limiter_);
+        }
+    }
+
+protected:
+    F callback_;
+    sinricpro_event_limiter_t limiter_;
+};
+
+// Shared set/adjust handling for 0..100 levels (brightness, power level, range)
+template <typename F>
+class Level : public Base<F> {
+public:
+    using Base<F>::Base;
+
+    int value() const { return value_; }
+
+protected:
+    bool handle_level(const cJSON *request, cJSON *response,
+                      const char *key, const char *delta_key, bool adjust) {
+        const cJSON *value = request_value(request);
+
+        int level;
+        if (adjust) {
+            int delta = 0;
+            get_int(value, delta_key, delta);
+            level = value_ + delta;
+        } else if (!get_int(value, key, level)) {
+            return false;
+        }
+
+        // Adjustments are applied here, so the callback always sees the new level
+        level = clamp(level, 0, 100);
+        bool success = invoke(this->callback_, level);
+        level = clamp(level, 0, 100);
+        if (success) {
+            value_ = level;
+        }
+
+        cJSON *resp_value = response_value(response);
+        if (resp_value) {
+            cJSON_AddNumberToObject(resp_value, key, level);
+        }
+        return success;
+    }
+
+    bool send_level(const char *device_id, sinricpro_action_t action, const char *key, int level) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddNumberToObject(value, key, clamp(level, 0, 100));
+        }
+        bool sent = send(this->limiter_, device_id, action, value);
+        if (sent) {
+            value_ = clamp(level, 0, 100);
+        }
+        return sent;
+    }
+
+    int value_ = 0;
+};
+
+}  // namespace detail
+
+// =============================================================================
+// Capabilities
+// =============================================================================
+//
+// Each capability lists the requests it handles in `requests` and implements
+// handle<Action>() for each of them. Callbacks take the new value by
+// reference and return true on success; they may change the value.
+
+/**
+ * @brief setPowerState; callback `bool(bool &on)`
+ */
+template <typename F = NoCallback>
+class PowerState : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 1> requests = {
+        SINRICPRO_ACTION_SET_POWER_STATE};
+
+    explicit PowerState(F callback = F()) : detail::Base<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        const cJSON *value = detail::request_value(request);
+        const cJSON *state = value ? cJSON_GetObjectItem(value, "state") : nullptr;
+        if (!cJSON_IsString(state)) return false;
+
+        bool on = strcasecmp(state->valuestring, "On") == 0;
+        bool success = detail::invoke(this->callback_, on);
+        if (success) {
+            state_ = on;
+        }
+
+        cJSON *resp_value = detail::response_value(response);
+        if (resp_value) {
+            cJSON_AddStringToObject(resp_value, "state", on ? "On" : "Off");
+        }
+        return success;
+    }
+
+    bool send(const char *device_id, bool on) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddStringToObject(value, "state", on ? "On" : "Off");
+        }
+        bool sent = detail::send(this->limiter_, device_id, SINRICPRO_ACTION_SET_POWER_STATE, value);
+        if (sent) {
+            state_ = on;
+        }
+        return sent;
+    }
+
+    bool state() const { return state_; }
+
+private:
+    bool state_ = false;
+};
+
+/**
+ * @brief setBrightness / adjustBrightness; callback `bool(int &level)`
+ *
+ * Adjustments are applied to the current level before the callback runs.
+ */
+template <typename F = NoCallback>
+class Brightness : public detail::Level<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 2> requests = {
+        SINRICPRO_ACTION_SET_BRIGHTNESS, SINRICPRO_ACTION_ADJUST_BRIGHTNESS};
+
+    explicit Brightness(F callback = F()) : detail::Level<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        return this->handle_level(request, response, "brightness", "brightnessDelta",
+                                  Action == SINRICPRO_ACTION_ADJUST_BRIGHTNESS);
+    }
+
+    bool send(const char *device_id, int level) {
+        return this->send_level(device_id, SINRICPRO_ACTION_SET_BRIGHTNESS, "brightness", level);
+    }
+};
+
+/**
+ * @brief setPowerLevel / adjustPowerLevel; callback `bool(int &level)`
+ */
+template <typename F = NoCallback>
+class PowerLevel : public detail::Level<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 2> requests = {
+        SINRICPRO_ACTION_SET_POWER_LEVEL, SINRICPRO_ACTION_ADJUST_POWER_LEVEL};
+
+    explicit PowerLevel(F callback = F()) : detail::Level<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        return this->handle_level(request, response, "powerLevel", "powerLevelDelta",
+                                  Action == SINRICPRO_ACTION_ADJUST_POWER_LEVEL);
+    }
+
+    bool send(const char *device_id, int level) {
+        return this->send_level(device_id, SINRICPRO_ACTION_SET_POWER_LEVEL, "powerLevel", level);
+    }
+};
+
+/**
+ * @brief setRangeValue / adjustRangeValue; callback `bool(int &value)`
+ */
+template <typename F = NoCallback>
+class RangeController : public detail::Level<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 2> requests = {
+        SINRICPRO_ACTION_SET_RANGE_VALUE, SINRICPRO_ACTION_ADJUST_RANGE_VALUE};
+
+    explicit RangeController(F callback = F()) : detail::Level<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        return this->handle_level(request, response, "rangeValue", "rangeValueDelta",
+                                  Action == SINRICPRO_ACTION_ADJUST_RANGE_VALUE);
+    }
+
+    bool send(const char *device_id, int value) {
+        return this->send_level(device_id, SINRICPRO_ACTION_SET_RANGE_VALUE, "rangeValue", value);
+    }
+};
+
+/**
+ * @brief setColor; callback `bool(sinricpro_color_t &color)`
+ */
+template <typename F = NoCallback>
+class Color : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 1> requests = {SINRICPRO_ACTION_SET_COLOR};
+
+    explicit Color(F callback = F()) : detail::Base<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        const cJSON *value = detail::request_value(request);
+        const cJSON *obj = value ? cJSON_GetObjectItem(value, "color") : nullptr;
+        if (!obj) return false;
+
+        int r = 0, g = 0, b = 0;
+        detail::get_int(obj, "r", r);
+        detail::get_int(obj, "g", g);
+        detail::get_int(obj, "b", b);
+        sinricpro_color_t color = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+
+        bool success = detail::invoke(this->callback_, color);
+        if (success) {
+            color_ = color;
+        }
+
+        cJSON *resp_value = detail::response_value(response);
+        cJSON *resp_color = resp_value ? cJSON_AddObjectToObject(resp_value, "color") : nullptr;
+        if (resp_color) {
+            add_rgb(resp_color, color);
+        }
+        return success;
+    }
+
+    bool send(const char *device_id, sinricpro_color_t color) {
+        cJSON *value = cJSON_CreateObject();
+        cJSON *obj = value ? cJSON_AddObjectToObject(value, "color") : nullptr;
+        if (obj) {
+            add_rgb(obj, color);
+        }
+        bool sent = detail::send(this->limiter_, device_id, SINRICPRO_ACTION_SET_COLOR, value);
+        if (sent) {
+            color_ = color;
+        }
+        return sent;
+    }
+
+    sinricpro_color_t color() const { return color_; }
+
+private:
+    static void add_rgb(cJSON *obj, sinricpro_color_t color) {
+        cJSON_AddNumberToObject(obj, "r", color.r);
+        cJSON_AddNumberToObject(obj, "g", color.g);
+        cJSON_AddNumberToObject(obj, "b", color.b);
+    }
+
+    sinricpro_color_t color_ = {0, 0, 0};
+};
+
+/**
+ * @brief set/increase/decreaseColorTemperature; callback `bool(int &kelvin)`
+ *
+ * Increase and decrease step through the standard white points, so the
+ * callback always receives an absolute temperature.
+ */
+template <typename F = NoCallback>
+class ColorTemperature : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 3> requests = {
+        SINRICPRO_ACTION_SET_COLOR_TEMPERATURE,
+        SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE,
+        SINRICPRO_ACTION_DECREASE_COLOR_TEMPERATURE};
+
+    static constexpr std::array<int, 5> steps = {2200, 2700, 4000, 5500, 7000};
+
+    explicit ColorTemperature(F callback = F()) : detail::Base<F>(std::move(callback)) {}
+
+    template <sinricpro_action_t Action>
+    bool handle(const cJSON *request, cJSON *response) {
+        int kelvin;
+        if constexpr (Action == SINRICPRO_ACTION_SET_COLOR_TEMPERATURE) {
+            if (!detail::get_int(detail::request_value(request), "colorTemperature", kelvin)) {
+                return false;
+            }
+        } else {
+            kelvin = step(kelvin_, Action == SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE);
+        }
+
+        bool success = detail::invoke(this->callback_, kelvin);
+        if (success) {
+            kelvin_ = kelvin;
+        }
+
+        cJSON *resp_value = detail::response_value(response);
+        if (resp_value) {
+            cJSON_AddNumberToObject(resp_value, "colorTemperature", kelvin);
+        }
+        return success;
+    }
+
+    bool send(const char *device_id, int kelvin) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddNumberToObject(value, "colorTemperature", kelvin);
+        }
+        bool sent = detail::send(this->limiter_, device_id,
+                                 SINRICPRO_ACTION_SET_COLOR_TEMPERATURE, value);
+        if (sent) {
+            kelvin_ = kelvin;
+        }
+        return sent;
+    }
+
+    int kelvin() const { return kelvin_; }
+
+private:
+    static constexpr int step(int kelvin, bool up) {
+        if (up) {
+            for (int s : steps) {
+                if (s > kelvin) return s;
+            }
+            return steps.back();
+        }
+        for (size_t i = steps.size(); i-- > 0;) {
+            if (steps[i] < kelvin) return steps[i];
+        }
+        return steps.front();
+    }
+
+    int kelvin_ = 2700;
+};
+
+/**
+ * @brief setMotionDetection event (no requests)
+ */
+template <typename F = NoCallback>
+class MotionSensor : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 0> requests = {};
+
+    explicit MotionSensor(F callback = F()) : detail::Base<F>(std::move(callback)) {}
+
+    bool send(const char *device_id, bool detected) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddStringToObject(value, "state", detected ? "detected" : "notDetected");
+        }
+        return detail::send(this->limiter_, device_id, SINRICPRO_ACTION_MOTION, value);
+    }
+};
+
+/**
+ * @brief setContactState event (no requests)
+ */
+template <typename F = NoCallback>
+class ContactSensor : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 0> requests = {};
+
+    explicit ContactSensor(F callback = F()) : detail::Base<F>(std::move(callback)) {}
+
+    bool send(const char *device_id, bool open) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddStringToObject(value, "state", open ? "open" : "closed");
+        }
+        return detail::send(this->limiter_, device_id, SINRICPRO_ACTION_CONTACT, value);
+    }
+};
+
+/**
+ * @brief currentTemperature event (no requests, sensor rate limit)
+ */
+template <typename F = NoCallback>
+class TemperatureSensor : public detail::Base<F> {
+public:
+    static constexpr std::array<sinricpro_action_t, 0> requests = {};
+
+    explicit TemperatureSensor(F callback = F()) : detail::Base<F>(std::move(callback), true) {}
+
+    bool send(const char *device_id, float temperature, float humidity) {
+        cJSON *value = cJSON_CreateObject();
+        if (value) {
+            cJSON_AddNumberToObject(value, "temperature", (double)temperature);
+            cJSON_AddNumberToObject(value, "humidity", (double)humidity);
+        }
+        return detail::send(this->limiter_, device_id, SINRICPRO_ACTION_CURRENT_TEMPERATURE, value);
+    }
+};
+
+// =============================================================================
+// Device
+// =============================================================================
+
+namespace detail {
+
+template <typename T, template <typename> class Cap>
+struct is_capability : std::false_type {};
+
+template <typename F, template <typename> class Cap>
+struct is_capability<Cap<F>, Cap> : std::true_type {};
+
+// Index of the first capability instantiated from Cap
+template <template <typename> class Cap, typename... Caps>
+constexpr size_t capability_index() {
+    constexpr bool matches[] = {is_capability<Caps, Cap>::value..., false};
+    for (size_t i = 0; i < sizeof...(Caps); i++) {
+        if (matches[i]) return i;
+    }
+    return sizeof...(Caps);
+}
+
+}  // namespace detail
+
+/**
+ * @brief Device composed of capabilities
+ *
+ * Declare it static (it registers its own address with the core) and call
+ * add() after sinricpro_init(). Each action may be handled by only one
+ * capability; this is checked at compile time.
+ */
+template <typename... Caps>
+class Device {
+public:
+    Device(const char *device_id, sinricpro_device_type_t type, Caps... caps)
+        : caps_(std::move(caps)...) {
+        sinricpro_device_init(&base_, device_id, type);
+        base_.actions = actions.data();
+        base_.user_data = this;
+    }
+
+    Device(const Device &) = delete;
+    Device &operator=(const Device &) = delete;
+
+    /**
+     * @brief Register with the core (after sinricpro_init())
+     */
+    bool add() { return sinricpro_add_device(&base_); }
+
+    sinricpro_device_t *device() { return &base_; }
+    const char *id() const { return base_.device_id; }
+
+    /**
+     * @brief Access a capability by template, e.g. get<PowerState>()
+     */
+    template <template <typename> class Cap>
+    auto &get() {
+        constexpr size_t index = detail::capability_index<Cap, Caps...>();
+        static_assert(index < sizeof...(Caps), "Device does not have this capability");
+        return std::get<index>(caps_);
+    }
+
+    /**
+     * @brief Send an event through a capability, e.g. send<PowerState>(true)
+     */
+    template <template <typename> class Cap, typename... Args>
+    bool send(Args &&... args) {
+        return get<Cap>().send(base_.device_id, std::forward<Args>(args)...);
+    }
+
+private:
+    using Table = std::array<sinricpro_action_handler_t, SINRICPRO_ACTION_COUNT>;
+
+    template <size_t I>
+    using CapAt = std::tuple_element_t<I, std::tuple<Caps...>>;
+
+    template <size_t I, sinricpro_action_t Action>
+    static bool dispatch(sinricpro_device_t *device, const cJSON *request, cJSON *response) {
+        Device *self = static_cast<Device *>(device->user_data);
+        return std::get<I>(self->caps_).template handle<Action>(request, response);
+    }
+
+    template <size_t I, size_t... J>
+    static constexpr void fill(Table &table, std::index_sequence<J...>) {
+        ((table[CapAt<I>::requests[J]] = &dispatch<I, CapAt<I>::requests[J]>), ...);
+    }
+
+    template <size_t... I>
+    static constexpr Table make_table(std::index_sequence<I...>) {
+        Table table{};
+        (fill<I>(table, std::make_index_sequence<CapAt<I>::requests.size()>{}), ...);
+        return table;
+    }
+
+    static constexpr bool unique_actions() {
+        bool seen[SINRICPRO_ACTION_COUNT] = {};
+        bool unique = true;
+        auto claim = [&](auto requests) {
+            for (sinricpro_action_t action : requests) {
+                unique = unique && !seen[action];
+                seen[action] = true;
+            }
+        };
+        (claim(Caps::requests), ...);
+        return unique;
+    }
+
+    static_assert(unique_actions(), "Two capabilities handle the same action");
+
+    static constexpr Table actions = make_table(std::index_sequence_for<Caps...>{});
+
+    sinricpro_device_t base_;
+    std::tuple<Caps...> caps_;
+};
+
+}  // namespace sinricpro
+
+#endif  // SINRICPRO_HPP
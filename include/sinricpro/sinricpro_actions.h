@@ -0,0 +1,96 @@
+/**
+ * @file sinricpro_actions.h
+ * @brief Action identifiers for SinricPro requests and events
+ *
+ * Compact numeric form of the action strings used on the wire, for APIs
+ * that must not pass strings around (e.g. sinricpro_post_event()).
+ */
+
+#ifndef SINRICPRO_ACTIONS_H
+#define SINRICPRO_ACTIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Action identifiers
+ *
+ * Each entry's trailing comment is its wire name; scripts/gen_action_hash.py
+ * reads them to build sinricpro_action_from_name(). Keep one per line.
+ */
+typedef enum {
+    SINRICPRO_ACTION_UNKNOWN = 0,
+
+    // Requests and state events
+    SINRICPRO_ACTION_SET_POWER_STATE,               // "setPowerState"
+    SINRICPRO_ACTION_SET_POWER_LEVEL,               // "setPowerLevel"
+    SINRICPRO_ACTION_ADJUST_POWER_LEVEL,            // "adjustPowerLevel"
+    SINRICPRO_ACTION_SET_BRIGHTNESS,                // "setBrightness"
+    SINRICPRO_ACTION_ADJUST_BRIGHTNESS,             // "adjustBrightness"
+    SINRICPRO_ACTION_SET_COLOR,                     // "setColor"
+    SINRICPRO_ACTION_SET_COLOR_TEMPERATURE,         // "setColorTemperature"
+    SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE,    // "increaseColorTemperature"
+    SINRICPRO_ACTION_DECREASE_COLOR_TEMPERATURE,    // "decreaseColorTemperature"
+    SINRICPRO_ACTION_SET_RANGE_VALUE,               // "setRangeValue"
+    SINRICPRO_ACTION_ADJUST_RANGE_VALUE,            // "adjustRangeValue"
+    SINRICPRO_ACTION_SET_LOCK_STATE,                // "setLockState"
+    SINRICPRO_ACTION_SET_MODE,                      // "setMode"
+
+    // Sensor and notification events
+    SINRICPRO_ACTION_MOTION,                        // "setMotionDetection"
+    SINRICPRO_ACTION_CONTACT,                       // "setContactState"
+    SINRICPRO_ACTION_DOORBELL_PRESS,                // "DoorbellPress"
+    SINRICPRO_ACTION_CURRENT_TEMPERATURE,           // "currentTemperature"
+    SINRICPRO_ACTION_AIR_QUALITY,                   // "airQuality"
+    SINRICPRO_ACTION_POWER_USAGE,                   // "powerUsage"
+
+    SINRICPRO_ACTION_COUNT
+} sinricpro_action_t;
+
+/**
+ * @brief Typed event value for sinricpro_post_event()
+ *
+ * The member used depends on the action:
+ * - state:   SET_POWER_STATE (on), SET_LOCK_STATE (locked),
+ *            SET_MODE (garage door closed), MOTION (detected), CONTACT (open)
+ * - level:   SET_BRIGHTNESS, SET_POWER_LEVEL, SET_COLOR_TEMPERATURE, SET_RANGE_VALUE
+ * - color:   SET_COLOR
+ * - climate: CURRENT_TEMPERATURE
+ * - air:     AIR_QUALITY
+ * - none:    DOORBELL_PRESS
+ */
+typedef union {
+    bool state;
+    int32_t level;
+    struct { uint8_t r, g, b; } color;
+    struct { float temperature; float humidity; } climate;
+    struct { uint16_t pm1; uint16_t pm2_5; uint16_t pm10; } air;
+} sinricpro_event_value_t;
+
+/**
+ * @brief Get the wire name of an action
+ *
+ * @param action Action identifier
+ * @return Action string, or NULL for UNKNOWN/out of range
+ */
+const char *sinricpro_action_name(sinricpro_action_t action);
+
+/**
+ * @brief Resolve a wire name to its action (generated perfect hash)
+ *
+ * @param name Action string (need not be NUL-terminated)
+ * @param len  Length of name
+ * @return Action identifier, or SINRICPRO_ACTION_UNKNOWN
+ */
+sinricpro_action_t sinricpro_action_from_name(const char *name, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_ACTIONS_H
@@ -0,0 +1,255 @@
+/**
+ * @file sinricpro_capability.h
+ * @brief Capability descriptors and composed devices for SinricPro
+ *
+ * A device type is a struct that embeds sinricpro_device_t first and one
+ * state struct per capability, plus a constant model listing where each
+ * capability lives. sinricpro_device_compose() initializes the device from
+ * the model; requests and events are then routed to capabilities by the
+ * core, so a new device type needs no dispatch code of its own:
+ *
+ * @code
+ * typedef struct {
+ *     sinricpro_device_t base;
+ *     sinricpro_power_state_t power_state;
+ *     sinricpro_range_controller_t range;
+ * } curtain_t;
+ *
+ * static const sinricpro_capability_slot_t curtain_slots[] = {
+ *     SINRICPRO_CAPABILITY(curtain_t, power_state, sinricpro_capability_power_state),
+ *     SINRICPRO_CAPABILITY(curtain_t, range, sinricpro_capability_range_controller),
+ * };
+ * static const sinricpro_device_model_t curtain_model =
+ *     SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_BLINDS, curtain_slots);
+ *
+ * sinricpro_device_compose(&curtain.base, DEVICE_ID, &curtain_model);
+ * sinricpro_range_controller_set_callback(&curtain.range, on_range);
+ * @endcode
+ */
+
+#ifndef SINRICPRO_CAPABILITY_H
+#define SINRICPRO_CAPABILITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro_device.h"
+#include "sinricpro_actions.h"
+#include "cJSON.h"
+
+/**
+ * @brief Bit for an action in a capability's request/event mask
+ */
+#define SINRICPRO_ACTION_BIT(action) (1u << (action))
+
+/**
+ * @brief Handle a request routed to this capability
+ *
+ * @param state    Capability state inside the device
+ * @param device   The device receiving the request
+ * @param action   Resolved action (one of the capability's requests)
+ * @param request  The full request JSON
+ * @param response Response JSON to populate
+ * @return true if handled successfully
+ */
+typedef bool (*sinricpro_capability_request_fn_t)(void *state,
+                                                  sinricpro_device_t *device,
+                                                  sinricpro_action_t action,
+                                                  const cJSON *request,
+                                                  cJSON *response);
+
+/**
+ * @brief Send an event owned by this capability
+ *
+ * @param state     Capability state inside the device
+ * @param device_id Device ID
+ * @param action    Event action (one of the capability's events)
+ * @param value     Event value (see sinricpro_event_value_t)
+ * @return true if sent
+ */
+typedef bool (*sinricpro_capability_event_fn_t)(void *state,
+                                                const char *device_id,
+                                                sinricpro_action_t action,
+                                                const sinricpro_event_value_t *value);
+
+/**
+ * @brief Report the capability's current value for a state snapshot
+ *
+ * @param state  Capability state inside the device
+ * @param action Output: event action carrying the value
+ * @param value  Output: current value
+ * @return false if there is nothing to report
+ */
+typedef bool (*sinricpro_capability_snapshot_fn_t)(const void *state,
+                                                   sinricpro_action_t *action,
+                                                   sinricpro_event_value_t *value);
+
+/**
+ * @brief Capability descriptor (one constant instance per capability)
+ */
+typedef struct {
+    const char *name;
+    uint32_t requests;                          // SINRICPRO_ACTION_BIT() mask
+    uint32_t events;                            // SINRICPRO_ACTION_BIT() mask
+    void (*init)(void *state);
+    sinricpro_capability_request_fn_t handle;
+    sinricpro_capability_event_fn_t send;
+    sinricpro_event_limiter_t *(*limiter)(void *state);  // Trailing-edge values, optional
+    sinricpro_capability_snapshot_fn_t snapshot;        // Current state, optional
+} sinricpro_capability_t;
+
+/**
+ * @brief Capability placement inside a device struct
+ */
+typedef struct {
+    const sinricpro_capability_t *capability;
+    uint16_t offset;                            // offsetof() the capability state
+} sinricpro_capability_slot_t;
+
+/**
+ * @brief Device model: type plus its capabilities
+ */
+struct sinricpro_device_model {
+    sinricpro_device_type_t type;
+    const sinricpro_capability_slot_t *slots;
+    uint8_t slot_count;
+};
+
+/**
+ * @brief Slot initializer: capability `cap` stored in `type.member`
+ */
+#define SINRICPRO_CAPABILITY(type, member, cap) \
+    { &(cap), (uint16_t)offsetof(type, member) }
+
+/**
+ * @brief Model initializer from a slot array
+ */
+#define SINRICPRO_DEVICE_MODEL(device_type, slot_array) \
+    { (device_type), (slot_array), (uint8_t)(sizeof(slot_array) / sizeof((slot_array)[0])) }
+
+// =============================================================================
+// Built-in capabilities
+// =============================================================================
+extern const sinricpro_capability_t sinricpro_capability_power_state;
+extern const sinricpro_capability_t sinricpro_capability_brightness;
+extern const sinricpro_capability_t sinricpro_capability_power_level;
+extern const sinricpro_capability_t sinricpro_capability_color;
+extern const sinricpro_capability_t sinricpro_capability_color_temperature;
+extern const sinricpro_capability_t sinricpro_capability_range_controller;
+extern const sinricpro_capability_t sinricpro_capability_lock_controller;
+extern const sinricpro_capability_t sinricpro_capability_door_controller;
+extern const sinricpro_capability_t sinricpro_capability_motion_sensor;
+extern const sinricpro_capability_t sinricpro_capability_contact_sensor;
+extern const sinricpro_capability_t sinricpro_capability_temperature_sensor;
+extern const sinricpro_capability_t sinricpro_capability_air_quality_sensor;
+extern const sinricpro_capability_t sinricpro_capability_power_sensor;
+extern const sinricpro_capability_t sinricpro_capability_doorbell;
+
+// =============================================================================
+// Composed devices
+// =============================================================================
+
+/**
+ * @brief Initialize a device from its model
+ *
+ * Initializes the base device and every capability listed in the model.
+ *
+ * @param device    Device (base member of the device struct)
+ * @param device_id Device ID (24-character hex string)
+ * @param model     Constant model describing the device struct
+ * @return true on success, false on failure
+ */
+bool sinricpro_device_compose(sinricpro_device_t *device,
+                              const char *device_id,
+                              const sinricpro_device_model_t *model);
+
+/**
+ * @brief Find a capability's state inside a composed device
+ *
+ * @param device     Composed device
+ * @param capability Capability descriptor
+ * @return Capability state, or NULL if the device doesn't have it
+ */
+void *sinricpro_device_capability(sinricpro_device_t *device,
+                                  const sinricpro_capability_t *capability);
+
+/**
+ * @brief Send an event through the capability that owns it
+ *
+ * Applies that capability's rate limit and state update, like its own
+ * send function.
+ *
+ * @param device Composed device
+ * @param action Event action
+ * @param value  Event value, or NULL for DOORBELL_PRESS
+ * @return true if sent
+ */
+bool sinricpro_device_send_event(sinricpro_device_t *device,
+                                 sinricpro_action_t action,
+                                 const sinricpro_event_value_t *value);
+
+/**
+ * @brief Send values held back by the capabilities' rate limits
+ *
+ * Called by the core; sends each waiting trailing-edge value whose limiter
+ * now allows it, through the capability's own send path.
+ *
+ * @param device Composed device
+ * @return Number of values sent
+ */
+size_t sinricpro_device_flush_deferred(sinricpro_device_t *device);
+
+/**
+ * @brief Read one capability's value for a state snapshot
+ *
+ * Called by the core for each slot while publishing a snapshot. Slots
+ * without a snapshot function report nothing, as do slots whose limiter
+ * holds a trailing-edge value: that value is newer and is sent on its own.
+ *
+ * @param device Composed device
+ * @param slot   Slot index in the device model
+ * @param action Output: event action
+ * @param value  Output: current value
+ * @return true if the slot has a value to report
+ */
+bool sinricpro_device_snapshot(sinricpro_device_t *device,
+                               uint8_t slot,
+                               sinricpro_action_t *action,
+                               sinricpro_event_value_t *value);
+
+/**
+ * @brief Check whether a composed device handles a request action
+ *
+ * @param device Composed device
+ * @param action Resolved action
+ * @return true if one of its capabilities handles the action
+ */
+bool sinricpro_device_has_action(const sinricpro_device_t *device, sinricpro_action_t action);
+
+/**
+ * @brief Route a request to the capability that handles it
+ *
+ * Used by the core for every request to a composed device.
+ *
+ * @param device   Composed device
+ * @param action   Resolved action
+ * @param request  The full request JSON
+ * @param response Response JSON to populate
+ * @param handled  Set to false if no capability handles the action
+ * @return The capability's result
+ */
+bool sinricpro_device_route_request(sinricpro_device_t *device,
+                                    sinricpro_action_t action,
+                                    const cJSON *request,
+                                    cJSON *response,
+                                    bool *handled);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_CAPABILITY_H
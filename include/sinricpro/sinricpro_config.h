@@ -42,24 +42,130 @@ extern "C" {
 #define SINRICPRO_WEBSOCKET_PING_TIMEOUT_MS     10000   // 10 seconds
 #define SINRICPRO_WEBSOCKET_RECONNECT_DELAY_MS  5000    // 5 seconds
 #define SINRICPRO_WEBSOCKET_BUFFER_SIZE         2048
+#define SINRICPRO_MAX_SERVERS                   4       // Failover list entries
+
+// =============================================================================
+// Dual-Core Configuration
+// =============================================================================
+// Set by the SINRICPRO_MULTICORE CMake option: WebSocket, lwIP and TLS run on
+// core 1, JSON handling and device callbacks stay on core 0.
+#ifndef SINRICPRO_MULTICORE
+#define SINRICPRO_MULTICORE             0
+#endif
+#define SINRICPRO_CORE1_STACK_SIZE      8192    // mbedTLS handshake needs more than the 2KB default
+
+// express_dispatch runs requests inside the lwIP receive callback, below
+// mbedTLS on the core 0 stack; it is ignored when PICO_STACK_SIZE is smaller
+#define SINRICPRO_EXPRESS_STACK_SIZE    4096
 
 // =============================================================================
 // Message Queue Configuration
 // =============================================================================
-#define SINRICPRO_MESSAGE_QUEUE_SIZE    8
+#define SINRICPRO_MESSAGE_QUEUE_SIZE    8       // Must be a power of two
 #define SINRICPRO_MAX_MESSAGE_SIZE      2048
+#define SINRICPRO_EVENT_RING_SIZE       16      // Posted events (power of two)
+#define SINRICPRO_EVENT_BATCH           4       // Posted events expanded per handle() call
+
+// =============================================================================
+// Inbound Request Limit
+// =============================================================================
+// Requests that pass the pre-filter are admitted by a token bucket before
+// JSON parsing and HMAC verification
+#define SINRICPRO_RX_RATE_PER_SEC       10      // Sustained requests per second
+#define SINRICPRO_RX_BURST              20      // Requests admitted back to back
+
+// =============================================================================
+// Response Cache
+// =============================================================================
+// Signed responses kept by replyToken so a retried request is answered
+// without running the device callback again
+#define SINRICPRO_RESPONSE_CACHE_SIZE       4
+#define SINRICPRO_RESPONSE_CACHE_FRAME_MAX  768     // Larger responses are not cached
+#define SINRICPRO_RESPONSE_CACHE_TTL_MS     30000
+#define SINRICPRO_REPLY_TOKEN_MAX_LEN       48      // Server tokens are UUIDs (36 chars)
+
+// =============================================================================
+// Deferred Responses
+// =============================================================================
+// Requests whose callback called sinricpro_defer_response(), answered later
+// by sinricpro_complete_response() or with failure after the timeout
+#define SINRICPRO_MAX_PENDING_RESPONSES         4
+#define SINRICPRO_PENDING_RESPONSE_TIMEOUT_MS   10000
 
 // =============================================================================
 // Device Configuration
 // =============================================================================
 #define SINRICPRO_MAX_DEVICES           8
 #define SINRICPRO_DEVICE_ID_LENGTH      24
+#define SINRICPRO_DEVICE_TABLE_SIZE     16      // Lookup slots: power of two, >= 2x MAX_DEVICES
+#define SINRICPRO_DEVICE_POOL_MAX       128     // Largest sinricpro_set_device_pool() capacity
+#define SINRICPRO_REANNOUNCE_DELAY_MS   2000    // Settle time after adding devices while connected
 
 // =============================================================================
 // Event Limiter Configuration
 // =============================================================================
 #define SINRICPRO_EVENT_LIMIT_STATE_MS          1000    // 1 second for state events
 #define SINRICPRO_EVENT_LIMIT_SENSOR_MS         60000   // 60 seconds for sensor values
+#define SINRICPRO_EVENT_LIMIT_STATE_BURST       0       // >0: state events use a token bucket this deep
+#define SINRICPRO_EVENT_TRAILING_EDGE           1       // Send the latest blocked state later
+#define SINRICPRO_EVENT_DEFER_SCAN_MS           100     // How often waiting values are checked
+
+// =============================================================================
+// Event Budget
+// =============================================================================
+// All devices' events share one token bucket, released fairly across
+// devices with state changes ahead of sensor telemetry
+#define SINRICPRO_EVENT_BUDGET_INTERVAL_MS      250     // One event per interval on average
+#define SINRICPRO_EVENT_BUDGET_BURST            8       // Events released back to back
+#define SINRICPRO_EVENT_SCHED_SLOTS             8       // Events waiting for budget
+#define SINRICPRO_EVENT_COALESCE                1       // Newer value replaces a waiting one
+#define SINRICPRO_TX_EVENT_DEPTH                2       // Event frames a response can wait behind
+
+// =============================================================================
+// Event Delivery
+// =============================================================================
+// Sent events are kept until the server's response to them arrives and are
+// sent again, with the same replyToken, after a reconnect or the timeout
+#define SINRICPRO_MAX_INFLIGHT_EVENTS           4       // Unanswered events (more wait for room)
+#define SINRICPRO_EVENT_ACK_TIMEOUT_MS          5000    // Wait for a response before resending
+#define SINRICPRO_EVENT_MAX_ATTEMPTS            3       // Sends before an event is given up
+
+// =============================================================================
+// State Restore
+// =============================================================================
+// With sinricpro_config_t.restore_states, requests arriving right after a
+// connect carry each device's last state. They are kept, applied one at a
+// time once they stop, and answered with the outcome. A request from
+// another source or repeating a property ends the burst early.
+#define SINRICPRO_RESTORE_WINDOW_MS             5000    // Longest burst of restores after connecting
+#define SINRICPRO_RESTORE_SETTLE_MS             250     // Quiet time before restores are applied
+#define SINRICPRO_RESTORE_APPLY_INTERVAL_MS     50      // One restored property per interval
+#define SINRICPRO_RESTORE_SLOTS                 16      // Restores waiting (more are handled at once)
+#define SINRICPRO_RESTORE_ECHO_MS               1000    // Events reporting a restored state are dropped
+
+// =============================================================================
+// Offline Event Journal
+// =============================================================================
+// Set by the SINRICPRO_JOURNAL CMake option: events raised while offline are
+// kept in the last SINRICPRO_JOURNAL_SECTORS sectors of flash (the program
+// must end below them) and replayed after reconnecting.
+#ifndef SINRICPRO_JOURNAL_ENABLED
+#define SINRICPRO_JOURNAL_ENABLED               0
+#endif
+#define SINRICPRO_JOURNAL_SECTORS               16      // 4 KB each, at least 3
+#define SINRICPRO_JOURNAL_VALUE_MAX             200     // Longest event value (JSON text)
+#define SINRICPRO_JOURNAL_FLUSH_MS              5000    // Longest a record waits in RAM
+#define SINRICPRO_JOURNAL_REPLAY_INTERVAL_MS    500     // One replayed event per interval
+#define SINRICPRO_JOURNAL_COMPACT               1       // Replay only the latest value per property
+
+// =============================================================================
+// Server Clock
+// =============================================================================
+// The 64-bit local timer is mapped to server time from the timestamp sent on
+// every connect, corrected for the crystal's drift between syncs
+#define SINRICPRO_CLOCK_STEP_MS                 2000    // Larger corrections restart drift tracking
+#define SINRICPRO_CLOCK_DRIFT_MIN_INTERVAL_S    21600   // Shortest sync interval used for drift
+#define SINRICPRO_CLOCK_MAX_DRIFT_PPM           200     // Drift estimates are clamped to this
 
 // =============================================================================
 // Signature Configuration
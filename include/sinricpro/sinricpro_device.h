@@ -12,11 +12,15 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "sinricpro_config.h"
+#include "sinricpro_actions.h"
+#include "event_limiter.h"
 #include "cJSON.h"
 
-// Forward declaration
+// Forward declarations
 typedef struct sinricpro_device sinricpro_device_t;
+typedef struct sinricpro_device_model sinricpro_device_model_t;   // sinricpro_capability.h
 
 /**
  * @brief Device type identifiers
@@ -43,6 +47,16 @@ typedef enum {
     SINRICPRO_DEVICE_TYPE_CAMERA
 } sinricpro_device_type_t;
 
+/**
+ * @brief Binary device ID (24 hex characters packed into 12 bytes)
+ *
+ * Word access lets lookups compare IDs with three 32-bit compares.
+ */
+typedef union {
+    uint8_t bytes[SINRICPRO_DEVICE_ID_LENGTH / 2];
+    uint32_t words[SINRICPRO_DEVICE_ID_LENGTH / 8];
+} sinricpro_device_key_t;
+
 /**
  * @brief Request handler function type
  *
@@ -58,6 +72,22 @@ typedef bool (*sinricpro_request_handler_t)(
     const cJSON *request,
     cJSON *response);
 
+/**
+ * @brief Handler for one action
+ *
+ * Device types provide a constant table of these indexed by
+ * sinricpro_action_t; the core resolves the action name once per message.
+ *
+ * @param device    The device receiving the request
+ * @param request   The full request JSON
+ * @param response  Response JSON to populate
+ * @return true if handled successfully, false otherwise
+ */
+typedef bool (*sinricpro_action_handler_t)(
+    sinricpro_device_t *device,
+    const cJSON *request,
+    cJSON *response);
+
 /**
  * @brief Base device structure
  *
@@ -65,11 +95,34 @@ typedef bool (*sinricpro_request_handler_t)(
  */
 struct sinricpro_device {
     char device_id[SINRICPRO_DEVICE_ID_LENGTH + 1];
+    sinricpro_device_key_t key;         // Binary form of device_id, used for lookups
     sinricpro_device_type_t type;
 
-    // Request handler (implemented by device type)
+    // Capability layout (composed devices, see sinricpro_device_compose())
+    const sinricpro_device_model_t *model;
+
+    // Action handlers indexed by sinricpro_action_t (SINRICPRO_ACTION_COUNT entries)
+    const sinricpro_action_handler_t *actions;
+
+    // Fallback for actions without a table entry (custom device types)
     sinricpro_request_handler_t handle_request;
 
+    // Registry position, used by sinricpro_post_event()
+    uint8_t index;
+    sinricpro_event_limiter_t post_limiter;
+
+    // Actions sent live while the offline journal replays (bit per action);
+    // older journaled values of these are skipped
+    uint32_t live_actions;
+
+    // Actions just set from a server state restore (bit per action); events
+    // reporting them back are not sent
+    uint32_t restored_actions;
+
+    // Actions whose latest value the server hasn't confirmed (bit per
+    // action), published by a SINRICPRO_SNAPSHOT_CHANGED snapshot
+    uint32_t unacked_actions;
+
     // User data
     void *user_data;
 };
@@ -86,6 +139,17 @@ bool sinricpro_device_init(sinricpro_device_t *device,
                            const char *device_id,
                            sinricpro_device_type_t type);
 
+/**
+ * @brief Pack a 24-character hex device ID into its binary key
+ *
+ * @param device_id Device ID string (need not be NUL-terminated)
+ * @param len       Length of device_id
+ * @param key       Output key
+ * @return true on success, false if not exactly 24 hex characters
+ */
+bool sinricpro_device_key_from_id(const char *device_id, size_t len,
+                                  sinricpro_device_key_t *key);
+
 /**
  * @brief Get device ID
  *
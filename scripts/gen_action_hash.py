@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Generate the action name perfect hash for the SinricPro SDK.
+
+Reads the action vocabulary from include/sinricpro/sinricpro_actions.h
+(the `SINRICPRO_ACTION_X, // "wireName"` lines) and writes a C file with
+sinricpro_action_from_name(): one hash over the length and two characters,
+one table load and one memcmp, whatever the number of actions.
+
+Usage: gen_action_hash.py <sinricpro_actions.h> <output.c>
+"""
+
+import re
+import sys
+
+ENTRY = re.compile(r'^\s*(SINRICPRO_ACTION_\w+),\s*//\s*"(\w+)"')
+
+
+def read_actions(header):
+    actions = []
+    with open(header, encoding="utf-8") as f:
+        for line in f:
+            m = ENTRY.match(line)
+            if m:
+                actions.append((m.group(1), m.group(2)))
+    if not actions:
+        sys.exit(f"{header}: no actions found")
+    return actions
+
+
+def slot(name, head, tail, mult, shift, mask):
+    h = len(name) * 31 + ord(name[head]) * mult + ord(name[len(name) - 1 - tail])
+    return ((h * 0x9E3779B1) & 0xFFFFFFFF) >> shift & mask
+
+
+def find_hash(names):
+    min_len = min(len(n) for n in names)
+    size = 1
+    while size < len(names):
+        size *= 2
+
+    # Smallest power-of-two table first, then a sparser one
+    while size <= 8 * len(names):
+        mask = size - 1
+        for head in range(min(min_len, 8)):
+            for tail in range(min(min_len, 8)):
+                for mult in range(1, 64, 2):
+                    for shift in range(8, 28):
+                        seen = set()
+                        for n in names:
+                            s = slot(n, head, tail, mult, shift, mask)
+                            if s in seen:
+                                break
+                            seen.add(s)
+                        else:
+                            return size, head, tail, mult, shift
+        size *= 2
+
+    sys.exit("no perfect hash found")
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    actions = read_actions(sys.argv[1])
+    names = [name for _, name in actions]
+    size, head, tail, mult, shift = find_hash(names)
+    mask = size - 1
+
+    table = ["SINRICPRO_ACTION_UNKNOWN"] * size
+    for ident, name in actions:
+        table[slot(name, head, tail, mult, shift, mask)] = ident
+
+    min_len = min(len(n) for n in names)
+    max_len = max(len(n) for n in names)
+    width = max(len(t) for t in table)
+
+    out = []
+    out.append("/**")
+    out.append(" * @file action_hash.c")
+    out.append(" * @brief Action name to identifier perfect hash")
+    out.append(" *")
+    out.append(" * GENERATED by scripts/gen_action_hash.py from sinricpro_actions.h.")
+    out.append(" * Do not edit; add actions to the header and rebuild.")
+    out.append(" */")
+    out.append("")
+    out.append('#include "sinricpro/sinricpro_actions.h"')
+    out.append("#include <string.h>")
+    out.append("")
+    out.append(f"#define ACTION_MIN_LEN  {min_len}")
+    out.append(f"#define ACTION_MAX_LEN  {max_len}")
+    out.append(f"#define ACTION_HEAD     {head}")
+    out.append(f"#define ACTION_TAIL     {tail}")
+    out.append(f"#define ACTION_MULT     {mult}u")
+    out.append(f"#define ACTION_SHIFT    {shift}")
+    out.append(f"#define ACTION_MASK     {mask}u")
+    out.append("")
+    out.append(f"static const uint8_t action_slots[{size}] = {{")
+    for i, ident in enumerate(table):
+        comma = "," if i < size - 1 else ""
+        out.append(f"    {ident + comma:<{width + 1}}  // {i}")
+    out.append("};")
+    out.append("")
+    out.append("sinricpro_action_t sinricpro_action_from_name(const char *name, size_t len) {")
+    out.append("    if (!name || len < ACTION_MIN_LEN || len > ACTION_MAX_LEN) {")
+    out.append("        return SINRICPRO_ACTION_UNKNOWN;")
+    out.append("    }")
+    out.append("")
+    out.append("    uint32_t h = (uint32_t)len * 31u")
+    out.append("               + (uint8_t)name[ACTION_HEAD] * ACTION_MULT")
+    out.append("               + (uint8_t)name[len - 1 - ACTION_TAIL];")
+    out.append("    sinricpro_action_t action =")
+    out.append("        (sinricpro_action_t)action_slots[((h * 0x9E3779B1u) >> ACTION_SHIFT) & ACTION_MASK];")
+    out.append("")
+    out.append("    // One candidate per slot: confirm it")
+    out.append("    const char *expected = sinricpro_action_name(action);")
+    out.append("    if (!expected || strlen(expected) != len || memcmp(expected, name, len) != 0) {")
+    out.append("        return SINRICPRO_ACTION_UNKNOWN;")
+    out.append("    }")
+    out.append("")
+    out.append("    return action;")
+    out.append("}")
+    out.append("")
+
+    with open(sys.argv[2], "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/air_quality_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "core/sinricpro_debug.h"
 #include "cJSON.h"
 #include <stdio.h>
@@ -58,3 +59,29 @@ bool sinricpro_air_quality_sensor_send_event(sinricpro_air_quality_sensor_t *sen
 
     return result;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void air_quality_sensor_cap_init(void *state) {
+    sinricpro_air_quality_sensor_init(state);
+}
+
+static bool air_quality_sensor_cap_send(void *state,
+                                        const char *device_id,
+                                        sinricpro_action_t action,
+                                        const sinricpro_event_value_t *value) {
+    return sinricpro_air_quality_sensor_send_event(state, device_id,
+                                                   value->air.pm1,
+                                                   value->air.pm2_5,
+                                                   value->air.pm10);
+}
+
+const sinricpro_capability_t sinricpro_capability_air_quality_sensor = {
+    .name = "AirQualitySensor",
+    .requests = 0,
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_AIR_QUALITY),
+    .init = air_quality_sensor_cap_init,
+    .send = air_quality_sensor_cap_send,
+};
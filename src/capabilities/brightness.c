@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/brightness.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -142,6 +143,9 @@ bool sinricpro_brightness_send_event(sinricpro_brightness_t *cap,
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[Brightness] Event rate limited\n");
+        sinricpro_event_value_t latest = { .level = brightness };
+        sinricpro_event_limiter_defer(&cap->event_limiter,
+                                      SINRICPRO_ACTION_SET_BRIGHTNESS, &latest);
         return false;
     }
 
@@ -169,3 +173,54 @@ bool sinricpro_brightness_send_event(sinricpro_brightness_t *cap,
 int sinricpro_brightness_get_value(const sinricpro_brightness_t *cap) {
     return cap ? cap->current_brightness : 0;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void brightness_cap_init(void *state) {
+    sinricpro_brightness_init(state);
+}
+
+static bool brightness_cap_handle(void *state,
+                                  sinricpro_device_t *device,
+                                  sinricpro_action_t action,
+                                  const cJSON *request,
+                                  cJSON *response) {
+    if (action == SINRICPRO_ACTION_ADJUST_BRIGHTNESS) {
+        return sinricpro_brightness_handle_adjust_request(state, device, request, response);
+    }
+    return sinricpro_brightness_handle_set_request(state, device, request, response);
+}
+
+static bool brightness_cap_send(void *state,
+                                const char *device_id,
+                                sinricpro_action_t action,
+                                const sinricpro_event_value_t *value) {
+    return sinricpro_brightness_send_event(state, device_id, (int)value->level);
+}
+
+static sinricpro_event_limiter_t *brightness_cap_limiter(void *state) {
+    return &((sinricpro_brightness_t *)state)->event_limiter;
+}
+
+static bool brightness_cap_snapshot(const void *state,
+                                    sinricpro_action_t *action,
+                                    sinricpro_event_value_t *value) {
+    const sinricpro_brightness_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_BRIGHTNESS;
+    value->level = cap->current_brightness;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_brightness = {
+    .name = "Brightness",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_BRIGHTNESS) |
+                SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_ADJUST_BRIGHTNESS),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_BRIGHTNESS),
+    .init = brightness_cap_init,
+    .handle = brightness_cap_handle,
+    .send = brightness_cap_send,
+    .limiter = brightness_cap_limiter,
+    .snapshot = brightness_cap_snapshot,
+};
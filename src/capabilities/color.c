@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/color.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -92,6 +93,8 @@ bool sinricpro_color_send_event(sinricpro_color_cap_t *cap,
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[Color] Event rate limited\n");
+        sinricpro_event_value_t latest = { .color = { color.r, color.g, color.b } };
+        sinricpro_event_limiter_defer(&cap->event_limiter, SINRICPRO_ACTION_SET_COLOR, &latest);
         return false;
     }
 
@@ -127,3 +130,53 @@ sinricpro_color_t sinricpro_color_get_value(const sinricpro_color_cap_t *cap) {
     sinricpro_color_t black = {0, 0, 0};
     return cap ? cap->current_color : black;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void color_cap_init(void *state) {
+    sinricpro_color_init(state);
+}
+
+static bool color_cap_handle(void *state,
+                             sinricpro_device_t *device,
+                             sinricpro_action_t action,
+                             const cJSON *request,
+                             cJSON *response) {
+    return sinricpro_color_handle_request(state, device, request, response);
+}
+
+static bool color_cap_send(void *state,
+                           const char *device_id,
+                           sinricpro_action_t action,
+                           const sinricpro_event_value_t *value) {
+    sinricpro_color_t color = { value->color.r, value->color.g, value->color.b };
+    return sinricpro_color_send_event(state, device_id, color);
+}
+
+static sinricpro_event_limiter_t *color_cap_limiter(void *state) {
+    return &((sinricpro_color_cap_t *)state)->event_limiter;
+}
+
+static bool color_cap_snapshot(const void *state,
+                               sinricpro_action_t *action,
+                               sinricpro_event_value_t *value) {
+    const sinricpro_color_cap_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_COLOR;
+    value->color.r = cap->current_color.r;
+    value->color.g = cap->current_color.g;
+    value->color.b = cap->current_color.b;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_color = {
+    .name = "Color",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_COLOR),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_COLOR),
+    .init = color_cap_init,
+    .handle = color_cap_handle,
+    .send = color_cap_send,
+    .limiter = color_cap_limiter,
+    .snapshot = color_cap_snapshot,
+};
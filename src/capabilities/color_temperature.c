@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/color_temperature.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -138,6 +139,9 @@ bool sinricpro_color_temp_send_event(sinricpro_color_temp_cap_t *cap,
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[ColorTemp] Event rate limited\n");
+        sinricpro_event_value_t latest = { .level = color_temp };
+        sinricpro_event_limiter_defer(&cap->event_limiter,
+                                      SINRICPRO_ACTION_SET_COLOR_TEMPERATURE, &latest);
         return false;
     }
 
@@ -163,3 +167,53 @@ bool sinricpro_color_temp_send_event(sinricpro_color_temp_cap_t *cap,
 int sinricpro_color_temp_get_value(const sinricpro_color_temp_cap_t *cap) {
     return cap ? cap->current_temp : 2700;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void color_temp_cap_init(void *state) {
+    sinricpro_color_temp_init(state);
+}
+
+static bool color_temp_cap_handle(void *state,
+                                  sinricpro_device_t *device,
+                                  sinricpro_action_t action,
+                                  const cJSON *request,
+                                  cJSON *response) {
+    return sinricpro_color_temp_handle_request(state, device, sinricpro_action_name(action),
+                                               request, response);
+}
+
+static bool color_temp_cap_send(void *state,
+                                const char *device_id,
+                                sinricpro_action_t action,
+                                const sinricpro_event_value_t *value) {
+    return sinricpro_color_temp_send_event(state, device_id, (int)value->level);
+}
+
+static sinricpro_event_limiter_t *color_temp_cap_limiter(void *state) {
+    return &((sinricpro_color_temp_cap_t *)state)->event_limiter;
+}
+
+static bool color_temp_cap_snapshot(const void *state,
+                                    sinricpro_action_t *action,
+                                    sinricpro_event_value_t *value) {
+    const sinricpro_color_temp_cap_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_COLOR_TEMPERATURE;
+    value->level = cap->current_temp;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_color_temperature = {
+    .name = "ColorTemperature",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_COLOR_TEMPERATURE) |
+                SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE) |
+                SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_DECREASE_COLOR_TEMPERATURE),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_COLOR_TEMPERATURE),
+    .init = color_temp_cap_init,
+    .handle = color_temp_cap_handle,
+    .send = color_temp_cap_send,
+    .limiter = color_temp_cap_limiter,
+    .snapshot = color_temp_cap_snapshot,
+};
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/contact_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -27,6 +28,8 @@ bool sinricpro_contact_sensor_cap_send_event(sinricpro_contact_sensor_cap_t *cap
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[ContactSensor] Event rate limited\n");
+        sinricpro_event_value_t latest = { .state = is_open };
+        sinricpro_event_limiter_defer(&cap->event_limiter, SINRICPRO_ACTION_CONTACT, &latest);
         return false;
     }
 
@@ -53,3 +56,41 @@ bool sinricpro_contact_sensor_cap_send_event(sinricpro_contact_sensor_cap_t *cap
 bool sinricpro_contact_sensor_get_state(const sinricpro_contact_sensor_cap_t *cap) {
     return cap ? cap->contact_open : false;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void contact_sensor_cap_init(void *state) {
+    sinricpro_contact_sensor_cap_init(state);
+}
+
+static bool contact_sensor_cap_send(void *state,
+                                    const char *device_id,
+                                    sinricpro_action_t action,
+                                    const sinricpro_event_value_t *value) {
+    return sinricpro_contact_sensor_cap_send_event(state, device_id, value->state);
+}
+
+static sinricpro_event_limiter_t *contact_sensor_cap_limiter(void *state) {
+    return &((sinricpro_contact_sensor_cap_t *)state)->event_limiter;
+}
+
+static bool contact_sensor_cap_snapshot(const void *state,
+                                        sinricpro_action_t *action,
+                                        sinricpro_event_value_t *value) {
+    const sinricpro_contact_sensor_cap_t *cap = state;
+    *action = SINRICPRO_ACTION_CONTACT;
+    value->state = cap->contact_open;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_contact_sensor = {
+    .name = "ContactSensor",
+    .requests = 0,
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_CONTACT),
+    .init = contact_sensor_cap_init,
+    .send = contact_sensor_cap_send,
+    .limiter = contact_sensor_cap_limiter,
+    .snapshot = contact_sensor_cap_snapshot,
+};
@@ -4,14 +4,13 @@
  */
 
 #include "sinricpro/capabilities/door_controller.h"
+#include "sinricpro/sinricpro_capability.h"
+#include "sinricpro/sinricpro.h"
 #include "core/sinricpro_debug.h"
 #include "core/json_helpers.h"
 #include <string.h>
 #include <stdio.h>
 
-// Declared in sinricpro.c
-extern bool sinricpro_send_event(const char *device_id, cJSON *event_message);
-
 void sinricpro_door_controller_init(sinricpro_door_controller_t *controller) {
     if (!controller) return;
 
@@ -88,34 +87,75 @@ bool sinricpro_door_controller_send_event(sinricpro_door_controller_t *controlle
     }
 
     // Check rate limiting
-    if (!sinricpro_event_limiter_check(&controller->event_limiter)) {
+    if (sinricpro_event_limiter_check(&controller->event_limiter)) {
         SINRICPRO_WARN_PRINTF("[DoorController] Event rate limited\n");
+        sinricpro_event_value_t latest = { .state = closed };
+        sinricpro_event_limiter_defer(&controller->event_limiter,
+                                      SINRICPRO_ACTION_SET_MODE, &latest);
         return false;
     }
 
     // Update internal state
     controller->closed = closed;
 
-    // Build event message
-    cJSON *event = cJSON_CreateObject();
-    if (!event) return false;
-
-    cJSON_AddStringToObject(event, "action", "setMode");
-    cJSON_AddStringToObject(event, "cause", "PHYSICAL_INTERACTION");
-
     cJSON *value = cJSON_CreateObject();
+    if (!value) return false;
+
     cJSON_AddStringToObject(value, "mode", closed ? "Close" : "Open");
-    cJSON_AddItemToObject(event, "value", value);
 
     SINRICPRO_DEBUG_PRINTF("[DoorController] Sending event: %s\n",
                             closed ? "CLOSED" : "OPEN");
 
-    bool result = sinricpro_send_event(device_id, event);
-    cJSON_Delete(event);
-
-    return result;
+    return sinricpro_send_event(device_id, "setMode", value);
 }
 
 bool sinricpro_door_controller_is_closed(const sinricpro_door_controller_t *controller) {
     return controller ? controller->closed : false;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void door_controller_cap_init(void *state) {
+    sinricpro_door_controller_init(state);
+}
+
+static bool door_controller_cap_handle(void *state,
+                                       sinricpro_device_t *device,
+                                       sinricpro_action_t action,
+                                       const cJSON *request,
+                                       cJSON *response) {
+    return sinricpro_door_controller_handle_request(state, device, request, response);
+}
+
+static bool door_controller_cap_send(void *state,
+                                     const char *device_id,
+                                     sinricpro_action_t action,
+                                     const sinricpro_event_value_t *value) {
+    return sinricpro_door_controller_send_event(state, device_id, value->state);
+}
+
+static sinricpro_event_limiter_t *door_controller_cap_limiter(void *state) {
+    return &((sinricpro_door_controller_t *)state)->event_limiter;
+}
+
+static bool door_controller_cap_snapshot(const void *state,
+                                         sinricpro_action_t *action,
+                                         sinricpro_event_value_t *value) {
+    const sinricpro_door_controller_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_MODE;
+    value->state = cap->closed;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_door_controller = {
+    .name = "DoorController",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_MODE),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_MODE),
+    .init = door_controller_cap_init,
+    .handle = door_controller_cap_handle,
+    .send = door_controller_cap_send,
+    .limiter = door_controller_cap_limiter,
+    .snapshot = door_controller_cap_snapshot,
+};
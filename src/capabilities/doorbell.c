@@ -4,13 +4,12 @@
  */
 
 #include "sinricpro/capabilities/doorbell.h"
+#include "sinricpro/sinricpro_capability.h"
+#include "sinricpro/sinricpro.h"
 #include "core/sinricpro_debug.h"
 #include "cJSON.h"
 #include <string.h>
 
-// Declared in sinricpro.c
-extern bool sinricpro_send_event(const char *device_id, cJSON *event_message);
-
 void sinricpro_doorbell_cap_init(sinricpro_doorbell_cap_t *doorbell) {
     if (!doorbell) return;
     sinricpro_event_limiter_init_state(&doorbell->event_limiter);
@@ -22,27 +21,41 @@ bool sinricpro_doorbell_cap_send_event(sinricpro_doorbell_cap_t *doorbell,
         return false;
     }
 
-    // Check rate limiting (sensor state limit - allows more frequent events)
-    if (!sinricpro_event_limiter_check(&doorbell->event_limiter)) {
+    // Check rate limiting
+    if (sinricpro_event_limiter_check(&doorbell->event_limiter)) {
         SINRICPRO_WARN_PRINTF("[Doorbell] Event rate limited\n");
         return false;
     }
 
-    // Build event message
-    cJSON *event = cJSON_CreateObject();
-    if (!event) return false;
-
-    cJSON_AddStringToObject(event, "action", "DoorbellPress");
-    cJSON_AddStringToObject(event, "cause", "PHYSICAL_INTERACTION");
-
     cJSON *value = cJSON_CreateObject();
+    if (!value) return false;
+
     cJSON_AddStringToObject(value, "state", "pressed");
-    cJSON_AddItemToObject(event, "value", value);
 
     SINRICPRO_DEBUG_PRINTF("[Doorbell] Sending doorbell press event\n");
 
-    bool result = sinricpro_send_event(device_id, event);
-    cJSON_Delete(event);
+    return sinricpro_send_event(device_id, "DoorbellPress", value);
+}
 
-    return result;
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void doorbell_cap_init(void *state) {
+    sinricpro_doorbell_cap_init(state);
+}
+
+static bool doorbell_cap_send(void *state,
+                              const char *device_id,
+                              sinricpro_action_t action,
+                              const sinricpro_event_value_t *value) {
+    return sinricpro_doorbell_cap_send_event(state, device_id);
 }
+
+const sinricpro_capability_t sinricpro_capability_doorbell = {
+    .name = "Doorbell",
+    .requests = 0,
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_DOORBELL_PRESS),
+    .init = doorbell_cap_init,
+    .send = doorbell_cap_send,
+};
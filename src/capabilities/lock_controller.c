@@ -4,14 +4,13 @@
  */
 
 #include "sinricpro/capabilities/lock_controller.h"
+#include "sinricpro/sinricpro_capability.h"
+#include "sinricpro/sinricpro.h"
 #include "core/sinricpro_debug.h"
 #include "core/json_helpers.h"
 #include <string.h>
 #include <stdio.h>
 
-// Declared in sinricpro.c
-extern bool sinricpro_send_event(const char *device_id, cJSON *event_message);
-
 void sinricpro_lock_controller_init(sinricpro_lock_controller_t *controller) {
     if (!controller) return;
 
@@ -92,34 +91,75 @@ bool sinricpro_lock_controller_send_event(sinricpro_lock_controller_t *controlle
     }
 
     // Check rate limiting
-    if (!sinricpro_event_limiter_check(&controller->event_limiter)) {
+    if (sinricpro_event_limiter_check(&controller->event_limiter)) {
         SINRICPRO_WARN_PRINTF("[LockController] Event rate limited\n");
+        sinricpro_event_value_t latest = { .state = locked };
+        sinricpro_event_limiter_defer(&controller->event_limiter,
+                                      SINRICPRO_ACTION_SET_LOCK_STATE, &latest);
         return false;
     }
 
     // Update internal state
     controller->locked = locked;
 
-    // Build event message
-    cJSON *event = cJSON_CreateObject();
-    if (!event) return false;
-
-    cJSON_AddStringToObject(event, "action", "setLockState");
-    cJSON_AddStringToObject(event, "cause", "PHYSICAL_INTERACTION");
-
     cJSON *value = cJSON_CreateObject();
+    if (!value) return false;
+
     cJSON_AddStringToObject(value, "state", locked ? "LOCKED" : "UNLOCKED");
-    cJSON_AddItemToObject(event, "value", value);
 
     SINRICPRO_DEBUG_PRINTF("[LockController] Sending event: %s\n",
                             locked ? "LOCKED" : "UNLOCKED");
 
-    bool result = sinricpro_send_event(device_id, event);
-    cJSON_Delete(event);
-
-    return result;
+    return sinricpro_send_event(device_id, "setLockState", value);
 }
 
 bool sinricpro_lock_controller_is_locked(const sinricpro_lock_controller_t *controller) {
     return controller ? controller->locked : false;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void lock_controller_cap_init(void *state) {
+    sinricpro_lock_controller_init(state);
+}
+
+static bool lock_controller_cap_handle(void *state,
+                                       sinricpro_device_t *device,
+                                       sinricpro_action_t action,
+                                       const cJSON *request,
+                                       cJSON *response) {
+    return sinricpro_lock_controller_handle_request(state, device, request, response);
+}
+
+static bool lock_controller_cap_send(void *state,
+                                     const char *device_id,
+                                     sinricpro_action_t action,
+                                     const sinricpro_event_value_t *value) {
+    return sinricpro_lock_controller_send_event(state, device_id, value->state);
+}
+
+static sinricpro_event_limiter_t *lock_controller_cap_limiter(void *state) {
+    return &((sinricpro_lock_controller_t *)state)->event_limiter;
+}
+
+static bool lock_controller_cap_snapshot(const void *state,
+                                         sinricpro_action_t *action,
+                                         sinricpro_event_value_t *value) {
+    const sinricpro_lock_controller_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_LOCK_STATE;
+    value->state = cap->locked;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_lock_controller = {
+    .name = "LockController",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_LOCK_STATE),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_LOCK_STATE),
+    .init = lock_controller_cap_init,
+    .handle = lock_controller_cap_handle,
+    .send = lock_controller_cap_send,
+    .limiter = lock_controller_cap_limiter,
+    .snapshot = lock_controller_cap_snapshot,
+};
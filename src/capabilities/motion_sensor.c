@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/motion_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -27,6 +28,8 @@ bool sinricpro_motion_sensor_cap_send_event(sinricpro_motion_sensor_cap_t *cap,
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[MotionSensor] Event rate limited\n");
+        sinricpro_event_value_t latest = { .state = detected };
+        sinricpro_event_limiter_defer(&cap->event_limiter, SINRICPRO_ACTION_MOTION, &latest);
         return false;
     }
 
@@ -53,3 +56,41 @@ bool sinricpro_motion_sensor_cap_send_event(sinricpro_motion_sensor_cap_t *cap,
 bool sinricpro_motion_sensor_get_state(const sinricpro_motion_sensor_cap_t *cap) {
     return cap ? cap->motion_detected : false;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void motion_sensor_cap_init(void *state) {
+    sinricpro_motion_sensor_cap_init(state);
+}
+
+static bool motion_sensor_cap_send(void *state,
+                                   const char *device_id,
+                                   sinricpro_action_t action,
+                                   const sinricpro_event_value_t *value) {
+    return sinricpro_motion_sensor_cap_send_event(state, device_id, value->state);
+}
+
+static sinricpro_event_limiter_t *motion_sensor_cap_limiter(void *state) {
+    return &((sinricpro_motion_sensor_cap_t *)state)->event_limiter;
+}
+
+static bool motion_sensor_cap_snapshot(const void *state,
+                                       sinricpro_action_t *action,
+                                       sinricpro_event_value_t *value) {
+    const sinricpro_motion_sensor_cap_t *cap = state;
+    *action = SINRICPRO_ACTION_MOTION;
+    value->state = cap->motion_detected;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_motion_sensor = {
+    .name = "MotionSensor",
+    .requests = 0,
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_MOTION),
+    .init = motion_sensor_cap_init,
+    .send = motion_sensor_cap_send,
+    .limiter = motion_sensor_cap_limiter,
+    .snapshot = motion_sensor_cap_snapshot,
+};
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/power_level.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -127,6 +128,9 @@ bool sinricpro_power_level_send_event(sinricpro_power_level_t *power_level,
     // Check rate limit
     if (sinricpro_event_limiter_check(&power_level->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[PowerLevel] Event rate limited\n");
+        sinricpro_event_value_t latest = { .level = level };
+        sinricpro_event_limiter_defer(&power_level->event_limiter,
+                                      SINRICPRO_ACTION_SET_POWER_LEVEL, &latest);
         return false;
     }
 
@@ -152,3 +156,54 @@ bool sinricpro_power_level_send_event(sinricpro_power_level_t *power_level,
 int sinricpro_power_level_get_value(const sinricpro_power_level_t *power_level) {
     return power_level ? power_level->current_power_level : 0;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void power_level_cap_init(void *state) {
+    sinricpro_power_level_init(state);
+}
+
+static bool power_level_cap_handle(void *state,
+                                   sinricpro_device_t *device,
+                                   sinricpro_action_t action,
+                                   const cJSON *request,
+                                   cJSON *response) {
+    if (action == SINRICPRO_ACTION_ADJUST_POWER_LEVEL) {
+        return sinricpro_power_level_handle_adjust_request(state, device, request, response);
+    }
+    return sinricpro_power_level_handle_set_request(state, device, request, response);
+}
+
+static bool power_level_cap_send(void *state,
+                                 const char *device_id,
+                                 sinricpro_action_t action,
+                                 const sinricpro_event_value_t *value) {
+    return sinricpro_power_level_send_event(state, device_id, (int)value->level);
+}
+
+static sinricpro_event_limiter_t *power_level_cap_limiter(void *state) {
+    return &((sinricpro_power_level_t *)state)->event_limiter;
+}
+
+static bool power_level_cap_snapshot(const void *state,
+                                     sinricpro_action_t *action,
+                                     sinricpro_event_value_t *value) {
+    const sinricpro_power_level_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_POWER_LEVEL;
+    value->level = cap->current_power_level;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_power_level = {
+    .name = "PowerLevel",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_POWER_LEVEL) |
+                SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_ADJUST_POWER_LEVEL),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_POWER_LEVEL),
+    .init = power_level_cap_init,
+    .handle = power_level_cap_handle,
+    .send = power_level_cap_send,
+    .limiter = power_level_cap_limiter,
+    .snapshot = power_level_cap_snapshot,
+};
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/power_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "core/sinricpro_debug.h"
 #include "cJSON.h"
 #include "pico/time.h"
@@ -105,3 +106,18 @@ bool sinricpro_power_sensor_send_event(sinricpro_power_sensor_t *sensor,
 
     return result;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void power_sensor_cap_init(void *state) {
+    sinricpro_power_sensor_init(state);
+}
+
+const sinricpro_capability_t sinricpro_capability_power_sensor = {
+    .name = "PowerSensor",
+    .requests = 0,
+    .events = 0,
+    .init = power_sensor_cap_init,
+};
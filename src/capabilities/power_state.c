@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/power_state.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -81,6 +82,9 @@ bool sinricpro_power_state_send_event(sinricpro_power_state_t *cap,
     // Check rate limit
     if (sinricpro_event_limiter_check(&cap->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[PowerState] Event rate limited\n");
+        sinricpro_event_value_t latest = { .state = state };
+        sinricpro_event_limiter_defer(&cap->event_limiter,
+                                      SINRICPRO_ACTION_SET_POWER_STATE, &latest);
         return false;
     }
 
@@ -106,3 +110,50 @@ bool sinricpro_power_state_send_event(sinricpro_power_state_t *cap,
 bool sinricpro_power_state_get_state(const sinricpro_power_state_t *cap) {
     return cap ? cap->current_state : false;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void power_state_cap_init(void *state) {
+    sinricpro_power_state_init(state);
+}
+
+static bool power_state_cap_handle(void *state,
+                                   sinricpro_device_t *device,
+                                   sinricpro_action_t action,
+                                   const cJSON *request,
+                                   cJSON *response) {
+    return sinricpro_power_state_handle_request(state, device, request, response);
+}
+
+static bool power_state_cap_send(void *state,
+                                 const char *device_id,
+                                 sinricpro_action_t action,
+                                 const sinricpro_event_value_t *value) {
+    return sinricpro_power_state_send_event(state, device_id, value->state);
+}
+
+static sinricpro_event_limiter_t *power_state_cap_limiter(void *state) {
+    return &((sinricpro_power_state_t *)state)->event_limiter;
+}
+
+static bool power_state_cap_snapshot(const void *state,
+                                     sinricpro_action_t *action,
+                                     sinricpro_event_value_t *value) {
+    const sinricpro_power_state_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_POWER_STATE;
+    value->state = cap->current_state;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_power_state = {
+    .name = "PowerState",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_POWER_STATE),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_POWER_STATE),
+    .init = power_state_cap_init,
+    .handle = power_state_cap_handle,
+    .send = power_state_cap_send,
+    .limiter = power_state_cap_limiter,
+    .snapshot = power_state_cap_snapshot,
+};
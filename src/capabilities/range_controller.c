@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/range_controller.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "core/sinricpro_debug.h"
 #include "core/json_helpers.h"
 #include "cJSON.h"
@@ -141,6 +142,9 @@ bool sinricpro_range_controller_send_event(sinricpro_range_controller_t *control
     // Check rate limit
     if (sinricpro_event_limiter_check(&controller->event_limiter)) {
         SINRICPRO_DEBUG_PRINTF("[RangeController] Event rate limited\n");
+        sinricpro_event_value_t latest = { .level = range_value };
+        sinricpro_event_limiter_defer(&controller->event_limiter,
+                                      SINRICPRO_ACTION_SET_RANGE_VALUE, &latest);
         return false;
     }
 
@@ -166,3 +170,54 @@ bool sinricpro_range_controller_send_event(sinricpro_range_controller_t *control
 int sinricpro_range_controller_get_value(const sinricpro_range_controller_t *controller) {
     return controller ? controller->range_value : 0;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void range_controller_cap_init(void *state) {
+    sinricpro_range_controller_init(state);
+}
+
+static bool range_controller_cap_handle(void *state,
+                                        sinricpro_device_t *device,
+                                        sinricpro_action_t action,
+                                        const cJSON *request,
+                                        cJSON *response) {
+    if (action == SINRICPRO_ACTION_ADJUST_RANGE_VALUE) {
+        return sinricpro_range_controller_handle_adjust_request(state, device, request, response);
+    }
+    return sinricpro_range_controller_handle_set_request(state, device, request, response);
+}
+
+static bool range_controller_cap_send(void *state,
+                                      const char *device_id,
+                                      sinricpro_action_t action,
+                                      const sinricpro_event_value_t *value) {
+    return sinricpro_range_controller_send_event(state, device_id, (int)value->level);
+}
+
+static sinricpro_event_limiter_t *range_controller_cap_limiter(void *state) {
+    return &((sinricpro_range_controller_t *)state)->event_limiter;
+}
+
+static bool range_controller_cap_snapshot(const void *state,
+                                          sinricpro_action_t *action,
+                                          sinricpro_event_value_t *value) {
+    const sinricpro_range_controller_t *cap = state;
+    *action = SINRICPRO_ACTION_SET_RANGE_VALUE;
+    value->level = cap->range_value;
+    return true;
+}
+
+const sinricpro_capability_t sinricpro_capability_range_controller = {
+    .name = "RangeController",
+    .requests = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_RANGE_VALUE) |
+                SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_ADJUST_RANGE_VALUE),
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_SET_RANGE_VALUE),
+    .init = range_controller_cap_init,
+    .handle = range_controller_cap_handle,
+    .send = range_controller_cap_send,
+    .limiter = range_controller_cap_limiter,
+    .snapshot = range_controller_cap_snapshot,
+};
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/capabilities/temperature_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/sinricpro.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -61,3 +62,28 @@ float sinricpro_temperature_sensor_get_temperature(const sinricpro_temperature_s
 float sinricpro_temperature_sensor_get_humidity(const sinricpro_temperature_sensor_cap_t *cap) {
     return cap ? cap->humidity : 0.0f;
 }
+
+// ============================================================================
+// Capability Descriptor
+// ============================================================================
+
+static void temperature_sensor_cap_init(void *state) {
+    sinricpro_temperature_sensor_cap_init(state);
+}
+
+static bool temperature_sensor_cap_send(void *state,
+                                        const char *device_id,
+                                        sinricpro_action_t action,
+                                        const sinricpro_event_value_t *value) {
+    return sinricpro_temperature_sensor_cap_send_event(state, device_id,
+                                                       value->climate.temperature,
+                                                       value->climate.humidity);
+}
+
+const sinricpro_capability_t sinricpro_capability_temperature_sensor = {
+    .name = "TemperatureSensor",
+    .requests = 0,
+    .events = SINRICPRO_ACTION_BIT(SINRICPRO_ACTION_CURRENT_TEMPERATURE),
+    .init = temperature_sensor_cap_init,
+    .send = temperature_sensor_cap_send,
+};
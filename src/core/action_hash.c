@@ -0,0 +1,73 @@
+/**
+ * @file action_hash.c
+ * @brief Action name to identifier perfect hash
+ *
+ * GENERATED by scripts/gen_action_hash.py from sinricpro_actions.h.
+ * Do not edit; add actions to the header and rebuild.
+ */
+
+#include "sinricpro/sinricpro_actions.h"
+#include <string.h>
+
+#define ACTION_MIN_LEN  7
+#define ACTION_MAX_LEN  24
+#define ACTION_HEAD     0
+#define ACTION_TAIL     1
+#define ACTION_MULT     7u
+#define ACTION_SHIFT    23
+#define ACTION_MASK     31u
+
+static const uint8_t action_slots[32] = {
+    SINRICPRO_ACTION_UNKNOWN,                     // 0
+    SINRICPRO_ACTION_UNKNOWN,                     // 1
+    SINRICPRO_ACTION_UNKNOWN,                     // 2
+    SINRICPRO_ACTION_SET_POWER_LEVEL,             // 3
+    SINRICPRO_ACTION_UNKNOWN,                     // 4
+    SINRICPRO_ACTION_UNKNOWN,                     // 5
+    SINRICPRO_ACTION_DOORBELL_PRESS,              // 6
+    SINRICPRO_ACTION_ADJUST_BRIGHTNESS,           // 7
+    SINRICPRO_ACTION_SET_COLOR,                   // 8
+    SINRICPRO_ACTION_UNKNOWN,                     // 9
+    SINRICPRO_ACTION_SET_RANGE_VALUE,             // 10
+    SINRICPRO_ACTION_DECREASE_COLOR_TEMPERATURE,  // 11
+    SINRICPRO_ACTION_UNKNOWN,                     // 12
+    SINRICPRO_ACTION_SET_POWER_STATE,             // 13
+    SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE,  // 14
+    SINRICPRO_ACTION_UNKNOWN,                     // 15
+    SINRICPRO_ACTION_CONTACT,                     // 16
+    SINRICPRO_ACTION_SET_BRIGHTNESS,              // 17
+    SINRICPRO_ACTION_POWER_USAGE,                 // 18
+    SINRICPRO_ACTION_UNKNOWN,                     // 19
+    SINRICPRO_ACTION_UNKNOWN,                     // 20
+    SINRICPRO_ACTION_UNKNOWN,                     // 21
+    SINRICPRO_ACTION_MOTION,                      // 22
+    SINRICPRO_ACTION_UNKNOWN,                     // 23
+    SINRICPRO_ACTION_UNKNOWN,                     // 24
+    SINRICPRO_ACTION_ADJUST_POWER_LEVEL,          // 25
+    SINRICPRO_ACTION_AIR_QUALITY,                 // 26
+    SINRICPRO_ACTION_CURRENT_TEMPERATURE,         // 27
+    SINRICPRO_ACTION_SET_LOCK_STATE,              // 28
+    SINRICPRO_ACTION_SET_COLOR_TEMPERATURE,       // 29
+    SINRICPRO_ACTION_SET_MODE,                    // 30
+    SINRICPRO_ACTION_ADJUST_RANGE_VALUE           // 31
+};
+
+sinricpro_action_t sinricpro_action_from_name(const char *name, size_t len) {
+    if (!name || len < ACTION_MIN_LEN || len > ACTION_MAX_LEN) {
+        return SINRICPRO_ACTION_UNKNOWN;
+    }
+
+    uint32_t h = (uint32_t)len * 31u
+               + (uint8_t)name[ACTION_HEAD] * ACTION_MULT
+               + (uint8_t)name[len - 1 - ACTION_TAIL];
+    sinricpro_action_t action =
+        (sinricpro_action_t)action_slots[((h * 0x9E3779B1u) >> ACTION_SHIFT) & ACTION_MASK];
+
+    // One candidate per slot: confirm it
+    const char *expected = sinricpro_action_name(action);
+    if (!expected || strlen(expected) != len || memcmp(expected, name, len) != 0) {
+        return SINRICPRO_ACTION_UNKNOWN;
+    }
+
+    return action;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file device_table.c
+ * @brief Open-addressed device lookup table implementation
+ */
+
+#include "device_table.h"
+#include <string.h>
+
+static inline bool key_equal(const sinricpro_device_key_t *a, const sinricpro_device_key_t *b) {
+    return a->words[0] == b->words[0] &&
+           a->words[1] == b->words[1] &&
+           a->words[2] == b->words[2];
+}
+
+// Device IDs are ObjectIds (timestamp | random | counter); fold and mix
+static inline size_t key_home(const sinricpro_device_table_t *table,
+                              const sinricpro_device_key_t *key) {
+    uint32_t h = key->words[0] ^ key->words[1] ^ key->words[2];
+    return ((h * 0x9E3779B1u) >> 16) & (table->size - 1);
+}
+
+// Slot currently holding a registry position (must be present)
+static size_t slot_of(const sinricpro_device_table_t *table,
+                      sinricpro_device_t *const *devices,
+                      size_t index) {
+    size_t mask = table->size - 1;
+    size_t pos = key_home(table, &devices[index]->key);
+
+    for (size_t probes = 0; probes < table->size; probes++) {
+        if (table->slots[pos] == index + 1) {
+            return pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return table->size;
+}
+
+void sinricpro_device_table_build(sinricpro_device_table_t *table,
+                                  sinricpro_device_t *const *devices,
+                                  size_t count) {
+    if (!table || !table->slots) return;
+
+    memset(table->slots, 0, table->size);
+    for (size_t i = 0; i < count; i++) {
+        sinricpro_device_table_insert(table, devices, i);
+    }
+}
+
+void sinricpro_device_table_insert(sinricpro_device_table_t *table,
+                                   sinricpro_device_t *const *devices,
+                                   size_t index) {
+    if (!table || !table->slots || !devices) return;
+
+    // Load factor <= 0.5, so an empty slot always exists
+    size_t mask = table->size - 1;
+    size_t pos = key_home(table, &devices[index]->key);
+    while (table->slots[pos] != 0) {
+        pos = (pos + 1) & mask;
+    }
+    table->slots[pos] = (uint8_t)(index + 1);
+}
+
+void sinricpro_device_table_remove(sinricpro_device_table_t *table,
+                                   sinricpro_device_t *const *devices,
+                                   size_t index) {
+    if (!table || !table->slots || !devices) return;
+
+    size_t mask = table->size - 1;
+    size_t hole = slot_of(table, devices, index);
+    if (hole >= table->size) return;
+
+    // Backward-shift deletion: pull later entries of the cluster into the
+    // hole unless that would move them before their home slot
+    size_t next = hole;
+    while (true) {
+        table->slots[hole] = 0;
+
+        while (true) {
+            next = (next + 1) & mask;
+            uint8_t slot = table->slots[next];
+            if (slot == 0) {
+                return;
+            }
+
+            size_t home = key_home(table, &devices[slot - 1]->key);
+            bool stays = (hole <= next) ? (hole < home && home <= next)
+                                        : (hole < home || home <= next);
+            if (!stays) {
+                break;
+            }
+        }
+
+        table->slots[hole] = table->slots[next];
+        hole = next;
+    }
+}
+
+void sinricpro_device_table_move(sinricpro_device_table_t *table,
+                                 sinricpro_device_t *const *devices,
+                                 size_t old_index,
+                                 size_t new_index) {
+    if (!table || !table->slots || !devices) return;
+
+    size_t pos = slot_of(table, devices, old_index);
+    if (pos < table->size) {
+        table->slots[pos] = (uint8_t)(new_index + 1);
+    }
+}
+
+int sinricpro_device_table_find(const sinricpro_device_table_t *table,
+                                sinricpro_device_t *const *devices,
+                                const sinricpro_device_key_t *key) {
+    if (!table || !table->slots || !devices || !key) return -1;
+
+    size_t mask = table->size - 1;
+    size_t pos = key_home(table, key);
+    for (size_t probes = 0; probes < table->size; probes++) {
+        uint8_t slot = table->slots[pos];
+        if (slot == 0) {
+            return -1;
+        }
+        if (key_equal(&devices[slot - 1]->key, key)) {
+            return slot - 1;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return -1;
+}
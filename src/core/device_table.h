@@ -0,0 +1,96 @@
+/**
+ * @file device_table.h
+ * @brief Open-addressed device lookup table for SinricPro
+ *
+ * Maps binary device keys to positions in the device registry. Slots hold
+ * registry position + 1 (0 = empty), so zeroed storage is a valid empty
+ * table. Probing is linear and removal uses backward-shift deletion, so
+ * add, remove and lookup are all constant time on average.
+ */
+
+#ifndef SINRICPRO_DEVICE_TABLE_H
+#define SINRICPRO_DEVICE_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_device.h"
+
+/**
+ * @brief Device lookup table (storage supplied by the registry)
+ */
+typedef struct {
+    uint8_t *slots;
+    size_t size;                        // Power of two, >= 2x registry capacity
+} sinricpro_device_table_t;
+
+/**
+ * @brief Rebuild the table from the registry
+ *
+ * @param table   Table
+ * @param devices Registry array
+ * @param count   Number of registered devices
+ */
+void sinricpro_device_table_build(sinricpro_device_table_t *table,
+                                  sinricpro_device_t *const *devices,
+                                  size_t count);
+
+/**
+ * @brief Add a registry position to the table
+ *
+ * @param table   Table
+ * @param devices Registry array (devices[index] must already be set)
+ * @param index   Registry position of the new device
+ */
+void sinricpro_device_table_insert(sinricpro_device_table_t *table,
+                                   sinricpro_device_t *const *devices,
+                                   size_t index);
+
+/**
+ * @brief Remove a registry position from the table
+ *
+ * @param table   Table
+ * @param devices Registry array (devices[index] must still be set)
+ * @param index   Registry position to remove
+ */
+void sinricpro_device_table_remove(sinricpro_device_table_t *table,
+                                   sinricpro_device_t *const *devices,
+                                   size_t index);
+
+/**
+ * @brief Point the entry for a device at a new registry position
+ *
+ * Used when the registry moves its last device into a freed position.
+ *
+ * @param table     Table
+ * @param devices   Registry array (devices[old_index] must still be set)
+ * @param old_index Current registry position
+ * @param new_index New registry position
+ */
+void sinricpro_device_table_move(sinricpro_device_table_t *table,
+                                 sinricpro_device_t *const *devices,
+                                 size_t old_index,
+                                 size_t new_index);
+
+/**
+ * @brief Look up a device by key
+ *
+ * @param table   Table
+ * @param devices Registry array
+ * @param key     Key to find
+ * @return Registry position, or -1 if not registered
+ */
+int sinricpro_device_table_find(const sinricpro_device_table_t *table,
+                                sinricpro_device_t *const *devices,
+                                const sinricpro_device_key_t *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_DEVICE_TABLE_H
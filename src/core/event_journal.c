@@ -0,0 +1,480 @@
+/**
+ * @file event_journal.c
+ * @brief Offline event journal implementation
+ */
+
+#include "event_journal.h"
+#include "event_scheduler.h"
+#include "sinricpro_debug.h"
+#include "pico/flash.h"
+#include <string.h>
+
+#define JOURNAL_SIZE        (SINRICPRO_JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+#define JOURNAL_OFFSET      (PICO_FLASH_SIZE_BYTES - JOURNAL_SIZE)
+#define JOURNAL_MAGIC       0x4A53      // "SJ"
+#define MARK_INTERVAL       8           // Replayed records between marks
+#define LOCKOUT_TIMEOUT_MS  100         // Wait for the other core to pause
+
+#define PADDED(len)         (((uint32_t)(len) + 3u) & ~3u)
+
+// Linker script symbol: end of the program image in flash
+extern char __flash_binary_end;
+
+typedef enum {
+    RECORD_EVENT = 1,
+    RECORD_MARK                         // created_at holds replayed_seq
+} record_type_t;
+
+// Record header, followed by the value text
+typedef struct {
+    uint16_t magic;
+    uint16_t length;                    // Header and value, before padding
+    uint32_t crc;                       // CRC-32 of everything after this field
+    uint32_t seq;
+    uint32_t created_at;
+    uint16_t boot;
+    uint8_t type;
+    uint8_t action;
+    uint8_t flags;
+    uint8_t reserved[3];
+    sinricpro_device_key_t key;
+} record_t;
+
+typedef enum {
+    SLOT_BLANK = 0,                     // Erased, or too little room left in the page
+    SLOT_RECORD,
+    SLOT_CORRUPT
+} slot_t;
+
+_Static_assert(sizeof(record_t) == 36, "Journal record header layout");
+_Static_assert(sizeof(record_t) + SINRICPRO_JOURNAL_VALUE_MAX <= FLASH_PAGE_SIZE,
+               "A journal record must fit in one flash page");
+_Static_assert(SINRICPRO_JOURNAL_SECTORS >= 3,
+               "The journal needs a sector being written, a spare and an oldest sector");
+
+// =============================================================================
+// Flash access
+// =============================================================================
+
+static inline const uint8_t *flash_at(uint32_t offset) {
+    return (const uint8_t *)(XIP_BASE + JOURNAL_OFFSET + offset);
+}
+
+static inline uint32_t wrap(uint32_t offset) {
+    return offset % JOURNAL_SIZE;
+}
+
+static inline uint32_t page_end(uint32_t offset) {
+    return offset - offset % FLASH_PAGE_SIZE + FLASH_PAGE_SIZE;
+}
+
+static bool is_blank(uint32_t offset, size_t size) {
+    const uint32_t *words = (const uint32_t *)flash_at(offset);
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+        if (words[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} flash_op_t;
+
+static void erase_op(void *param) {
+    const flash_op_t *op = param;
+    flash_range_erase(JOURNAL_OFFSET + op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void program_op(void *param) {
+    const flash_op_t *op = param;
+    flash_range_program(JOURNAL_OFFSET + op->offset, op->data, FLASH_PAGE_SIZE);
+}
+
+// Runs with interrupts off and the other core paused
+static bool run_flash_op(sinricpro_journal_t *journal, void (*func)(void *),
+                         uint32_t offset, const uint8_t *data) {
+    flash_op_t op = { offset, data };
+    if (flash_safe_execute(func, &op, LOCKOUT_TIMEOUT_MS) != PICO_OK) {
+        journal->flash_errors++;
+        SINRICPRO_WARN_PRINTF("[SinricPro] Journal flash write failed\n");
+        return false;
+    }
+    return true;
+}
+
+// =============================================================================
+// Records
+// =============================================================================
+
+// Nibble-table CRC-32 (IEEE)
+static uint32_t crc32(const uint8_t *data, size_t len) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+#define CRC_START offsetof(record_t, seq)
+
+// Record at data, with room bytes left in its page
+static slot_t parse_record(const uint8_t *data, size_t room, record_t *record) {
+    if (room < sizeof(record_t)) return SLOT_BLANK;
+
+    memcpy(record, data, sizeof(record_t));
+    if (record->magic == 0xFFFF) return SLOT_BLANK;
+
+    if (record->magic != JOURNAL_MAGIC || record->length < sizeof(record_t) ||
+        PADDED(record->length) > room) {
+        return SLOT_CORRUPT;
+    }
+    if (crc32(data + CRC_START, record->length - CRC_START) != record->crc) {
+        return SLOT_CORRUPT;
+    }
+    return SLOT_RECORD;
+}
+
+static slot_t record_at(uint32_t offset, record_t *record) {
+    return parse_record(flash_at(offset), FLASH_PAGE_SIZE - offset % FLASH_PAGE_SIZE, record);
+}
+
+// Offset after a slot. A record failing only its CRC is stepped over; a
+// blank slot or a broken header ends its page
+static uint32_t skip(uint32_t offset, slot_t slot, const record_t *record) {
+    bool framed = slot == SLOT_RECORD ||
+                  (slot == SLOT_CORRUPT && record->magic == JOURNAL_MAGIC &&
+                   record->length >= sizeof(record_t) &&
+                   offset % FLASH_PAGE_SIZE + PADDED(record->length) <= FLASH_PAGE_SIZE);
+    return wrap(framed ? offset + PADDED(record->length) : page_end(offset));
+}
+
+static inline bool is_newer(uint32_t seq, uint32_t than) {
+    return (int32_t)(seq - than) > 0;
+}
+
+static bool same_property(const record_t *a, const record_t *b) {
+    return b->type == RECORD_EVENT && a->action == b->action &&
+           memcmp(&a->key, &b->key, sizeof(a->key)) == 0;
+}
+
+// Whether an event with the same device and action follows offset
+static bool superseded(const sinricpro_journal_t *journal, uint32_t offset, const record_t *record) {
+    record_t later;
+
+    while (offset != journal->head) {
+        slot_t slot = record_at(offset, &later);
+        if (slot == SLOT_RECORD && same_property(record, &later)) return true;
+        offset = skip(offset, slot, &later);
+    }
+
+    for (uint32_t at = 0; at < journal->page_fill; at += PADDED(later.length)) {
+        if (parse_record(journal->page + at, FLASH_PAGE_SIZE - at, &later) != SLOT_RECORD) break;
+        if (same_property(record, &later)) return true;
+    }
+    return false;
+}
+
+// =============================================================================
+// Writing
+// =============================================================================
+
+static void flush_page(sinricpro_journal_t *journal);
+
+// Add a record to the page buffer, programming the page first if it is full
+static void buffer_record(sinricpro_journal_t *journal, record_t *record,
+                          const uint8_t *value, size_t value_len, uint32_t now_ms) {
+    uint32_t size = PADDED(sizeof(record_t) + value_len);
+    if (journal->page_fill + size > FLASH_PAGE_SIZE) {
+        flush_page(journal);
+    }
+
+    record->magic = JOURNAL_MAGIC;
+    record->length = (uint16_t)(sizeof(record_t) + value_len);
+    record->seq = journal->next_seq++;
+
+    // Padding stays 0xFF from the buffer reset
+    uint8_t *data = journal->page + journal->page_fill;
+    memcpy(data, record, sizeof(record_t));
+    if (value_len > 0) {
+        memcpy(data + sizeof(record_t), value, value_len);
+    }
+    record->crc = crc32(data + CRC_START, record->length - CRC_START);
+    memcpy(data + offsetof(record_t, crc), &record->crc, sizeof(record->crc));
+
+    if (journal->page_fill == 0) {
+        journal->page_since_ms = now_ms;
+    }
+    journal->page_fill += size;
+    if (record->type == RECORD_EVENT) {
+        journal->page_events++;
+    }
+}
+
+static void write_mark(sinricpro_journal_t *journal, uint32_t now_ms) {
+    record_t mark = {0};
+    mark.type = RECORD_MARK;
+    mark.created_at = journal->replayed_seq;
+    buffer_record(journal, &mark, NULL, 0, now_ms);
+    journal->since_mark = 0;
+}
+
+// Copy a record to the head; false if that would leave the head's sector
+static bool carry(sinricpro_journal_t *journal, uint32_t offset, const record_t *record,
+                  uint32_t now_ms) {
+    size_t value_len = record->length - sizeof(record_t);
+    bool last_page = (journal->head + FLASH_PAGE_SIZE) % FLASH_SECTOR_SIZE == 0;
+    if (last_page && journal->page_fill + PADDED(record->length) > FLASH_PAGE_SIZE) {
+        return false;
+    }
+
+    record_t copy = *record;
+    buffer_record(journal, &copy, flash_at(offset) + sizeof(record_t), value_len, now_ms);
+    return true;
+}
+
+// Before a sector is erased, move its unreplayed latest values to the head
+static void carry_forward(sinricpro_journal_t *journal, uint32_t sector, uint32_t now_ms) {
+    uint32_t offset = sector;
+
+    do {
+        record_t record;
+        slot_t slot = record_at(offset, &record);
+        uint32_t next = skip(offset, slot, &record);
+
+        if (slot == SLOT_RECORD && record.type == RECORD_EVENT &&
+            !is_newer(journal->replayed_seq, record.seq)) {
+            if (sinricpro_event_coalesces((sinricpro_action_t)record.action) &&
+                superseded(journal, next, &record)) {
+                journal->compacted++;
+            } else if (!carry(journal, offset, &record, now_ms)) {
+                journal->lost++;
+            }
+        }
+        offset = next;
+    } while (offset % FLASH_SECTOR_SIZE != 0);
+}
+
+// Keep the sector after the head's erased; called when the head enters a sector
+static void prepare_spare(sinricpro_journal_t *journal, uint32_t now_ms) {
+    uint32_t spare = wrap(journal->head - journal->head % FLASH_SECTOR_SIZE + FLASH_SECTOR_SIZE);
+    if (is_blank(spare, FLASH_SECTOR_SIZE)) return;
+
+    carry_forward(journal, spare, now_ms);
+    if (journal->read >= spare && journal->read < spare + FLASH_SECTOR_SIZE) {
+        journal->read = wrap(spare + FLASH_SECTOR_SIZE);
+    }
+    run_flash_op(journal, erase_op, spare, NULL);
+}
+
+static void flush_page(sinricpro_journal_t *journal) {
+    if (journal->page_fill == 0) return;
+
+    if (!run_flash_op(journal, program_op, journal->head, journal->page)) {
+        journal->lost += journal->page_events;
+    }
+
+    uint32_t now = journal->page_since_ms;
+    memset(journal->page, 0xFF, sizeof(journal->page));
+    journal->page_fill = 0;
+    journal->page_events = 0;
+
+    journal->head = wrap(journal->head + FLASH_PAGE_SIZE);
+    if (journal->head % FLASH_SECTOR_SIZE == 0) {
+        prepare_spare(journal, now);
+    }
+}
+
+// =============================================================================
+// Public API
+// =============================================================================
+
+void sinricpro_journal_init(sinricpro_journal_t *journal) {
+    if (!journal) return;
+
+    memset(journal, 0, sizeof(sinricpro_journal_t));
+    memset(journal->page, 0xFF, sizeof(journal->page));
+
+    if ((uintptr_t)&__flash_binary_end > XIP_BASE + JOURNAL_OFFSET) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Journal region overlaps the program, journal disabled\n");
+        return;
+    }
+    journal->enabled = true;
+
+    // Newest record, oldest event, last mark
+    bool found = false, have_event = false, marked = false;
+    uint32_t newest = 0, newest_end = 0, oldest = 0, replayed = 0;
+    uint16_t boot = 0;
+    uint32_t offset = 0;
+    do {
+        record_t record;
+        slot_t slot = record_at(offset, &record);
+        uint32_t next = skip(offset, slot, &record);
+
+        if (slot == SLOT_RECORD) {
+            if (!found || is_newer(record.seq, newest)) {
+                newest = record.seq;
+                newest_end = next;
+                boot = record.boot;
+            }
+            if (record.type == RECORD_EVENT && (!have_event || is_newer(oldest, record.seq))) {
+                oldest = record.seq;
+                have_event = true;
+            }
+            if (record.type == RECORD_MARK && (!marked || is_newer(record.created_at, replayed))) {
+                replayed = record.created_at;
+                marked = true;
+            }
+            found = true;
+        } else if (slot == SLOT_CORRUPT) {
+            journal->corrupt++;
+        }
+        offset = next;
+    } while (offset != 0);
+
+    if (!found) {
+        // Fresh region: clear whatever a previous program left there
+        for (uint32_t sector = 0; sector < JOURNAL_SIZE; sector += FLASH_SECTOR_SIZE) {
+            if (!is_blank(sector, FLASH_SECTOR_SIZE)) {
+                run_flash_op(journal, erase_op, sector, NULL);
+            }
+        }
+        journal->boot = 1;
+        journal->next_seq = 1;
+        journal->replayed_seq = 1;
+        return;
+    }
+
+    journal->boot = (uint16_t)(boot + 1);
+    journal->next_seq = newest + 1;
+    journal->replayed_seq = marked ? replayed : (have_event ? oldest : journal->next_seq);
+
+    // Resume on the page after the newest record, past any page a lost
+    // power cut left half-programmed
+    journal->head = newest_end % FLASH_PAGE_SIZE ? wrap(page_end(newest_end)) : newest_end;
+    while (journal->head % FLASH_SECTOR_SIZE != 0 && !is_blank(journal->head, FLASH_PAGE_SIZE)) {
+        journal->head = wrap(journal->head + FLASH_PAGE_SIZE);
+    }
+    if (journal->head % FLASH_SECTOR_SIZE == 0 && !is_blank(journal->head, FLASH_SECTOR_SIZE)) {
+        run_flash_op(journal, erase_op, journal->head, NULL);
+    }
+
+    // Replay starts at the oldest sector, the one after the spare
+    uint32_t sector = journal->head - journal->head % FLASH_SECTOR_SIZE;
+    journal->read = wrap(sector + 2 * FLASH_SECTOR_SIZE);
+    prepare_spare(journal, 0);
+
+    SINRICPRO_DEBUG_PRINTF("[SinricPro] Journal opened, boot %u, next seq %lu, replayed to %lu\n",
+                           journal->boot, (unsigned long)journal->next_seq,
+                           (unsigned long)journal->replayed_seq);
+}
+
+bool sinricpro_journal_append(sinricpro_journal_t *journal,
+                              const sinricpro_device_key_t *key,
+                              sinricpro_action_t action,
+                              uint32_t created_at,
+                              uint8_t flags,
+                              const char *value,
+                              size_t value_len,
+                              uint32_t now_ms) {
+    if (!journal || !journal->enabled || !key || !value ||
+        value_len > SINRICPRO_JOURNAL_VALUE_MAX) {
+        return false;
+    }
+
+    record_t record = {0};
+    record.type = RECORD_EVENT;
+    record.action = (uint8_t)action;
+    record.flags = flags;
+    record.boot = journal->boot;
+    record.created_at = created_at;
+    record.key = *key;
+    buffer_record(journal, &record, (const uint8_t *)value, value_len, now_ms);
+
+    journal->appended++;
+    return true;
+}
+
+void sinricpro_journal_poll(sinricpro_journal_t *journal, uint32_t now_ms) {
+    if (!journal || journal->page_fill == 0) return;
+
+    if ((now_ms - journal->page_since_ms) >= SINRICPRO_JOURNAL_FLUSH_MS) {
+        flush_page(journal);
+    }
+}
+
+void sinricpro_journal_flush(sinricpro_journal_t *journal) {
+    if (!journal || !journal->enabled) return;
+
+    flush_page(journal);
+}
+
+bool sinricpro_journal_pending(const sinricpro_journal_t *journal) {
+    return journal && journal->enabled &&
+           (journal->read != journal->head || journal->page_events > 0);
+}
+
+bool sinricpro_journal_next(sinricpro_journal_t *journal,
+                            sinricpro_journal_entry_t *entry,
+                            uint32_t now_ms) {
+    if (!journal || !journal->enabled || !entry) return false;
+
+    // Written before reading on, so the previous entry stayed valid
+    if (journal->since_mark >= MARK_INTERVAL) {
+        write_mark(journal, now_ms);
+    }
+
+    // Events still in RAM are programmed first and read like the rest
+    if (journal->page_events > 0) {
+        flush_page(journal);
+    }
+
+    while (journal->read != journal->head) {
+        uint32_t offset = journal->read;
+        record_t record;
+        slot_t slot = record_at(offset, &record);
+        journal->read = skip(offset, slot, &record);
+
+        if (slot == SLOT_CORRUPT) {
+            journal->corrupt++;
+            continue;
+        }
+        if (slot != SLOT_RECORD || record.type != RECORD_EVENT ||
+            is_newer(journal->replayed_seq, record.seq)) {
+            continue;
+        }
+
+        journal->replayed_seq = record.seq + 1;
+        journal->since_mark++;
+
+#if SINRICPRO_JOURNAL_COMPACT
+        if (sinricpro_event_coalesces((sinricpro_action_t)record.action) &&
+            superseded(journal, journal->read, &record)) {
+            journal->compacted++;
+            continue;
+        }
+#endif
+
+        entry->key = record.key;
+        entry->action = (sinricpro_action_t)record.action;
+        entry->flags = record.flags;
+        entry->boot = record.boot;
+        entry->created_at = record.created_at;
+        entry->value = (const char *)flash_at(offset) + sizeof(record_t);
+        entry->value_len = record.length - sizeof(record_t);
+        journal->replayed++;
+        return true;
+    }
+
+    if (journal->since_mark > 0) {
+        write_mark(journal, now_ms);
+    }
+    return false;
+}
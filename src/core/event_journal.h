@@ -0,0 +1,151 @@
+/**
+ * @file event_journal.h
+ * @brief Offline event journal in flash for SinricPro
+ *
+ * While the connection is down, events are appended to a log in a reserved
+ * flash region (SINRICPRO_JOURNAL_SECTORS sectors ending at the end of
+ * flash) instead of waiting in RAM, so they survive a long outage or a
+ * power cut. After reconnecting they are replayed with their original
+ * timestamps.
+ *
+ * Records are CRC-framed and never span a page. They are collected in a RAM
+ * page buffer and programmed one page at a time: when the page is full, or
+ * SINRICPRO_JOURNAL_FLUSH_MS after its first record. The region is a ring of
+ * sectors written in turn, so wear is spread evenly. The sector after the
+ * one being written is always kept erased. Before the oldest sector is
+ * erased to make room, its unreplayed alerts and the records that still
+ * hold the latest value of their property are carried forward.
+ *
+ * Replay progress is stored in mark records, so after a reboot replay
+ * resumes where it stopped. An event may be sent twice, but none is skipped.
+ */
+
+#ifndef SINRICPRO_EVENT_JOURNAL_H
+#define SINRICPRO_EVENT_JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_actions.h"
+#include "sinricpro/sinricpro_device.h"
+#include "hardware/flash.h"
+
+#define SINRICPRO_JOURNAL_TIME_SINCE_BOOT   0x01    // created_at is seconds since boot
+
+/**
+ * @brief Journaled event
+ */
+typedef struct {
+    sinricpro_device_key_t key;
+    sinricpro_action_t action;
+    uint8_t flags;                      // SINRICPRO_JOURNAL_TIME_SINCE_BOOT
+    uint16_t boot;                      // Boot the event was captured in
+    uint32_t created_at;                // Unix seconds, or seconds since boot
+    const char *value;                  // JSON value text, in flash (not NUL-terminated)
+    size_t value_len;
+} sinricpro_journal_entry_t;
+
+/**
+ * @brief Event journal
+ */
+typedef struct {
+    bool enabled;                       // false if the region overlaps the program
+    uint16_t boot;                      // Incremented on every init
+    uint32_t head;                      // Region offset of the page being filled
+    uint32_t read;                      // Region offset of the next record to replay
+    uint32_t next_seq;
+    uint32_t replayed_seq;              // Records with a lower seq were replayed
+    uint16_t since_mark;                // Records replayed since the last mark
+    uint16_t page_fill;                 // Bytes in page
+    uint16_t page_events;               // Event records in page
+    uint32_t page_since_ms;             // When the first record entered page
+    uint8_t page[FLASH_PAGE_SIZE];
+
+    uint32_t appended;
+    uint32_t replayed;
+    uint32_t compacted;                 // Skipped for a newer value of the same property
+    uint32_t lost;                      // Overwritten before they were replayed
+    uint32_t corrupt;                   // Records failing the CRC check
+    uint32_t flash_errors;              // Flash operations that could not run
+} sinricpro_journal_t;
+
+/**
+ * @brief Open the journal, recovering its state from flash
+ *
+ * Erases the region if it holds no journal records.
+ *
+ * @param journal Journal
+ */
+void sinricpro_journal_init(sinricpro_journal_t *journal);
+
+/**
+ * @brief Append an event
+ *
+ * @param journal    Journal
+ * @param key        Device
+ * @param action     Event action
+ * @param created_at Capture time (unix seconds, or seconds since boot)
+ * @param flags      SINRICPRO_JOURNAL_TIME_SINCE_BOOT if created_at is not unix time
+ * @param value      JSON value text
+ * @param value_len  Value length (at most SINRICPRO_JOURNAL_VALUE_MAX)
+ * @param now_ms     Current time (ms since boot)
+ * @return false if the journal is disabled or the value is too long
+ */
+bool sinricpro_journal_append(sinricpro_journal_t *journal,
+                              const sinricpro_device_key_t *key,
+                              sinricpro_action_t action,
+                              uint32_t created_at,
+                              uint8_t flags,
+                              const char *value,
+                              size_t value_len,
+                              uint32_t now_ms);
+
+/**
+ * @brief Program the buffered page if it has waited SINRICPRO_JOURNAL_FLUSH_MS
+ *
+ * @param journal Journal
+ * @param now_ms  Current time (ms since boot)
+ */
+void sinricpro_journal_poll(sinricpro_journal_t *journal, uint32_t now_ms);
+
+/**
+ * @brief Program the buffered page now
+ *
+ * @param journal Journal
+ */
+void sinricpro_journal_flush(sinricpro_journal_t *journal);
+
+/**
+ * @brief Whether events are waiting to be replayed
+ *
+ * @param journal Journal
+ * @return true until sinricpro_journal_next() has returned every event
+ */
+bool sinricpro_journal_pending(const sinricpro_journal_t *journal);
+
+/**
+ * @brief Take the next event to replay
+ *
+ * Skips events already replayed and, with SINRICPRO_JOURNAL_COMPACT, events
+ * followed by a newer value of the same property. The entry points into
+ * flash and stays valid until the next append or flush.
+ *
+ * @param journal Journal
+ * @param entry   Output event
+ * @param now_ms  Current time (ms since boot)
+ * @return false when replay has caught up
+ */
+bool sinricpro_journal_next(sinricpro_journal_t *journal,
+                            sinricpro_journal_entry_t *entry,
+                            uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_EVENT_JOURNAL_H
@@ -16,28 +16,104 @@ void sinricpro_event_limiter_init(sinricpro_event_limiter_t *limiter,
                                   uint32_t min_distance_ms) {
     if (!limiter) return;
 
+    limiter->policy = SINRICPRO_LIMIT_DISTANCE;
     limiter->minimum_distance_ms = min_distance_ms;
     limiter->next_event_time = 0;
+    limiter->spacing = false;
     limiter->extra_distance_ms = 0;
     limiter->fail_counter = 0;
+    limiter->burst = 0;
+    limiter->tokens = 0;
+    limiter->refill_time = 0;
+    limiter->trailing = SINRICPRO_EVENT_TRAILING_EDGE;
+    limiter->deferred = false;
+}
+
+void sinricpro_event_limiter_init_bucket(sinricpro_event_limiter_t *limiter,
+                                         uint32_t interval_ms,
+                                         uint32_t burst) {
+    if (!limiter) return;
+
+    sinricpro_event_limiter_init(limiter, interval_ms);
+    limiter->policy = SINRICPRO_LIMIT_TOKEN_BUCKET;
+    limiter->burst = burst > 0 ? burst : 1;
+    limiter->tokens = limiter->burst;
 }
 
 void sinricpro_event_limiter_init_state(sinricpro_event_limiter_t *limiter) {
+#if SINRICPRO_EVENT_LIMIT_STATE_BURST > 0
+    sinricpro_event_limiter_init_bucket(limiter, SINRICPRO_EVENT_LIMIT_STATE_MS,
+                                        SINRICPRO_EVENT_LIMIT_STATE_BURST);
+#else
     sinricpro_event_limiter_init(limiter, SINRICPRO_EVENT_LIMIT_STATE_MS);
+#endif
 }
 
 void sinricpro_event_limiter_init_sensor(sinricpro_event_limiter_t *limiter) {
     sinricpro_event_limiter_init(limiter, SINRICPRO_EVENT_LIMIT_SENSOR_MS);
 }
 
+// Add the tokens earned since the last refill, capped at the burst
+static void bucket_refill(sinricpro_event_limiter_t *limiter, uint32_t now_ms) {
+    uint32_t interval = limiter->minimum_distance_ms;
+    uint32_t elapsed = now_ms - limiter->refill_time;
+
+    if (interval == 0 || elapsed >= interval * limiter->burst) {
+        limiter->tokens = limiter->burst;
+        limiter->refill_time = now_ms;
+    } else if (elapsed >= interval) {
+        uint32_t earned = elapsed / interval;
+        limiter->tokens += earned;
+        limiter->refill_time += earned * interval;
+        if (limiter->tokens >= limiter->burst) {
+            limiter->tokens = limiter->burst;
+            limiter->refill_time = now_ms;
+        }
+    }
+}
+
+static bool bucket_check(sinricpro_event_limiter_t *limiter, uint32_t now_ms) {
+    bucket_refill(limiter, now_ms);
+
+    if (limiter->tokens == 0) {
+        limiter->fail_counter++;
+        return true;   // Event BLOCKED
+    }
+
+    limiter->tokens--;
+    limiter->deferred = false;
+    return false;      // Event ALLOWED
+}
+
+// Time until next_event_time, 0 once it has passed. Compared as a distance
+// so the millisecond clock wrapping (every ~49.7 days) doesn't matter: only
+// a wait the last allowed event could have set counts as still ahead
+static uint32_t distance_remaining(const sinricpro_event_limiter_t *limiter, uint32_t now_ms) {
+    if (!limiter->spacing) return 0;
+
+    uint32_t remaining = limiter->next_event_time - now_ms;
+    if (remaining > limiter->minimum_distance_ms + limiter->extra_distance_ms) {
+        return 0;
+    }
+    return remaining;
+}
+
 bool sinricpro_event_limiter_check(sinricpro_event_limiter_t *limiter) {
+    return sinricpro_event_limiter_check_at(limiter, get_millis());
+}
+
+bool sinricpro_event_limiter_check_at(sinricpro_event_limiter_t *limiter, uint32_t now_ms) {
     if (!limiter) return true;  // Block if invalid
 
-    uint32_t current_millis = get_millis();
+    if (limiter->policy == SINRICPRO_LIMIT_TOKEN_BUCKET) {
+        return bucket_check(limiter, now_ms);
+    }
+
+    uint32_t current_millis = now_ms;
     uint32_t fail_threshold = limiter->minimum_distance_ms / 4;
 
     // Check if enough time has passed
-    if (current_millis >= limiter->next_event_time) {
+    if (distance_remaining(limiter, current_millis) == 0) {
         // Event is allowed
 
         // Check if we need to adjust backoff
@@ -54,6 +130,10 @@ bool sinricpro_event_limiter_check(sinricpro_event_limiter_t *limiter) {
         limiter->next_event_time = current_millis +
                                    limiter->minimum_distance_ms +
                                    limiter->extra_distance_ms;
+        limiter->spacing = true;
+
+        // This event is newer than any deferred value
+        limiter->deferred = false;
 
         return false;  // Event ALLOWED
     }
@@ -75,19 +155,64 @@ uint32_t sinricpro_event_limiter_time_remaining(const sinricpro_event_limiter_t
 
     uint32_t current_millis = get_millis();
 
-    if (current_millis >= limiter->next_event_time) {
-        return 0;  // Can send now
+    if (limiter->policy == SINRICPRO_LIMIT_TOKEN_BUCKET) {
+        uint32_t elapsed = current_millis - limiter->refill_time;
+        if (limiter->tokens > 0 || elapsed >= limiter->minimum_distance_ms) {
+            return 0;  // Can send now
+        }
+        return limiter->minimum_distance_ms - elapsed;
+    }
+
+    return distance_remaining(limiter, current_millis);
+}
+
+void sinricpro_event_limiter_set_trailing(sinricpro_event_limiter_t *limiter, bool enabled) {
+    if (!limiter) return;
+
+    limiter->trailing = enabled;
+    if (!enabled) {
+        limiter->deferred = false;
+    }
+}
+
+bool sinricpro_event_limiter_defer(sinricpro_event_limiter_t *limiter,
+                                   sinricpro_action_t action,
+                                   const sinricpro_event_value_t *value) {
+    if (!limiter || !value || !limiter->trailing) return false;
+
+    limiter->deferred_action = (uint8_t)action;
+    limiter->deferred_value = *value;
+    limiter->deferred_us = time_us_64();
+    limiter->deferred = true;
+    return true;
+}
+
+bool sinricpro_event_limiter_take_deferred(sinricpro_event_limiter_t *limiter,
+                                           sinricpro_action_t *action,
+                                           sinricpro_event_value_t *value,
+                                           uint64_t *captured_us) {
+    if (!limiter || !limiter->deferred || !action || !value) return false;
+
+    if (sinricpro_event_limiter_time_remaining(limiter) > 0) {
+        return false;
     }
 
-    return limiter->next_event_time - current_millis;
+    *action = (sinricpro_action_t)limiter->deferred_action;
+    *value = limiter->deferred_value;
+    if (captured_us) *captured_us = limiter->deferred_us;
+    limiter->deferred = false;
+    return true;
 }
 
 void sinricpro_event_limiter_reset(sinricpro_event_limiter_t *limiter) {
     if (!limiter) return;
 
     limiter->next_event_time = 0;
+    limiter->spacing = false;
     limiter->extra_distance_ms = 0;
     limiter->fail_counter = 0;
+    limiter->tokens = limiter->burst;
+    limiter->refill_time = get_millis();
 }
 
 uint32_t sinricpro_event_limiter_get_backoff(const sinricpro_event_limiter_t *limiter) {
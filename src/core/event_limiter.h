@@ -2,8 +2,16 @@
  * @file event_limiter.h
  * @brief Event rate limiting with adaptive backoff for SinricPro
  *
- * Prevents excessive event sending by enforcing minimum intervals
- * between events. Implements adaptive backoff when limits are violated.
+ * Prevents excessive event sending. Two policies:
+ * - Distance: a minimum interval between events, with adaptive backoff
+ *   when the limit is violated repeatedly (the default)
+ * - Token bucket: one token per interval, up to a burst; a quick double
+ *   press or on-off-on sequence goes through while the average rate stays
+ *   bounded
+ *
+ * With trailing edge enabled, a capability keeps the latest value of a
+ * blocked event in its limiter and the SDK sends it once the limiter
+ * allows, so the final state reaches the server.
  */
 
 #ifndef SINRICPRO_EVENT_LIMITER_H
@@ -16,15 +24,38 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 #include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_actions.h"
+
+/**
+ * @brief Rate limiting policy
+ */
+typedef enum {
+    SINRICPRO_LIMIT_DISTANCE = 0,   // Minimum distance with adaptive backoff
+    SINRICPRO_LIMIT_TOKEN_BUCKET    // Average rate with a burst allowance
+} sinricpro_limit_policy_t;
 
 /**
  * @brief Event limiter structure
  */
 typedef struct {
-    uint32_t minimum_distance_ms;   // Minimum time between events
+    sinricpro_limit_policy_t policy;
+    uint32_t minimum_distance_ms;   // Minimum time between events (bucket: per token)
     uint32_t next_event_time;       // Timestamp when next event is allowed
+    bool spacing;                   // next_event_time is set (an event was allowed)
     uint32_t extra_distance_ms;     // Additional delay from backoff
     uint32_t fail_counter;          // Count of rate limit violations
+
+    // Token bucket
+    uint32_t burst;                 // Bucket depth
+    uint32_t tokens;
+    uint32_t refill_time;           // Timestamp the last token was earned
+
+    // Trailing edge: latest blocked value, sent once allowed
+    bool trailing;                  // Default: SINRICPRO_EVENT_TRAILING_EDGE
+    bool deferred;                  // A value is waiting
+    uint8_t deferred_action;        // sinricpro_action_t
+    sinricpro_event_value_t deferred_value;
+    uint64_t deferred_us;           // When the waiting value was measured (time_us_64())
 } sinricpro_event_limiter_t;
 
 /**
@@ -36,9 +67,26 @@ typedef struct {
 void sinricpro_event_limiter_init(sinricpro_event_limiter_t *limiter,
                                   uint32_t min_distance_ms);
 
+/**
+ * @brief Initialize a token-bucket event limiter
+ *
+ * Starts full: burst events may be sent back to back, then one per
+ * interval_ms on average.
+ *
+ * @param limiter     Pointer to event limiter structure
+ * @param interval_ms Time to earn one token
+ * @param burst       Bucket depth (at least 1)
+ */
+void sinricpro_event_limiter_init_bucket(sinricpro_event_limiter_t *limiter,
+                                         uint32_t interval_ms,
+                                         uint32_t burst);
+
 /**
  * @brief Create a state event limiter (1 second default)
  *
+ * A token bucket of depth SINRICPRO_EVENT_LIMIT_STATE_BURST when that is
+ * non-zero, otherwise the distance policy.
+ *
  * @param limiter Pointer to event limiter structure
  */
 void sinricpro_event_limiter_init_state(sinricpro_event_limiter_t *limiter);
@@ -64,6 +112,18 @@ void sinricpro_event_limiter_init_sensor(sinricpro_event_limiter_t *limiter);
  */
 bool sinricpro_event_limiter_check(sinricpro_event_limiter_t *limiter);
 
+/**
+ * @brief Check if an event is allowed at a given time
+ *
+ * sinricpro_event_limiter_check() with an explicit clock, for replaying
+ * recorded timings.
+ *
+ * @param limiter Pointer to event limiter structure
+ * @param now_ms  Current time in milliseconds
+ * @return true if event should be BLOCKED, false if allowed
+ */
+bool sinricpro_event_limiter_check_at(sinricpro_event_limiter_t *limiter, uint32_t now_ms);
+
 /**
  * @brief Get time until next event is allowed
  *
@@ -72,10 +132,50 @@ bool sinricpro_event_limiter_check(sinricpro_event_limiter_t *limiter);
  */
 uint32_t sinricpro_event_limiter_time_remaining(const sinricpro_event_limiter_t *limiter);
 
+/**
+ * @brief Enable or disable trailing-edge sending
+ *
+ * Disabling drops a value that is waiting.
+ *
+ * @param limiter Pointer to event limiter structure
+ * @param enabled Keep the latest blocked value and send it later
+ */
+void sinricpro_event_limiter_set_trailing(sinricpro_event_limiter_t *limiter, bool enabled);
+
+/**
+ * @brief Keep the value of a blocked event
+ *
+ * Replaces any value already waiting. Cleared when the next event is
+ * allowed, since that one is newer.
+ *
+ * @param limiter Pointer to event limiter structure
+ * @param action  Event action
+ * @param value   Event value
+ * @return true if kept, false if trailing edge is disabled
+ */
+bool sinricpro_event_limiter_defer(sinricpro_event_limiter_t *limiter,
+                                   sinricpro_action_t action,
+                                   const sinricpro_event_value_t *value);
+
+/**
+ * @brief Take the waiting value once the limiter allows it
+ *
+ * @param limiter     Pointer to event limiter structure
+ * @param action      Output event action
+ * @param value       Output event value
+ * @param captured_us Output: when the value was deferred (optional)
+ * @return true if a value was waiting and may be sent now
+ */
+bool sinricpro_event_limiter_take_deferred(sinricpro_event_limiter_t *limiter,
+                                           sinricpro_action_t *action,
+                                           sinricpro_event_value_t *value,
+                                           uint64_t *captured_us);
+
 /**
  * @brief Reset the event limiter
  *
- * Clears backoff and failure counters, allowing immediate events.
+ * Clears backoff and failure counters (refills the bucket), allowing
+ * immediate events.
  *
  * @param limiter Pointer to event limiter structure
  */
@@ -0,0 +1,83 @@
+/**
+ * @file event_ring.c
+ * @brief Multi-producer event descriptor ring implementation
+ *
+ * The RP2040's Cortex-M0+ has no exclusive load/store, so a CAS loop is not
+ * available; slot reservation uses a hardware spinlock instead. The critical
+ * section is only the index bump, so an IRQ on either core is never blocked
+ * for longer than that.
+ */
+
+#include "event_ring.h"
+#include <string.h>
+
+_Static_assert((SINRICPRO_EVENT_RING_SIZE & (SINRICPRO_EVENT_RING_SIZE - 1)) == 0,
+               "SINRICPRO_EVENT_RING_SIZE must be a power of two");
+
+#define RING_INDEX(n) ((n) & (SINRICPRO_EVENT_RING_SIZE - 1))
+
+void sinricpro_event_ring_init(sinricpro_event_ring_t *ring) {
+    if (!ring) return;
+
+    spin_lock_t *lock = ring->lock;
+    memset(ring, 0, sizeof(sinricpro_event_ring_t));
+
+    // Keep the spinlock across re-initialization
+    if (!lock) {
+        lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+    ring->lock = lock;
+    __dmb();
+}
+
+bool sinricpro_event_ring_post(sinricpro_event_ring_t *ring,
+                               const sinricpro_event_desc_t *desc) {
+    if (!ring || !ring->lock || !desc) return false;
+
+    // Reserve a position
+    uint32_t save = spin_lock_blocking(ring->lock);
+    uint32_t pos = ring->head;
+    bool full = (uint32_t)(pos - ring->tail) >= SINRICPRO_EVENT_RING_SIZE;
+    if (full) {
+        ring->dropped++;
+    } else {
+        ring->head = pos + 1;
+        ring->posted++;
+    }
+    spin_unlock(ring->lock, save);
+
+    if (full) return false;
+
+    // Fill and publish outside the lock
+    sinricpro_event_slot_t *slot = &ring->slots[RING_INDEX(pos)];
+    slot->desc = *desc;
+    __dmb();
+    slot->seq = pos + 1;
+
+    return true;
+}
+
+bool sinricpro_event_ring_take(sinricpro_event_ring_t *ring,
+                               sinricpro_event_desc_t *desc) {
+    if (!ring || !desc) return false;
+
+    uint32_t pos = ring->tail;
+    sinricpro_event_slot_t *slot = &ring->slots[RING_INDEX(pos)];
+
+    // Reserved but not yet published (or empty): stop here to keep order
+    if (slot->seq != pos + 1) {
+        return false;
+    }
+
+    __dmb();
+    *desc = slot->desc;
+    __dmb();
+    ring->tail = pos + 1;
+
+    return true;
+}
+
+size_t sinricpro_event_ring_count(const sinricpro_event_ring_t *ring) {
+    if (!ring) return 0;
+    return (uint32_t)(ring->head - ring->tail);
+}
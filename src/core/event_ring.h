@@ -0,0 +1,98 @@
+/**
+ * @file event_ring.h
+ * @brief Multi-producer event descriptor ring for SinricPro
+ *
+ * Holds compact binary event descriptors posted from any context (IRQ
+ * handlers, either core) until sinricpro_handle() expands them into JSON.
+ * Producers only reserve a slot index under a hardware spinlock (a handful
+ * of instructions with interrupts masked); the descriptor itself is written
+ * outside the lock and published with a per-slot sequence number. The single
+ * consumer never locks.
+ */
+
+#ifndef SINRICPRO_EVENT_RING_H
+#define SINRICPRO_EVENT_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_actions.h"
+#include "hardware/sync.h"
+
+/**
+ * @brief Posted event descriptor
+ */
+typedef struct {
+    const struct sinricpro_device *device;  // Matched by address: never read after removal
+    uint8_t device_index;               // Registry position when posted (lookup hint)
+    uint8_t action;                     // sinricpro_action_t
+    uint64_t captured_us;               // time_us_64() when the event happened
+    sinricpro_event_value_t value;
+} sinricpro_event_desc_t;
+
+/**
+ * @brief Ring slot
+ */
+typedef struct {
+    volatile uint32_t seq;              // position + 1 once published
+    sinricpro_event_desc_t desc;
+} sinricpro_event_slot_t;
+
+/**
+ * @brief Event ring
+ */
+typedef struct {
+    sinricpro_event_slot_t slots[SINRICPRO_EVENT_RING_SIZE];
+    volatile uint32_t head;             // Next position to reserve
+    volatile uint32_t tail;             // Next position to consume
+    volatile uint32_t posted;
+    volatile uint32_t dropped;
+    spin_lock_t *lock;                  // Guards head reservation only
+} sinricpro_event_ring_t;
+
+/**
+ * @brief Initialize the ring (claims a hardware spinlock)
+ *
+ * @param ring Ring to initialize
+ */
+void sinricpro_event_ring_init(sinricpro_event_ring_t *ring);
+
+/**
+ * @brief Post a descriptor (any context, any core)
+ *
+ * @param ring Ring
+ * @param desc Descriptor to copy
+ * @return true if queued, false if the ring is full
+ */
+bool sinricpro_event_ring_post(sinricpro_event_ring_t *ring,
+                               const sinricpro_event_desc_t *desc);
+
+/**
+ * @brief Take the oldest published descriptor (consumer only)
+ *
+ * @param ring Ring
+ * @param desc Output descriptor
+ * @return true if a descriptor was taken
+ */
+bool sinricpro_event_ring_take(sinricpro_event_ring_t *ring,
+                               sinricpro_event_desc_t *desc);
+
+/**
+ * @brief Descriptors not yet taken (consumer only)
+ *
+ * Includes positions reserved by a post that is still being written.
+ *
+ * @param ring Ring
+ * @return Number of descriptors waiting
+ */
+size_t sinricpro_event_ring_count(const sinricpro_event_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_EVENT_RING_H
@@ -0,0 +1,227 @@
+/**
+ * @file event_scheduler.c
+ * @brief Connection-wide event budget implementation
+ */
+
+#include "event_scheduler.h"
+#include <string.h>
+
+_Static_assert(SINRICPRO_EVENT_SCHED_SLOTS > 0, "SINRICPRO_EVENT_SCHED_SLOTS must be positive");
+
+sinricpro_event_class_t sinricpro_event_class_of(sinricpro_action_t action) {
+    switch (action) {
+        case SINRICPRO_ACTION_DOORBELL_PRESS:
+        case SINRICPRO_ACTION_MOTION:
+            return SINRICPRO_EVENT_CLASS_ALERT;
+        case SINRICPRO_ACTION_CURRENT_TEMPERATURE:
+        case SINRICPRO_ACTION_AIR_QUALITY:
+        case SINRICPRO_ACTION_POWER_USAGE:
+            return SINRICPRO_EVENT_CLASS_TELEMETRY;
+        default:
+            return SINRICPRO_EVENT_CLASS_STATE;
+    }
+}
+
+bool sinricpro_event_coalesces(sinricpro_action_t action) {
+    return sinricpro_event_class_of(action) != SINRICPRO_EVENT_CLASS_ALERT;
+}
+
+void sinricpro_sched_init(sinricpro_event_sched_t *sched) {
+    if (!sched) return;
+
+    memset(sched, 0, sizeof(sinricpro_event_sched_t));
+    sinricpro_event_limiter_init_bucket(&sched->budget, SINRICPRO_EVENT_BUDGET_INTERVAL_MS,
+                                        SINRICPRO_EVENT_BUDGET_BURST);
+}
+
+// Drop policy: classes whose waiting events a new event of each class may
+// displace when the table is full
+static const uint8_t displaces[SINRICPRO_EVENT_CLASS_COUNT] = {
+    [SINRICPRO_EVENT_CLASS_ALERT] = (1u << SINRICPRO_EVENT_CLASS_STATE) |
+                                    (1u << SINRICPRO_EVENT_CLASS_TELEMETRY),
+    [SINRICPRO_EVENT_CLASS_STATE] = 1u << SINRICPRO_EVENT_CLASS_TELEMETRY,
+    [SINRICPRO_EVENT_CLASS_TELEMETRY] = 1u << SINRICPRO_EVENT_CLASS_TELEMETRY,
+};
+
+// Oldest waiting event of a class, or NULL
+static sinricpro_sched_entry_t *oldest_of(sinricpro_event_sched_t *sched, uint8_t event_class) {
+    sinricpro_sched_entry_t *oldest = NULL;
+
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        sinricpro_sched_entry_t *entry = &sched->entries[i];
+        if (entry->event && entry->event_class == event_class &&
+            (!oldest || (int32_t)(entry->seq - oldest->seq) < 0)) {
+            oldest = entry;
+        }
+    }
+    return oldest;
+}
+
+// Waiting event the new one replaces, or NULL
+static sinricpro_sched_entry_t *coalesce_target(sinricpro_event_sched_t *sched,
+                                                uint8_t device, sinricpro_action_t action) {
+#if SINRICPRO_EVENT_COALESCE
+    if (device == SINRICPRO_SCHED_NO_DEVICE || !sinricpro_event_coalesces(action)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        sinricpro_sched_entry_t *entry = &sched->entries[i];
+        if (entry->event && entry->device == device && entry->action == (uint8_t)action) {
+            return entry;
+        }
+    }
+#endif
+    return NULL;
+}
+
+static void shed(sinricpro_event_sched_t *sched, sinricpro_sched_entry_t *entry) {
+    sched->classes[entry->event_class].shed++;
+    cJSON_Delete(entry->event);
+    entry->event = NULL;
+}
+
+bool sinricpro_sched_add(sinricpro_event_sched_t *sched,
+                         cJSON *event,
+                         uint8_t device,
+                         sinricpro_action_t action,
+                         uint64_t captured_us,
+                         uint32_t now_ms) {
+    if (!sched || !event) {
+        cJSON_Delete(event);
+        return false;
+    }
+
+    sinricpro_event_class_t event_class = sinricpro_event_class_of(action);
+
+    // Latest value wins; the entry keeps its turn and queue time
+    sinricpro_sched_entry_t *waiting = coalesce_target(sched, device, action);
+    if (waiting) {
+        sched->classes[event_class].coalesced++;
+        cJSON_Delete(waiting->event);
+        waiting->event = event;
+        waiting->captured_us = captured_us;
+        return true;
+    }
+
+    sinricpro_sched_entry_t *slot = NULL;
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        if (!sched->entries[i].event) {
+            slot = &sched->entries[i];
+            break;
+        }
+    }
+
+    // Full: displace the oldest event of the lowest class the policy allows
+    for (int c = SINRICPRO_EVENT_CLASS_COUNT - 1; !slot && c >= 0; c--) {
+        if (displaces[event_class] & (1u << c)) {
+            slot = oldest_of(sched, (uint8_t)c);
+            if (slot) {
+                shed(sched, slot);
+            }
+        }
+    }
+
+    if (!slot) {
+        sched->classes[event_class].shed++;
+        cJSON_Delete(event);
+        return false;
+    }
+
+    slot->event = event;
+    slot->seq = sched->seq++;
+    slot->queued_ms = now_ms;
+    slot->captured_us = captured_us;
+    slot->device = device;
+    slot->action = (uint8_t)action;
+    slot->event_class = (uint8_t)event_class;
+    return true;
+}
+
+// Next device's oldest event: smallest registry distance from the class's
+// round-robin position, then arrival order
+static sinricpro_sched_entry_t *pick(sinricpro_event_sched_t *sched, uint8_t event_class) {
+    sinricpro_sched_entry_t *best = NULL;
+    uint8_t best_distance = 0;
+    uint8_t next = sched->next_device[event_class];
+
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        sinricpro_sched_entry_t *entry = &sched->entries[i];
+        if (!entry->event || entry->event_class != event_class) continue;
+
+        uint8_t distance = (uint8_t)(entry->device - next);
+        if (!best || distance < best_distance ||
+            (distance == best_distance && (int32_t)(entry->seq - best->seq) < 0)) {
+            best = entry;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+cJSON *sinricpro_sched_next(sinricpro_event_sched_t *sched, uint32_t now_ms, uint64_t *captured_us) {
+    if (!sched) return NULL;
+
+    sinricpro_sched_entry_t *entry = NULL;
+    for (uint8_t c = 0; c < SINRICPRO_EVENT_CLASS_COUNT && !entry; c++) {
+        entry = pick(sched, c);
+    }
+    if (!entry) return NULL;
+
+    if (sinricpro_event_limiter_check_at(&sched->budget, now_ms)) {
+        return NULL;    // Budget used up; the event keeps its place
+    }
+
+    sinricpro_sched_class_stats_t *stats = &sched->classes[entry->event_class];
+    uint32_t delay = now_ms - entry->queued_ms;
+    stats->released++;
+    stats->delay_total_ms += delay;
+    if (delay > stats->delay_max_ms) {
+        stats->delay_max_ms = delay;
+    }
+
+    sched->next_device[entry->event_class] = (uint8_t)(entry->device + 1);
+
+    if (captured_us) *captured_us = entry->captured_us;
+
+    cJSON *event = entry->event;
+    entry->event = NULL;
+    return event;
+}
+
+size_t sinricpro_sched_count(const sinricpro_event_sched_t *sched) {
+    if (!sched) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        if (sched->entries[i].event) count++;
+    }
+    return count;
+}
+
+void sinricpro_sched_remove_device(sinricpro_event_sched_t *sched,
+                                   uint8_t position,
+                                   uint8_t moved_from) {
+    if (!sched) return;
+
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        sinricpro_sched_entry_t *entry = &sched->entries[i];
+        if (!entry->event) continue;
+
+        if (entry->device == position) {
+            cJSON_Delete(entry->event);
+            entry->event = NULL;
+        } else if (entry->device == moved_from) {
+            entry->device = position;
+        }
+    }
+}
+
+void sinricpro_sched_clear(sinricpro_event_sched_t *sched) {
+    if (!sched) return;
+
+    for (size_t i = 0; i < SINRICPRO_EVENT_SCHED_SLOTS; i++) {
+        cJSON_Delete(sched->entries[i].event);
+        sched->entries[i].event = NULL;
+    }
+}
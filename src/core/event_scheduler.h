@@ -0,0 +1,169 @@
+/**
+ * @file event_scheduler.h
+ * @brief Connection-wide event budget for SinricPro
+ *
+ * Capability limiters bound each device on its own; with many devices on
+ * one connection the sum can still exceed what the server tolerates and
+ * get the whole account throttled. Events from every device therefore wait
+ * here and are released against one token bucket
+ * (SINRICPRO_EVENT_BUDGET_INTERVAL_MS, SINRICPRO_EVENT_BUDGET_BURST).
+ *
+ * Classes are released in priority order: alerts, state changes, then
+ * sensor telemetry. Within a class, devices take turns (round robin by
+ * registry position), each device's events in order. When the table is
+ * full, each class has its own drop policy: an alert displaces the oldest
+ * telemetry or else the oldest state event, a state change displaces the
+ * oldest telemetry, and a telemetry reading replaces the oldest reading.
+ * An event with nothing it may displace is shed.
+ *
+ * While events wait (offline, or the budget is used up), a newer value for
+ * the same device and action replaces the waiting one in place, keeping its
+ * turn: capacity then scales with the number of properties rather than the
+ * event rate, and only the latest value is sent after a reconnect.
+ */
+
+#ifndef SINRICPRO_EVENT_SCHEDULER_H
+#define SINRICPRO_EVENT_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro.h"
+#include "event_limiter.h"
+#include "cJSON.h"
+
+#define SINRICPRO_SCHED_NO_DEVICE 0xFF   // Event for a device not in the registry
+#define SINRICPRO_SCHED_STAMPED   UINT64_MAX    // Capture time: createdAt is already final
+
+/**
+ * @brief Event waiting for budget
+ */
+typedef struct {
+    cJSON *event;                       // NULL = free
+    uint32_t seq;                       // Arrival order
+    uint32_t queued_ms;
+    uint64_t captured_us;               // When the value was measured (time_us_64())
+    uint8_t device;                     // Registry position (fairness key)
+    uint8_t action;                     // sinricpro_action_t (coalescing key)
+    uint8_t event_class;                // sinricpro_event_class_t
+} sinricpro_sched_entry_t;
+
+/**
+ * @brief Per-class counters
+ */
+typedef struct {
+    uint32_t released;
+    uint32_t shed;
+    uint32_t coalesced;                 // Replaced by a newer value before release
+    uint32_t delay_max_ms;
+    uint64_t delay_total_ms;
+} sinricpro_sched_class_stats_t;
+
+/**
+ * @brief Event scheduler
+ */
+typedef struct {
+    sinricpro_sched_entry_t entries[SINRICPRO_EVENT_SCHED_SLOTS];
+    sinricpro_event_limiter_t budget;
+    uint32_t seq;
+    uint8_t next_device[SINRICPRO_EVENT_CLASS_COUNT];   // Round-robin position per class
+    sinricpro_sched_class_stats_t classes[SINRICPRO_EVENT_CLASS_COUNT];
+} sinricpro_event_sched_t;
+
+/**
+ * @brief Class of an event action
+ *
+ * @param action Event action
+ * @return SINRICPRO_EVENT_CLASS_ALERT for doorbell presses and motion,
+ *         SINRICPRO_EVENT_CLASS_TELEMETRY for periodic sensor readings,
+ *         SINRICPRO_EVENT_CLASS_STATE otherwise
+ */
+sinricpro_event_class_t sinricpro_event_class_of(sinricpro_action_t action);
+
+/**
+ * @brief Whether a newer event replaces a waiting one for the same action
+ *
+ * @param action Event action
+ * @return false for alerts (a doorbell press, detected motion), which must
+ *         each be sent
+ */
+bool sinricpro_event_coalesces(sinricpro_action_t action);
+
+/**
+ * @brief Initialize (empty, full budget) the scheduler
+ *
+ * @param sched Scheduler
+ */
+void sinricpro_sched_init(sinricpro_event_sched_t *sched);
+
+/**
+ * @brief Queue an event for release
+ *
+ * Replaces a waiting event for the same device and action when the action
+ * coalesces (SINRICPRO_EVENT_COALESCE).
+ *
+ * @param sched       Scheduler
+ * @param event       Event message (owned by the scheduler, deleted if shed)
+ * @param device      Registry position, or SINRICPRO_SCHED_NO_DEVICE
+ * @param action      Event action
+ * @param captured_us When the value was measured, or SINRICPRO_SCHED_STAMPED
+ * @param now_ms      Current time (ms since boot)
+ * @return false if the event was shed
+ */
+bool sinricpro_sched_add(sinricpro_event_sched_t *sched,
+                         cJSON *event,
+                         uint8_t device,
+                         sinricpro_action_t action,
+                         uint64_t captured_us,
+                         uint32_t now_ms);
+
+/**
+ * @brief Take the next event if the budget allows
+ *
+ * @param sched       Scheduler
+ * @param now_ms      Current time (ms since boot)
+ * @param captured_us Output: capture time given to sinricpro_sched_add()
+ * @return Event to send (caller deletes it), or NULL if none is waiting or
+ *         the budget is used up
+ */
+cJSON *sinricpro_sched_next(sinricpro_event_sched_t *sched, uint32_t now_ms, uint64_t *captured_us);
+
+/**
+ * @brief Number of events waiting
+ *
+ * @param sched Scheduler
+ * @return Waiting events
+ */
+size_t sinricpro_sched_count(const sinricpro_event_sched_t *sched);
+
+/**
+ * @brief Follow a device removal
+ *
+ * Drops the removed device's events and moves the device that took its
+ * registry position onto that position's fairness key.
+ *
+ * @param sched      Scheduler
+ * @param position   Registry position of the removed device
+ * @param moved_from Former position of the device moved into it
+ *                   (== position when none was moved)
+ */
+void sinricpro_sched_remove_device(sinricpro_event_sched_t *sched,
+                                   uint8_t position,
+                                   uint8_t moved_from);
+
+/**
+ * @brief Drop all waiting events
+ *
+ * @param sched Scheduler
+ */
+void sinricpro_sched_clear(sinricpro_event_sched_t *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_EVENT_SCHEDULER_H
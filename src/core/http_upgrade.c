@@ -0,0 +1,176 @@
+/**
+ * @file http_upgrade.c
+ * @brief Incremental HTTP upgrade response parser implementation
+ */
+
+#include "http_upgrade.h"
+#include "sinricpro_debug.h"
+#include <string.h>
+#include <ctype.h>
+
+// ============================================================================
+// Internal Functions
+// ============================================================================
+
+static bool str_ieq(const char *a, const char *b, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Case-insensitive search for a token inside a header value
+static bool value_contains(const char *value, const char *token) {
+    size_t value_len = strlen(value);
+    size_t token_len = strlen(token);
+    for (size_t i = 0; i + token_len <= value_len; i++) {
+        if (str_ieq(value + i, token, token_len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// "HTTP/1.x SSS reason"
+static bool parse_status_line(sinricpro_http_upgrade_t *parser) {
+    const char *line = parser->line;
+
+    if (parser->line_len < 12 || strncmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ') {
+        return false;
+    }
+
+    int code = 0;
+    for (int i = 9; i < 12; i++) {
+        if (!isdigit((unsigned char)line[i])) {
+            return false;
+        }
+        code = code * 10 + (line[i] - '0');
+    }
+
+    if (parser->line_len > 12 && line[12] != ' ') {
+        return false;
+    }
+
+    parser->status_code = code;
+    return true;
+}
+
+static void copy_value(char *dst, size_t dst_size, const char *value) {
+    size_t len = strlen(value);
+    if (len >= dst_size) {
+        len = dst_size - 1;
+    }
+    memcpy(dst, value, len);
+    dst[len] = '\0';
+}
+
+static void parse_header_line(sinricpro_http_upgrade_t *parser) {
+    char *colon = memchr(parser->line, ':', parser->line_len);
+    if (!colon) {
+        return;  // Not a header; ignore
+    }
+
+    size_t name_len = colon - parser->line;
+    char *value = colon + 1;
+
+    // Trim optional whitespace around the value
+    while (*value == ' ' || *value == '\t') value++;
+    char *end = parser->line + parser->line_len;
+    while (end > value && (end[-1] == ' ' || end[-1] == '\t')) end--;
+    *end = '\0';
+
+#define HEADER_IS(name) (name_len == sizeof(name) - 1 && str_ieq(parser->line, name, name_len))
+
+    if (HEADER_IS("Sec-WebSocket-Accept")) {
+        copy_value(parser->accept, sizeof(parser->accept), value);
+    } else if (HEADER_IS("Sec-WebSocket-Extensions")) {
+        // Repeated headers are combined as a comma-separated list
+        size_t used = strlen(parser->extensions);
+        if (used > 0 && used + 2 < sizeof(parser->extensions)) {
+            memcpy(parser->extensions + used, ", ", 3);
+            used += 2;
+        }
+        copy_value(parser->extensions + used, sizeof(parser->extensions) - used, value);
+    } else if (HEADER_IS("Upgrade")) {
+        parser->upgrade_websocket = value_contains(value, "websocket");
+    } else if (HEADER_IS("Connection")) {
+        parser->connection_upgrade = value_contains(value, "upgrade");
+    }
+
+#undef HEADER_IS
+}
+
+// Handle one complete line (CR/LF already stripped)
+static sinricpro_http_upgrade_result_t process_line(sinricpro_http_upgrade_t *parser) {
+    parser->line[parser->line_len] = '\0';
+
+    if (parser->state == HTTP_UPGRADE_STATUS_LINE) {
+        if (!parse_status_line(parser)) {
+            SINRICPRO_ERROR_PRINTF("[WS] Malformed status line: %s\n", parser->line);
+            parser->state = HTTP_UPGRADE_FAILED;
+            return HTTP_UPGRADE_ERROR;
+        }
+        if (parser->status_code != 101) {
+            SINRICPRO_ERROR_PRINTF("[WS] Server rejected upgrade: %s\n", parser->line);
+            parser->state = HTTP_UPGRADE_FAILED;
+            return HTTP_UPGRADE_ERROR;
+        }
+        parser->state = HTTP_UPGRADE_HEADERS;
+        return HTTP_UPGRADE_MORE;
+    }
+
+    if (parser->line_len == 0) {
+        parser->state = HTTP_UPGRADE_DONE;
+        return HTTP_UPGRADE_COMPLETE;
+    }
+
+    parse_header_line(parser);
+    return HTTP_UPGRADE_MORE;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void sinricpro_http_upgrade_init(sinricpro_http_upgrade_t *parser) {
+    if (!parser) return;
+
+    memset(parser, 0, sizeof(sinricpro_http_upgrade_t));
+    parser->state = HTTP_UPGRADE_STATUS_LINE;
+}
+
+sinricpro_http_upgrade_result_t sinricpro_http_upgrade_feed(sinricpro_http_upgrade_t *parser,
+                                                            const uint8_t *data,
+                                                            size_t len,
+                                                            size_t *consumed) {
+    size_t used = 0;
+    sinricpro_http_upgrade_result_t result = HTTP_UPGRADE_MORE;
+
+    if (!parser || !data) {
+        if (consumed) *consumed = 0;
+        return HTTP_UPGRADE_ERROR;
+    }
+
+    if (parser->state == HTTP_UPGRADE_DONE) {
+        result = HTTP_UPGRADE_COMPLETE;
+    } else if (parser->state == HTTP_UPGRADE_FAILED) {
+        result = HTTP_UPGRADE_ERROR;
+    }
+
+    while (used < len && result == HTTP_UPGRADE_MORE) {
+        char c = (char)data[used++];
+
+        if (c == '\n') {
+            result = process_line(parser);
+            parser->line_len = 0;
+        } else if (c != '\r' && parser->line_len < SINRICPRO_HTTP_LINE_MAX - 1) {
+            parser->line[parser->line_len++] = c;
+        }
+        // Bytes beyond the line limit are dropped; the values we need are short
+    }
+
+    if (consumed) *consumed = used;
+    return result;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file http_upgrade.h
+ * @brief Incremental HTTP upgrade response parser for SinricPro
+ *
+ * Parses the server's reply to the WebSocket upgrade request one byte at a
+ * time, so the status line and headers may be split across any number of
+ * TCP segments. Bytes following the blank line are left unconsumed for the
+ * frame decoder.
+ */
+
+#ifndef SINRICPRO_HTTP_UPGRADE_H
+#define SINRICPRO_HTTP_UPGRADE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SINRICPRO_HTTP_LINE_MAX         128     // Longer lines are truncated
+#define SINRICPRO_HTTP_ACCEPT_MAX       32      // Base64 SHA-1 is 28 chars
+#define SINRICPRO_HTTP_EXTENSIONS_MAX   64
+
+/**
+ * @brief Parser state
+ */
+typedef enum {
+    HTTP_UPGRADE_STATUS_LINE = 0,       // Reading "HTTP/1.1 101 ..."
+    HTTP_UPGRADE_HEADERS,               // Reading header lines
+    HTTP_UPGRADE_DONE,                  // Blank line seen
+    HTTP_UPGRADE_FAILED                 // Malformed or non-101 response
+} sinricpro_http_upgrade_state_t;
+
+/**
+ * @brief Result of feeding data to the parser
+ */
+typedef enum {
+    HTTP_UPGRADE_MORE = 0,              // Need more data
+    HTTP_UPGRADE_COMPLETE,              // Headers finished
+    HTTP_UPGRADE_ERROR                  // Response rejected
+} sinricpro_http_upgrade_result_t;
+
+/**
+ * @brief Parser context
+ */
+typedef struct {
+    sinricpro_http_upgrade_state_t state;
+
+    // Current line
+    char line[SINRICPRO_HTTP_LINE_MAX];
+    size_t line_len;
+
+    // Extracted fields
+    int status_code;
+    bool upgrade_websocket;             // "Upgrade: websocket"
+    bool connection_upgrade;            // "Connection: Upgrade"
+    char accept[SINRICPRO_HTTP_ACCEPT_MAX];
+    char extensions[SINRICPRO_HTTP_EXTENSIONS_MAX];
+} sinricpro_http_upgrade_t;
+
+/**
+ * @brief Reset parser for a new response
+ *
+ * @param parser Parser context
+ */
+void sinricpro_http_upgrade_init(sinricpro_http_upgrade_t *parser);
+
+/**
+ * @brief Feed received bytes to the parser
+ *
+ * Stops at the end of the header block; the bytes after it belong to the
+ * WebSocket stream and are reported through consumed.
+ *
+ * @param parser   Parser context
+ * @param data     Received bytes
+ * @param len      Number of bytes
+ * @param consumed Output: bytes used by the parser (may be less than len)
+ * @return MORE, COMPLETE or ERROR
+ */
+sinricpro_http_upgrade_result_t sinricpro_http_upgrade_feed(sinricpro_http_upgrade_t *parser,
+                                                            const uint8_t *data,
+                                                            size_t len,
+                                                            size_t *consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_HTTP_UPGRADE_H
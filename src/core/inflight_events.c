@@ -0,0 +1,206 @@
+/**
+ * @file inflight_events.c
+ * @brief In-flight event table implementation
+ */
+
+#include "inflight_events.h"
+#include "json_helpers.h"
+#include <string.h>
+
+_Static_assert(SINRICPRO_MAX_INFLIGHT_EVENTS > 0, "At least one in-flight event slot is needed");
+_Static_assert(SINRICPRO_EVENT_MAX_ATTEMPTS > 0 && SINRICPRO_EVENT_MAX_ATTEMPTS < 256,
+               "Event send attempts are 8-bit");
+
+static inline bool is_due(const sinricpro_inflight_entry_t *entry, uint32_t now_ms) {
+    return entry->event &&
+           (entry->resend ||
+            (entry->attempts < SINRICPRO_EVENT_MAX_ATTEMPTS &&
+             (now_ms - entry->sent_ms) >= SINRICPRO_EVENT_ACK_TIMEOUT_MS));
+}
+
+static inline bool is_expired(const sinricpro_inflight_entry_t *entry, uint32_t now_ms) {
+    return entry->event && !entry->resend &&
+           entry->attempts >= SINRICPRO_EVENT_MAX_ATTEMPTS &&
+           (now_ms - entry->sent_ms) >= SINRICPRO_EVENT_ACK_TIMEOUT_MS;
+}
+
+static cJSON *release(sinricpro_inflight_entry_t *entry) {
+    cJSON *event = entry->event;
+    entry->event = NULL;
+    entry->token_len = 0;
+    return event;
+}
+
+void sinricpro_inflight_init(sinricpro_inflight_table_t *table) {
+    if (!table) return;
+    memset(table, 0, sizeof(sinricpro_inflight_table_t));
+}
+
+bool sinricpro_inflight_full(const sinricpro_inflight_table_t *table) {
+    if (!table) return true;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        if (!table->entries[i].event) return false;
+    }
+    return true;
+}
+
+bool sinricpro_inflight_add(sinricpro_inflight_table_t *table, cJSON *event, uint32_t now_ms) {
+    if (!table || !event) return false;
+
+    const char *token = sinricpro_json_get_reply_token(event);
+    size_t token_len = token ? strlen(token) : 0;
+    if (token_len == 0 || token_len > SINRICPRO_REPLY_TOKEN_MAX_LEN) return false;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (entry->event) continue;
+
+        memcpy(entry->reply_token, token, token_len);
+        entry->reply_token[token_len] = '\0';
+        entry->token_len = (uint8_t)token_len;
+        entry->event = event;
+        entry->first_sent_ms = now_ms;
+        entry->sent_ms = now_ms;
+        entry->attempts = 1;
+        entry->resend = false;
+        return true;
+    }
+    return false;
+}
+
+bool sinricpro_inflight_has_token(const sinricpro_inflight_table_t *table,
+                                  const char *token,
+                                  size_t token_len) {
+    if (!table || !token || token_len == 0) return false;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        const sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (entry->event && entry->token_len == token_len &&
+            memcmp(entry->reply_token, token, token_len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cJSON *sinricpro_inflight_take(sinricpro_inflight_table_t *table,
+                               const char *token,
+                               size_t token_len,
+                               uint32_t now_ms,
+                               uint32_t *latency_ms) {
+    if (!table || !token || token_len == 0) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (!entry->event || entry->token_len != token_len ||
+            memcmp(entry->reply_token, token, token_len) != 0) {
+            continue;
+        }
+
+        uint32_t latency = now_ms - entry->first_sent_ms;
+        table->answered++;
+        table->latency_total_ms += latency;
+        if (latency > table->latency_max_ms) {
+            table->latency_max_ms = latency;
+        }
+        if (latency_ms) *latency_ms = latency;
+        return release(entry);
+    }
+    return NULL;
+}
+
+cJSON *sinricpro_inflight_take_superseded(sinricpro_inflight_table_t *table,
+                                          const char *device_id,
+                                          const char *action) {
+    if (!table || !device_id || !action) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (!entry->event) continue;
+
+        const char *entry_device = sinricpro_json_get_device_id(entry->event);
+        const char *entry_action = sinricpro_json_get_action(entry->event);
+        if (entry_device && entry_action &&
+            strcmp(entry_device, device_id) == 0 && strcmp(entry_action, action) == 0) {
+            table->superseded++;
+            return release(entry);
+        }
+    }
+    return NULL;
+}
+
+cJSON *sinricpro_inflight_take_expired(sinricpro_inflight_table_t *table, uint32_t now_ms) {
+    if (!table) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (is_expired(entry, now_ms)) {
+            table->expired++;
+            return release(entry);
+        }
+    }
+    return NULL;
+}
+
+size_t sinricpro_inflight_expired_count(const sinricpro_inflight_table_t *table, uint32_t now_ms) {
+    if (!table) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        if (is_expired(&table->entries[i], now_ms)) count++;
+    }
+    return count;
+}
+
+void sinricpro_inflight_mark_resend(sinricpro_inflight_table_t *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        if (table->entries[i].event) {
+            table->entries[i].resend = true;
+        }
+    }
+}
+
+size_t sinricpro_inflight_resend_count(const sinricpro_inflight_table_t *table, uint32_t now_ms) {
+    if (!table) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        if (is_due(&table->entries[i], now_ms)) count++;
+    }
+    return count;
+}
+
+cJSON *sinricpro_inflight_next_resend(sinricpro_inflight_table_t *table, uint32_t now_ms) {
+    if (!table) return NULL;
+
+    // Oldest first, so a property's values reach the server in order
+    sinricpro_inflight_entry_t *oldest = NULL;
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        sinricpro_inflight_entry_t *entry = &table->entries[i];
+        if (!is_due(entry, now_ms)) continue;
+
+        if (!oldest || (now_ms - entry->first_sent_ms) > (now_ms - oldest->first_sent_ms)) {
+            oldest = entry;
+        }
+    }
+    if (!oldest) return NULL;
+
+    oldest->resend = false;
+    oldest->sent_ms = now_ms;
+    if (oldest->attempts < 255) {
+        oldest->attempts++;
+    }
+    table->retransmitted++;
+    return oldest->event;
+}
+
+void sinricpro_inflight_clear(sinricpro_inflight_table_t *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_INFLIGHT_EVENTS; i++) {
+        cJSON_Delete(release(&table->entries[i]));
+    }
+}
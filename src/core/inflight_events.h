@@ -0,0 +1,179 @@
+/**
+ * @file inflight_events.h
+ * @brief Sent events awaiting the server's response
+ *
+ * The server answers every event with a response carrying the event's
+ * replyToken. A released event is kept here until that response arrives.
+ * Events not answered within SINRICPRO_EVENT_ACK_TIMEOUT_MS, and all
+ * unanswered events after a reconnect, are sent again unchanged (same
+ * replyToken and createdAt, so the server can discard a copy it already
+ * has). After SINRICPRO_EVENT_MAX_ATTEMPTS sends the event is given up.
+ */
+
+#ifndef SINRICPRO_INFLIGHT_EVENTS_H
+#define SINRICPRO_INFLIGHT_EVENTS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro_config.h"
+#include "cJSON.h"
+
+/**
+ * @brief Event awaiting its response
+ */
+typedef struct {
+    cJSON *event;                       // NULL = free
+    uint32_t first_sent_ms;
+    uint32_t sent_ms;                   // Most recent send
+    uint8_t attempts;                   // Sends so far
+    bool resend;                        // Send again without waiting (reconnected)
+    uint8_t token_len;
+    char reply_token[SINRICPRO_REPLY_TOKEN_MAX_LEN + 1];
+} sinricpro_inflight_entry_t;
+
+/**
+ * @brief In-flight event table
+ */
+typedef struct {
+    sinricpro_inflight_entry_t entries[SINRICPRO_MAX_INFLIGHT_EVENTS];
+    uint32_t answered;
+    uint32_t retransmitted;
+    uint32_t superseded;                // Dropped for a newer value of the same property
+    uint32_t expired;                   // Unanswered after SINRICPRO_EVENT_MAX_ATTEMPTS sends
+    uint64_t latency_total_ms;          // First send to response, answered events
+    uint32_t latency_max_ms;
+} sinricpro_inflight_table_t;
+
+/**
+ * @brief Initialize (empty) the table
+ *
+ * @param table Table
+ */
+void sinricpro_inflight_init(sinricpro_inflight_table_t *table);
+
+/**
+ * @brief Whether another event can be tracked
+ *
+ * @param table Table
+ * @return true if every slot holds an unanswered event
+ */
+bool sinricpro_inflight_full(const sinricpro_inflight_table_t *table);
+
+/**
+ * @brief Track an event that has just been sent
+ *
+ * @param table  Table
+ * @param event  Event message (owned by the table once added)
+ * @param now_ms Current time (ms since boot)
+ * @return false if the table is full or the event has no usable replyToken
+ *         (not added; the caller still owns the event)
+ */
+bool sinricpro_inflight_add(sinricpro_inflight_table_t *table, cJSON *event, uint32_t now_ms);
+
+/**
+ * @brief Check for an unanswered event by replyToken
+ *
+ * @param table     Table
+ * @param token     replyToken (need not be NUL-terminated)
+ * @param token_len Token length
+ * @return true if the event is still awaiting its response
+ */
+bool sinricpro_inflight_has_token(const sinricpro_inflight_table_t *table,
+                                  const char *token,
+                                  size_t token_len);
+
+/**
+ * @brief Remove the event a response answers
+ *
+ * @param table      Table
+ * @param token      replyToken of the response
+ * @param token_len  Token length
+ * @param now_ms     Current time (ms since boot)
+ * @param latency_ms Output: first send to now
+ * @return The event (caller deletes it), or NULL if no event has that token
+ */
+cJSON *sinricpro_inflight_take(sinricpro_inflight_table_t *table,
+                               const char *token,
+                               size_t token_len,
+                               uint32_t now_ms,
+                               uint32_t *latency_ms);
+
+/**
+ * @brief Remove an unanswered event for the same device and action
+ *
+ * Call before adding a newer value of a property that coalesces; the
+ * newer event carries the state, so the older one needn't be resent.
+ *
+ * @param table     Table
+ * @param device_id Device ID
+ * @param action    Action name
+ * @return The older event (caller deletes it), or NULL
+ */
+cJSON *sinricpro_inflight_take_superseded(sinricpro_inflight_table_t *table,
+                                          const char *device_id,
+                                          const char *action);
+
+/**
+ * @brief Remove one event that went unanswered after its last send
+ *
+ * Call until it returns NULL, only while connected.
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return The event (caller deletes it), or NULL
+ */
+cJSON *sinricpro_inflight_take_expired(sinricpro_inflight_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Count events sinricpro_inflight_take_expired() would return
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return Events unanswered after their last send
+ */
+size_t sinricpro_inflight_expired_count(const sinricpro_inflight_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Send every unanswered event again (after a reconnect)
+ *
+ * @param table Table
+ */
+void sinricpro_inflight_mark_resend(sinricpro_inflight_table_t *table);
+
+/**
+ * @brief Count events due to be sent again
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return Events marked for resend or unanswered for SINRICPRO_EVENT_ACK_TIMEOUT_MS
+ */
+size_t sinricpro_inflight_resend_count(const sinricpro_inflight_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Take the oldest event due to be sent again
+ *
+ * The event stays in the table; its send count and time are updated.
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return The event to send (still owned by the table), or NULL
+ */
+cJSON *sinricpro_inflight_next_resend(sinricpro_inflight_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Drop all entries, deleting their events
+ *
+ * @param table Table
+ */
+void sinricpro_inflight_clear(sinricpro_inflight_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_INFLIGHT_EVENTS_H
@@ -4,6 +4,7 @@
  */
 
 #include "json_helpers.h"
+#include "server_clock.h"
 #include "sinricpro/sinricpro_config.h"
 #include <string.h>
 #include <stdio.h>
@@ -11,8 +12,8 @@
 #include "pico/time.h"
 #include "pico/rand.h"
 
-// Static timestamp offset (set when NTP sync occurs)
-static uint32_t timestamp_offset = 0;
+// Server time, synced from the timestamp the server sends on connect
+static sinricpro_clock_t server_clock;
 
 cJSON *sinricpro_json_create_message(void) {
     cJSON *message = cJSON_CreateObject();
@@ -308,15 +309,25 @@ bool sinricpro_json_generate_uuid(char *output, size_t output_len) {
 }
 
 uint32_t sinricpro_json_get_timestamp(void) {
-    // Get milliseconds since boot and convert to seconds
-    uint32_t seconds_since_boot = to_ms_since_boot(get_absolute_time()) / 1000;
+    return sinricpro_json_timestamp_of(time_us_64());
+}
+
+uint32_t sinricpro_json_timestamp_of(uint64_t captured_us) {
+    return (uint32_t)(sinricpro_clock_unix_ms(&server_clock, captured_us) / 1000);
+}
+
+uint64_t sinricpro_json_time_ms(uint64_t local_us) {
+    return sinricpro_clock_unix_ms(&server_clock, local_us);
+}
+
+bool sinricpro_json_timestamp_synced(void) {
+    return server_clock.synced;
+}
 
-    // Add offset from NTP (if set)
-    return timestamp_offset + seconds_since_boot;
+void sinricpro_json_sync_clock(double server_seconds, uint64_t local_us) {
+    sinricpro_clock_sync(&server_clock, server_seconds, local_us);
 }
 
-// Function to set timestamp offset (called when NTP sync occurs)
-void sinricpro_json_set_timestamp_offset(uint32_t unix_time) {
-    uint32_t seconds_since_boot = to_ms_since_boot(get_absolute_time()) / 1000;
-    timestamp_offset = unix_time - seconds_since_boot;
+const sinricpro_clock_t *sinricpro_json_clock(void) {
+    return &server_clock;
 }
@@ -17,6 +17,7 @@ extern "C" {
 #include <stdbool.h>
 #include <stddef.h>
 #include "cJSON.h"
+#include "server_clock.h"
 
 /**
  * @brief Message type enumeration
@@ -199,13 +200,44 @@ bool sinricpro_json_generate_uuid(char *output, size_t output_len);
 uint32_t sinricpro_json_get_timestamp(void);
 
 /**
- * @brief Set timestamp offset from server time
+ * @brief Convert a capture time to a timestamp
  *
- * Call this when the server sends a timestamp message to sync local time.
+ * @param captured_us Time the event happened (time_us_64())
+ * @return Unix epoch seconds at that moment
+ */
+uint32_t sinricpro_json_timestamp_of(uint64_t captured_us);
+
+/**
+ * @brief Convert a local time to server time in milliseconds
+ *
+ * @param local_us Local time (time_us_64())
+ * @return Unix time in ms, or ms since boot while unsynced
+ */
+uint64_t sinricpro_json_time_ms(uint64_t local_us);
+
+/**
+ * @brief Check whether server time has been received
+ *
+ * @return false while timestamps are still seconds since boot
+ */
+bool sinricpro_json_timestamp_synced(void);
+
+/**
+ * @brief Sync the clock to server time
+ *
+ * Call this when the server sends a timestamp message.
+ *
+ * @param server_seconds Server's Unix timestamp
+ * @param local_us       Local time the message arrived (time_us_64())
+ */
+void sinricpro_json_sync_clock(double server_seconds, uint64_t local_us);
+
+/**
+ * @brief Get the server clock state
  *
- * @param unix_time Server's Unix timestamp
+ * @return Clock (sync and drift statistics)
  */
-void sinricpro_json_set_timestamp_offset(uint32_t unix_time);
+const sinricpro_clock_t *sinricpro_json_clock(void);
 
 #ifdef __cplusplus
 }
@@ -1,56 +1,63 @@
 /**
  * @file message_queue.c
- * @brief Thread-safe message queue implementation for SinricPro
+ * @brief Lock-free single-producer/single-consumer message queue for SinricPro
  */
 
 #include "message_queue.h"
 #include <string.h>
-#include "pico/critical_section.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
 
-// Critical section for thread safety
-static critical_section_t queue_cs;
-static bool cs_initialized = false;
+// head and tail run freely and wrap at 2^32; masking needs a power of two
+_Static_assert((SINRICPRO_MESSAGE_QUEUE_SIZE & (SINRICPRO_MESSAGE_QUEUE_SIZE - 1)) == 0,
+               "SINRICPRO_MESSAGE_QUEUE_SIZE must be a power of two");
 
-static void ensure_cs_init(void) {
-    if (!cs_initialized) {
-        critical_section_init(&queue_cs);
-        cs_initialized = true;
+#define QUEUE_INDEX(n) ((n) & (SINRICPRO_MESSAGE_QUEUE_SIZE - 1))
+
+// Copy the slot at tail into the caller's buffer
+static void copy_out(const sinricpro_message_t *slot,
+                     sinricpro_interface_t *interface,
+                     char *message,
+                     size_t max_len,
+                     size_t *length) {
+    // Calculate copy length
+    size_t copy_len = slot->length;
+    if (copy_len >= max_len) {
+        copy_len = max_len - 1;
+    }
+
+    // Copy message data
+    memcpy(message, slot->message, copy_len);
+    message[copy_len] = '\0';
+
+    if (interface) {
+        *interface = slot->interface;
+    }
+    if (length) {
+        *length = slot->length;
     }
 }
 
 void sinricpro_queue_init(sinricpro_queue_t *queue) {
     if (!queue) return;
 
-    ensure_cs_init();
-
-    critical_section_enter_blocking(&queue_cs);
-
-    queue->head = 0;
-    queue->tail = 0;
-    queue->count = 0;
-
-    for (size_t i = 0; i < SINRICPRO_MESSAGE_QUEUE_SIZE; i++) {
-        queue->messages[i].in_use = false;
-        queue->messages[i].length = 0;
-        queue->messages[i].interface = SINRICPRO_IF_UNKNOWN;
-    }
-
-    critical_section_exit(&queue_cs);
+    memset(queue, 0, sizeof(sinricpro_queue_t));
+    __dmb();
 }
 
 bool sinricpro_queue_is_empty(const sinricpro_queue_t *queue) {
     if (!queue) return true;
-    return queue->count == 0;
+    return queue->head == queue->tail;
 }
 
 bool sinricpro_queue_is_full(const sinricpro_queue_t *queue) {
     if (!queue) return true;
-    return queue->count >= SINRICPRO_MESSAGE_QUEUE_SIZE;
+    return (uint32_t)(queue->head - queue->tail) >= SINRICPRO_MESSAGE_QUEUE_SIZE;
 }
 
 size_t sinricpro_queue_count(const sinricpro_queue_t *queue) {
     if (!queue) return 0;
-    return queue->count;
+    return (uint32_t)(queue->head - queue->tail);
 }
 
 bool sinricpro_queue_push(sinricpro_queue_t *queue,
@@ -66,30 +73,29 @@ bool sinricpro_queue_push(sinricpro_queue_t *queue,
         length = SINRICPRO_MAX_MESSAGE_SIZE - 1;
     }
 
-    ensure_cs_init();
-    critical_section_enter_blocking(&queue_cs);
+    uint32_t head = queue->head;
 
-    // Check if queue is full
-    if (queue->count >= SINRICPRO_MESSAGE_QUEUE_SIZE) {
-        critical_section_exit(&queue_cs);
+    // Check if queue is full (tail is owned by the consumer)
+    if ((uint32_t)(head - queue->tail) >= SINRICPRO_MESSAGE_QUEUE_SIZE) {
+        queue->dropped++;
         return false;
     }
 
-    // Get slot at head position
-    sinricpro_message_t *slot = &queue->messages[queue->head];
+    // Order the tail read before overwriting the slot it released
+    __dmb();
 
-    // Copy message data
+    // Fill slot at head position
+    sinricpro_message_t *slot = &queue->messages[QUEUE_INDEX(head)];
     memcpy(slot->message, message, length);
     slot->message[length] = '\0';
     slot->length = length;
     slot->interface = interface;
-    slot->in_use = true;
+    slot->enqueued_us = time_us_32();
 
-    // Advance head pointer (wrap around)
-    queue->head = (queue->head + 1) % SINRICPRO_MESSAGE_QUEUE_SIZE;
-    queue->count++;
+    // Publish: slot contents must be visible before the new head
+    __dmb();
+    queue->head = head + 1;
 
-    critical_section_exit(&queue_cs);
     return true;
 }
 
@@ -102,49 +108,32 @@ bool sinricpro_queue_pop(sinricpro_queue_t *queue,
         return false;
     }
 
-    ensure_cs_init();
-    critical_section_enter_blocking(&queue_cs);
+    uint32_t tail = queue->tail;
 
     // Check if queue is empty
-    if (queue->count == 0) {
-        critical_section_exit(&queue_cs);
+    if (tail == queue->head) {
         return false;
     }
 
-    // Get slot at tail position
-    sinricpro_message_t *slot = &queue->messages[queue->tail];
+    // Order the head read before reading the slot it published
+    __dmb();
 
-    if (!slot->in_use) {
-        critical_section_exit(&queue_cs);
-        return false;
-    }
+    const sinricpro_message_t *slot = &queue->messages[QUEUE_INDEX(tail)];
+    copy_out(slot, interface, message, max_len, length);
 
-    // Calculate copy length
-    size_t copy_len = slot->length;
-    if (copy_len >= max_len) {
-        copy_len = max_len - 1;
+    // Latency statistics
+    uint32_t latency = time_us_32() - slot->enqueued_us;
+    queue->last_enqueued_us = slot->enqueued_us;
+    queue->delivered++;
+    queue->latency_total_us += latency;
+    if (latency > queue->latency_max_us) {
+        queue->latency_max_us = latency;
     }
 
-    // Copy message data
-    memcpy(message, slot->message, copy_len);
-    message[copy_len] = '\0';
+    // Release the slot: reads must complete before the producer may reuse it
+    __dmb();
+    queue->tail = tail + 1;
 
-    if (interface) {
-        *interface = slot->interface;
-    }
-    if (length) {
-        *length = slot->length;
-    }
-
-    // Clear slot
-    slot->in_use = false;
-    slot->length = 0;
-
-    // Advance tail pointer (wrap around)
-    queue->tail = (queue->tail + 1) % SINRICPRO_MESSAGE_QUEUE_SIZE;
-    queue->count--;
-
-    critical_section_exit(&queue_cs);
     return true;
 }
 
@@ -157,58 +146,34 @@ bool sinricpro_queue_peek(const sinricpro_queue_t *queue,
         return false;
     }
 
-    ensure_cs_init();
-    critical_section_enter_blocking(&queue_cs);
+    uint32_t tail = queue->tail;
 
     // Check if queue is empty
-    if (queue->count == 0) {
-        critical_section_exit(&queue_cs);
-        return false;
-    }
-
-    // Get slot at tail position (don't remove)
-    const sinricpro_message_t *slot = &queue->messages[queue->tail];
-
-    if (!slot->in_use) {
-        critical_section_exit(&queue_cs);
+    if (tail == queue->head) {
         return false;
     }
 
-    // Calculate copy length
-    size_t copy_len = slot->length;
-    if (copy_len >= max_len) {
-        copy_len = max_len - 1;
-    }
-
-    // Copy message data
-    memcpy(message, slot->message, copy_len);
-    message[copy_len] = '\0';
-
-    if (interface) {
-        *interface = slot->interface;
-    }
-    if (length) {
-        *length = slot->length;
-    }
+    __dmb();
 
-    critical_section_exit(&queue_cs);
+    // Get slot at tail position (don't remove)
+    copy_out(&queue->messages[QUEUE_INDEX(tail)], interface, message, max_len, length);
     return true;
 }
 
 void sinricpro_queue_clear(sinricpro_queue_t *queue) {
     if (!queue) return;
 
-    ensure_cs_init();
-    critical_section_enter_blocking(&queue_cs);
-
-    queue->head = 0;
-    queue->tail = 0;
-    queue->count = 0;
+    __dmb();
+    queue->tail = queue->head;
+}
 
-    for (size_t i = 0; i < SINRICPRO_MESSAGE_QUEUE_SIZE; i++) {
-        queue->messages[i].in_use = false;
-        queue->messages[i].length = 0;
-    }
+void sinricpro_queue_get_stats(const sinricpro_queue_t *queue,
+                               sinricpro_queue_stats_t *stats) {
+    if (!queue || !stats) return;
 
-    critical_section_exit(&queue_cs);
+    stats->delivered = queue->delivered;
+    stats->dropped = queue->dropped;
+    stats->latency_max_us = queue->latency_max_us;
+    stats->latency_avg_us = queue->delivered > 0
+        ? (uint32_t)(queue->latency_total_us / queue->delivered) : 0;
 }
@@ -1,9 +1,11 @@
 /**
  * @file message_queue.h
- * @brief Thread-safe message queue (ring buffer) for SinricPro
+ * @brief Lock-free message queue (ring buffer) for SinricPro
  *
  * Provides a fixed-size ring buffer for queuing incoming and outgoing
- * messages. Designed to be interrupt-safe for use with the Pico SDK.
+ * messages. Each queue has exactly one producer and one consumer, which may
+ * run on different cores: the producer only writes head, the consumer only
+ * writes tail, and memory barriers order slot data against the indices.
  */
 
 #ifndef SINRICPRO_MESSAGE_QUEUE_H
@@ -34,7 +36,7 @@ typedef struct {
     sinricpro_interface_t interface;
     char message[SINRICPRO_MAX_MESSAGE_SIZE];
     size_t length;
-    bool in_use;
+    uint32_t enqueued_us;    // Push time, for latency statistics
 } sinricpro_message_t;
 
 /**
@@ -42,11 +44,27 @@ typedef struct {
  */
 typedef struct {
     sinricpro_message_t messages[SINRICPRO_MESSAGE_QUEUE_SIZE];
-    volatile size_t head;    // Next write position
-    volatile size_t tail;    // Next read position
-    volatile size_t count;   // Number of items in queue
+    volatile uint32_t head;  // Messages pushed (producer only)
+    volatile uint32_t tail;  // Messages popped (consumer only)
+
+    // Statistics: dropped is written by the producer, the rest by the consumer
+    volatile uint32_t dropped;
+    uint32_t delivered;
+    uint32_t latency_max_us;
+    uint64_t latency_total_us;
+    uint32_t last_enqueued_us;  // Push time of the message last popped
 } sinricpro_queue_t;
 
+/**
+ * @brief Queue latency statistics
+ */
+typedef struct {
+    uint32_t delivered;      // Messages popped
+    uint32_t dropped;        // Pushes rejected because the queue was full
+    uint32_t latency_avg_us; // Average push-to-pop time
+    uint32_t latency_max_us; // Worst push-to-pop time
+} sinricpro_queue_stats_t;
+
 /**
  * @brief Initialize a message queue
  *
@@ -127,10 +145,21 @@ bool sinricpro_queue_peek(const sinricpro_queue_t *queue,
 /**
  * @brief Clear all messages from the queue
  *
+ * Must be called from the consumer side.
+ *
  * @param queue Pointer to queue structure
  */
 void sinricpro_queue_clear(sinricpro_queue_t *queue);
 
+/**
+ * @brief Get latency statistics
+ *
+ * @param queue Pointer to queue structure
+ * @param stats Output structure
+ */
+void sinricpro_queue_get_stats(const sinricpro_queue_t *queue,
+                               sinricpro_queue_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
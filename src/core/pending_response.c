@@ -0,0 +1,140 @@
+/**
+ * @file pending_response.c
+ * @brief Deferred response table implementation
+ */
+
+#include "pending_response.h"
+#include "json_helpers.h"
+#include <string.h>
+
+// Handle: generation in the upper bits, slot index + 1 in the low byte
+#define HANDLE_SLOT(h)          ((size_t)((h) & 0xFF) - 1)
+#define HANDLE_GENERATION(h)    ((uint16_t)((h) >> 8))
+
+_Static_assert(SINRICPRO_MAX_PENDING_RESPONSES > 0 && SINRICPRO_MAX_PENDING_RESPONSES < 255,
+               "Pending response slots are 8-bit");
+
+void sinricpro_pending_init(sinricpro_pending_table_t *table) {
+    if (!table) return;
+    memset(table, 0, sizeof(sinricpro_pending_table_t));
+}
+
+sinricpro_pending_t sinricpro_pending_add(sinricpro_pending_table_t *table,
+                                          cJSON *response,
+                                          uint32_t now_ms) {
+    if (!table || !response) return SINRICPRO_PENDING_NONE;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        sinricpro_pending_entry_t *entry = &table->entries[i];
+        if (entry->response) continue;
+
+        const char *token = sinricpro_json_get_reply_token(response);
+        size_t token_len = token ? strlen(token) : 0;
+        if (token_len > SINRICPRO_REPLY_TOKEN_MAX_LEN) {
+            token_len = 0;              // Still completes, retries just aren't recognized
+        }
+        if (token_len > 0) {
+            memcpy(entry->reply_token, token, token_len);
+        }
+        entry->reply_token[token_len] = '\0';
+        entry->token_len = (uint8_t)token_len;
+
+        entry->response = response;
+        entry->started_ms = now_ms;
+        entry->generation++;
+        table->deferred++;
+
+        return ((sinricpro_pending_t)entry->generation << 8) | (sinricpro_pending_t)(i + 1);
+    }
+
+    table->rejected++;
+    return SINRICPRO_PENDING_NONE;
+}
+
+sinricpro_pending_entry_t *sinricpro_pending_find(sinricpro_pending_table_t *table,
+                                                  sinricpro_pending_t handle) {
+    if (!table || handle == SINRICPRO_PENDING_NONE) return NULL;
+
+    size_t slot = HANDLE_SLOT(handle);
+    if (slot >= SINRICPRO_MAX_PENDING_RESPONSES) return NULL;
+
+    sinricpro_pending_entry_t *entry = &table->entries[slot];
+    if (!entry->response || entry->generation != HANDLE_GENERATION(handle)) {
+        return NULL;
+    }
+    return entry;
+}
+
+bool sinricpro_pending_has_token(const sinricpro_pending_table_t *table,
+                                 const char *token,
+                                 size_t token_len) {
+    if (!table || !token || token_len == 0) return false;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        const sinricpro_pending_entry_t *entry = &table->entries[i];
+        if (entry->response && entry->token_len == token_len &&
+            memcmp(entry->reply_token, token, token_len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+cJSON *sinricpro_pending_release(sinricpro_pending_table_t *table,
+                                 sinricpro_pending_entry_t *entry) {
+    if (!table || !entry) return NULL;
+
+    cJSON *response = entry->response;
+    entry->response = NULL;
+    entry->token_len = 0;
+    return response;
+}
+
+static inline bool is_expired(const sinricpro_pending_entry_t *entry, uint32_t now_ms) {
+    return entry->response &&
+           (now_ms - entry->started_ms) >= SINRICPRO_PENDING_RESPONSE_TIMEOUT_MS;
+}
+
+cJSON *sinricpro_pending_take_expired(sinricpro_pending_table_t *table, uint32_t now_ms) {
+    if (!table) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        sinricpro_pending_entry_t *entry = &table->entries[i];
+        if (is_expired(entry, now_ms)) {
+            table->timed_out++;
+            return sinricpro_pending_release(table, entry);
+        }
+    }
+    return NULL;
+}
+
+size_t sinricpro_pending_expired_count(const sinricpro_pending_table_t *table, uint32_t now_ms) {
+    if (!table) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        if (is_expired(&table->entries[i], now_ms)) count++;
+    }
+    return count;
+}
+
+cJSON *sinricpro_pending_take_device(sinricpro_pending_table_t *table, const char *device_id) {
+    if (!table || !device_id) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        sinricpro_pending_entry_t *entry = &table->entries[i];
+        const char *id = entry->response ? sinricpro_json_get_device_id(entry->response) : NULL;
+        if (id && strcmp(id, device_id) == 0) {
+            return sinricpro_pending_release(table, entry);
+        }
+    }
+    return NULL;
+}
+
+void sinricpro_pending_clear(sinricpro_pending_table_t *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SINRICPRO_MAX_PENDING_RESPONSES; i++) {
+        cJSON_Delete(sinricpro_pending_release(table, &table->entries[i]));
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file pending_response.h
+ * @brief Deferred responses for long-running device callbacks
+ *
+ * A request callback that can't finish in time (a garage door or lock that
+ * takes seconds to move) defers its response. The response being built is
+ * kept here, with its replyToken, clientId and action, until the app
+ * completes it or it times out after SINRICPRO_PENDING_RESPONSE_TIMEOUT_MS.
+ * Handles carry a per-slot generation so a stale handle can't complete a
+ * later request that reused the slot.
+ */
+
+#ifndef SINRICPRO_PENDING_RESPONSE_H
+#define SINRICPRO_PENDING_RESPONSE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro.h"
+#include "cJSON.h"
+
+/**
+ * @brief Deferred response
+ */
+typedef struct {
+    cJSON *response;                    // NULL = free
+    uint32_t started_ms;
+    uint16_t generation;
+    uint8_t token_len;
+    char reply_token[SINRICPRO_REPLY_TOKEN_MAX_LEN + 1];
+} sinricpro_pending_entry_t;
+
+/**
+ * @brief Deferred response table
+ */
+typedef struct {
+    sinricpro_pending_entry_t entries[SINRICPRO_MAX_PENDING_RESPONSES];
+    uint32_t deferred;
+    uint32_t completed;
+    uint32_t timed_out;
+    uint32_t rejected;                  // Deferrals refused because the table was full
+} sinricpro_pending_table_t;
+
+/**
+ * @brief Initialize (empty) the table
+ *
+ * @param table Table
+ */
+void sinricpro_pending_init(sinricpro_pending_table_t *table);
+
+/**
+ * @brief Keep a response until it is completed
+ *
+ * @param table    Table
+ * @param response Response being built (owned by the table once added)
+ * @param now_ms   Current time (ms since boot)
+ * @return Handle, or SINRICPRO_PENDING_NONE if the table is full
+ */
+sinricpro_pending_t sinricpro_pending_add(sinricpro_pending_table_t *table,
+                                          cJSON *response,
+                                          uint32_t now_ms);
+
+/**
+ * @brief Look up a deferred response
+ *
+ * @param table  Table
+ * @param handle Handle from sinricpro_pending_add()
+ * @return Entry, or NULL if the handle is unknown, completed or timed out
+ */
+sinricpro_pending_entry_t *sinricpro_pending_find(sinricpro_pending_table_t *table,
+                                                  sinricpro_pending_t handle);
+
+/**
+ * @brief Check for a deferred response by replyToken
+ *
+ * @param table     Table
+ * @param token     replyToken (need not be NUL-terminated)
+ * @param token_len Token length
+ * @return true if a response to that request is still pending
+ */
+bool sinricpro_pending_has_token(const sinricpro_pending_table_t *table,
+                                 const char *token,
+                                 size_t token_len);
+
+/**
+ * @brief Remove an entry, handing its response back to the caller
+ *
+ * @param table Table
+ * @param entry Entry from sinricpro_pending_find() or _take_expired()
+ * @return The response (caller deletes it)
+ */
+cJSON *sinricpro_pending_release(sinricpro_pending_table_t *table,
+                                 sinricpro_pending_entry_t *entry);
+
+/**
+ * @brief Remove one timed-out entry
+ *
+ * Call until it returns NULL.
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return Response of a timed-out entry (caller deletes it), or NULL
+ */
+cJSON *sinricpro_pending_take_expired(sinricpro_pending_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Count entries sinricpro_pending_take_expired() would return
+ *
+ * @param table  Table
+ * @param now_ms Current time (ms since boot)
+ * @return Timed-out entries
+ */
+size_t sinricpro_pending_expired_count(const sinricpro_pending_table_t *table, uint32_t now_ms);
+
+/**
+ * @brief Remove one entry of a device
+ *
+ * Call until it returns NULL.
+ *
+ * @param table     Table
+ * @param device_id Device whose responses are removed
+ * @return Response of one of the device's entries (caller deletes it), or NULL
+ */
+cJSON *sinricpro_pending_take_device(sinricpro_pending_table_t *table, const char *device_id);
+
+/**
+ * @brief Drop all entries, deleting their responses
+ *
+ * @param table Table
+ */
+void sinricpro_pending_clear(sinricpro_pending_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_PENDING_RESPONSE_H
@@ -0,0 +1,115 @@
+/**
+ * @file prescan.c
+ * @brief Raw message pre-scan implementation
+ */
+
+#include "prescan.h"
+#include <string.h>
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Top-level object the scan is inside
+typedef enum {
+    SECTION_NONE = 0,
+    SECTION_PAYLOAD,
+    SECTION_SIGNATURE
+} section_t;
+
+static inline bool token_is(const char *token, size_t len, const char *name) {
+    return strlen(name) == len && memcmp(token, name, len) == 0;
+}
+
+static void capture(sinricpro_prescan_t *scan, section_t section,
+                    const char *key, size_t key_len,
+                    const char *token, size_t token_len) {
+    if (section == SECTION_PAYLOAD) {
+        if (token_is(key, key_len, "type")) {
+            scan->type = token;
+            scan->type_len = token_len;
+        } else if (token_is(key, key_len, "deviceId")) {
+            scan->device_id = token;
+            scan->device_id_len = token_len;
+        } else if (token_is(key, key_len, "action")) {
+            scan->action = token;
+            scan->action_len = token_len;
+        } else if (token_is(key, key_len, "replyToken")) {
+            scan->reply_token = token;
+            scan->reply_token_len = token_len;
+        }
+    } else if (section == SECTION_SIGNATURE && token_is(key, key_len, "HMAC")) {
+        scan->hmac = token;
+        scan->hmac_len = token_len;
+    }
+}
+
+bool sinricpro_prescan(const char *message, size_t length, sinricpro_prescan_t *scan) {
+    if (!message || !scan) return false;
+
+    memset(scan, 0, sizeof(sinricpro_prescan_t));
+
+    int depth = 0;
+    section_t section = SECTION_NONE;
+    const char *key = NULL;             // Key awaiting its value
+    size_t key_len = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        char c = message[i];
+
+        if (c == '"') {
+            // String token; escapes are skipped, not decoded
+            size_t start = i + 1;
+            size_t end = start;
+            while (end < length && message[end] != '"') {
+                end += (message[end] == '\\') ? 2 : 1;
+            }
+            if (end >= length) return false;
+
+            const char *token = message + start;
+            size_t token_len = end - start;
+            i = end;
+
+            // A string followed by ':' is a key
+            size_t next = end + 1;
+            while (next < length && is_space(message[next])) next++;
+            if (next < length && message[next] == ':') {
+                key = token;
+                key_len = token_len;
+                i = next;
+                continue;
+            }
+
+            if (key && depth == 2) {
+                capture(scan, section, key, key_len, token, token_len);
+                if (scan->type && scan->device_id && scan->action &&
+                    scan->reply_token && scan->hmac) {
+                    return true;
+                }
+            }
+            key = NULL;
+        } else if (c == '{' || c == '[') {
+            depth++;
+            if (c == '{' && depth == 2 && key) {
+                if (token_is(key, key_len, "payload")) {
+                    section = SECTION_PAYLOAD;
+                    scan->has_payload = true;
+                } else if (token_is(key, key_len, "signature")) {
+                    section = SECTION_SIGNATURE;
+                }
+            }
+            key = NULL;
+        } else if (c == '}' || c == ']') {
+            if (depth == 2) {
+                section = SECTION_NONE;
+            }
+            if (--depth < 0) return false;
+            key = NULL;
+        } else if (!is_space(c) && c != ',') {
+            // Number or literal value
+            key = NULL;
+        }
+    }
+
+    return depth == 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file prescan.h
+ * @brief Raw message pre-scan for SinricPro
+ *
+ * Finds payload.type, payload.deviceId, payload.action, payload.replyToken
+ * and signature.HMAC in the raw message text without building a JSON tree,
+ * so messages that can't be for us are dropped (and retried requests
+ * answered) before cJSON parsing. The scan tracks nesting and string state
+ * only; it stops as soon as all fields are found. Full validation is still
+ * done by the normal path.
+ */
+
+#ifndef SINRICPRO_PRESCAN_H
+#define SINRICPRO_PRESCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Fields located by the pre-scan (pointers into the message)
+ *
+ * A field not present in the payload has a NULL pointer.
+ */
+typedef struct {
+    bool has_payload;
+    const char *type;
+    size_t type_len;
+    const char *device_id;
+    size_t device_id_len;
+    const char *action;
+    size_t action_len;
+    const char *reply_token;
+    size_t reply_token_len;
+    const char *hmac;                   // signature.HMAC
+    size_t hmac_len;
+} sinricpro_prescan_t;
+
+/**
+ * @brief Scan a raw message for its routing fields
+ *
+ * @param message Raw message text (need not be NUL-terminated)
+ * @param length  Message length
+ * @param scan    Output fields
+ * @return false if the message is malformed (unterminated string or
+ *         unbalanced brackets before the fields were found)
+ */
+bool sinricpro_prescan(const char *message, size_t length, sinricpro_prescan_t *scan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_PRESCAN_H
@@ -0,0 +1,79 @@
+/**
+ * @file response_cache.c
+ * @brief Recent response cache implementation
+ */
+
+#include "response_cache.h"
+#include <string.h>
+
+static inline bool is_expired(const sinricpro_cached_response_t *entry, uint32_t now_ms) {
+    return (now_ms - entry->stored_ms) >= SINRICPRO_RESPONSE_CACHE_TTL_MS;
+}
+
+void sinricpro_response_cache_init(sinricpro_response_cache_t *cache) {
+    if (!cache) return;
+    memset(cache, 0, sizeof(sinricpro_response_cache_t));
+}
+
+const sinricpro_cached_response_t *sinricpro_response_cache_find(sinricpro_response_cache_t *cache,
+                                                                 const char *token,
+                                                                 size_t token_len,
+                                                                 uint32_t now_ms) {
+    if (!cache || !token || token_len == 0) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_RESPONSE_CACHE_SIZE; i++) {
+        sinricpro_cached_response_t *entry = &cache->entries[i];
+        if (entry->token_len != token_len || memcmp(entry->reply_token, token, token_len) != 0) {
+            continue;
+        }
+
+        if (is_expired(entry, now_ms)) {
+            entry->token_len = 0;
+            cache->expired++;
+            break;
+        }
+
+        cache->hits++;
+        return entry;
+    }
+
+    cache->misses++;
+    return NULL;
+}
+
+bool sinricpro_response_cache_store(sinricpro_response_cache_t *cache,
+                                    const char *token,
+                                    size_t token_len,
+                                    const char *frame,
+                                    size_t frame_len,
+                                    uint32_t now_ms) {
+    if (!cache || !token || !frame) return false;
+
+    if (token_len == 0 || token_len > SINRICPRO_REPLY_TOKEN_MAX_LEN ||
+        frame_len > SINRICPRO_RESPONSE_CACHE_FRAME_MAX) {
+        cache->uncacheable++;
+        return false;
+    }
+
+    // Empty or expired slot first, otherwise the oldest
+    sinricpro_cached_response_t *slot = &cache->entries[0];
+    for (size_t i = 0; i < SINRICPRO_RESPONSE_CACHE_SIZE; i++) {
+        sinricpro_cached_response_t *entry = &cache->entries[i];
+        if (entry->token_len == 0 || is_expired(entry, now_ms)) {
+            slot = entry;
+            break;
+        }
+        if ((now_ms - entry->stored_ms) > (now_ms - slot->stored_ms)) {
+            slot = entry;
+        }
+    }
+
+    memcpy(slot->reply_token, token, token_len);
+    slot->reply_token[token_len] = '\0';
+    slot->token_len = (uint8_t)token_len;
+    memcpy(slot->frame, frame, frame_len);
+    slot->frame_len = (uint16_t)frame_len;
+    slot->stored_ms = now_ms;
+
+    return true;
+}
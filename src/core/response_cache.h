@@ -0,0 +1,91 @@
+/**
+ * @file response_cache.h
+ * @brief Recent response cache keyed by replyToken
+ *
+ * Keeps the signed, serialized responses to the last few requests. When the
+ * server retries a request (its response was lost, e.g. across a reconnect)
+ * the cached frame is sent again instead of running the device callback a
+ * second time. Entries expire after SINRICPRO_RESPONSE_CACHE_TTL_MS; when
+ * the cache is full the oldest entry is replaced.
+ */
+
+#ifndef SINRICPRO_RESPONSE_CACHE_H
+#define SINRICPRO_RESPONSE_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro_config.h"
+
+/**
+ * @brief Cached response
+ */
+typedef struct {
+    char reply_token[SINRICPRO_REPLY_TOKEN_MAX_LEN + 1];
+    uint8_t token_len;                  // 0 = empty
+    uint16_t frame_len;
+    uint32_t stored_ms;
+    char frame[SINRICPRO_RESPONSE_CACHE_FRAME_MAX];
+} sinricpro_cached_response_t;
+
+/**
+ * @brief Response cache
+ */
+typedef struct {
+    sinricpro_cached_response_t entries[SINRICPRO_RESPONSE_CACHE_SIZE];
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t expired;                   // Entries dropped by age on lookup
+    uint32_t uncacheable;               // Responses too large or token too long
+} sinricpro_response_cache_t;
+
+/**
+ * @brief Initialize (empty) the cache
+ *
+ * @param cache Cache
+ */
+void sinricpro_response_cache_init(sinricpro_response_cache_t *cache);
+
+/**
+ * @brief Find the response to a request
+ *
+ * Counts a hit or a miss; an expired entry is dropped and counts as a miss.
+ *
+ * @param cache     Cache
+ * @param token     replyToken (need not be NUL-terminated)
+ * @param token_len Token length
+ * @param now_ms    Current time (ms since boot)
+ * @return Cached entry, or NULL
+ */
+const sinricpro_cached_response_t *sinricpro_response_cache_find(sinricpro_response_cache_t *cache,
+                                                                 const char *token,
+                                                                 size_t token_len,
+                                                                 uint32_t now_ms);
+
+/**
+ * @brief Store the response to a request
+ *
+ * @param cache     Cache
+ * @param token     replyToken
+ * @param token_len Token length
+ * @param frame     Serialized, signed response
+ * @param frame_len Frame length
+ * @param now_ms    Current time (ms since boot)
+ * @return false if the token or frame does not fit (not cached)
+ */
+bool sinricpro_response_cache_store(sinricpro_response_cache_t *cache,
+                                    const char *token,
+                                    size_t token_len,
+                                    const char *frame,
+                                    size_t frame_len,
+                                    uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_RESPONSE_CACHE_H
@@ -0,0 +1,74 @@
+/**
+ * @file server_clock.c
+ * @brief Server-synchronized clock implementation
+ */
+
+#include "server_clock.h"
+#include <string.h>
+
+_Static_assert(SINRICPRO_CLOCK_MAX_DRIFT_PPM > 0 && SINRICPRO_CLOCK_MAX_DRIFT_PPM < 2000000,
+               "SINRICPRO_CLOCK_MAX_DRIFT_PPM out of range");
+
+#define MAX_DRIFT_PPB ((int64_t)SINRICPRO_CLOCK_MAX_DRIFT_PPM * 1000)
+
+static void set_anchor(sinricpro_clock_t *clock, uint64_t local_us, uint64_t unix_ms) {
+    clock->anchor_local_us = local_us;
+    clock->anchor_unix_ms = unix_ms;
+}
+
+void sinricpro_clock_init(sinricpro_clock_t *clock) {
+    if (!clock) return;
+    memset(clock, 0, sizeof(sinricpro_clock_t));
+}
+
+void sinricpro_clock_sync(sinricpro_clock_t *clock, double server_seconds, uint64_t local_us) {
+    if (!clock || server_seconds <= 0) return;
+
+    // The server truncates to whole seconds: take the middle of that second
+    uint64_t server_ms = (uint64_t)(server_seconds * 1000.0);
+    if (server_seconds == (double)(uint64_t)server_seconds) {
+        server_ms += 500;
+    }
+
+    clock->syncs++;
+
+    if (!clock->synced) {
+        clock->synced = true;
+        set_anchor(clock, local_us, server_ms);
+    } else {
+        int64_t correction = (int64_t)(server_ms - sinricpro_clock_unix_ms(clock, local_us));
+        clock->last_correction_ms = correction > INT32_MAX ? INT32_MAX :
+                                    correction < INT32_MIN ? INT32_MIN : (int32_t)correction;
+
+        if (correction > SINRICPRO_CLOCK_STEP_MS || correction < -SINRICPRO_CLOCK_STEP_MS) {
+            // Server time jumped, or the estimate was off: start a new sample
+            clock->steps++;
+            set_anchor(clock, local_us, server_ms);
+        } else {
+            int64_t elapsed_ms = (int64_t)((local_us - clock->anchor_local_us) / 1000);
+            if (elapsed_ms >= (int64_t)SINRICPRO_CLOCK_DRIFT_MIN_INTERVAL_S * 1000) {
+                int64_t gained_ms = (int64_t)(server_ms - clock->anchor_unix_ms) - elapsed_ms;
+                int64_t ppb = gained_ms * 1000000000 / elapsed_ms;
+                if (ppb > MAX_DRIFT_PPB) ppb = MAX_DRIFT_PPB;
+                if (ppb < -MAX_DRIFT_PPB) ppb = -MAX_DRIFT_PPB;
+
+                clock->drift_ppb = clock->drift_samples ?
+                    (int32_t)((clock->drift_ppb + ppb) / 2) : (int32_t)ppb;
+                clock->drift_samples++;
+                set_anchor(clock, local_us, server_ms);
+            }
+        }
+    }
+
+    clock->base_local_us = local_us;
+    clock->base_unix_ms = server_ms;
+}
+
+uint64_t sinricpro_clock_unix_ms(const sinricpro_clock_t *clock, uint64_t local_us) {
+    if (!clock || !clock->synced) return local_us / 1000;
+
+    // Signed: capture times may precede the last sync
+    int64_t elapsed_ms = (int64_t)(local_us - clock->base_local_us) / 1000;
+    int64_t drift_ms = elapsed_ms * clock->drift_ppb / 1000000000;
+    return clock->base_unix_ms + (uint64_t)(elapsed_ms + drift_ms);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file server_clock.h
+ * @brief Server-synchronized clock for SinricPro
+ *
+ * Maps the local 64-bit microsecond timer (time_us_64()) to Unix time in
+ * milliseconds, from the timestamp the server sends on every connect. The
+ * server sends whole seconds, so a sync is taken as the middle of that
+ * second. Between syncs the local timer is extrapolated, corrected by the
+ * crystal's drift, which is estimated from syncs at least
+ * SINRICPRO_CLOCK_DRIFT_MIN_INTERVAL_S apart (shorter intervals would
+ * mostly measure the one-second rounding).
+ */
+
+#ifndef SINRICPRO_SERVER_CLOCK_H
+#define SINRICPRO_SERVER_CLOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sinricpro/sinricpro_config.h"
+
+/**
+ * @brief Clock state
+ */
+typedef struct {
+    bool synced;
+    uint64_t base_local_us;             // Local time of the last sync
+    uint64_t base_unix_ms;              // Server time at base_local_us
+    uint64_t anchor_local_us;           // Start of the current drift sample
+    uint64_t anchor_unix_ms;
+    int32_t drift_ppb;                  // Local timer rate error (+: runs slow)
+    uint32_t drift_samples;
+    uint32_t syncs;
+    uint32_t steps;                     // Corrections over SINRICPRO_CLOCK_STEP_MS
+    int32_t last_correction_ms;         // Server time minus prediction, last sync
+} sinricpro_clock_t;
+
+/**
+ * @brief Initialize (unsynced) the clock
+ *
+ * @param clock Clock
+ */
+void sinricpro_clock_init(sinricpro_clock_t *clock);
+
+/**
+ * @brief Take a server timestamp
+ *
+ * @param clock          Clock
+ * @param server_seconds Server Unix time (whole seconds are taken as mid-second)
+ * @param local_us       Local time the timestamp arrived (time_us_64())
+ */
+void sinricpro_clock_sync(sinricpro_clock_t *clock, double server_seconds, uint64_t local_us);
+
+/**
+ * @brief Convert a local time to server time
+ *
+ * @param clock    Clock
+ * @param local_us Local time (time_us_64()), before or after the last sync
+ * @return Unix time in ms, or ms since boot while unsynced
+ */
+uint64_t sinricpro_clock_unix_ms(const sinricpro_clock_t *clock, uint64_t local_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_SERVER_CLOCK_H
@@ -139,14 +139,14 @@ bool sinricpro_calculate_signature(const char *key, const char *payload,
 }
 
 bool sinricpro_verify_signature(const char *key, const char *message,
-                                const char *signature) {
-    if (!key || !message || !signature) {
+                                const char *signature,
+                                char *scratch, size_t scratch_len) {
+    if (!key || !message || !signature || !scratch) {
         return false;
     }
 
     // Extract payload from message
-    char payload[2048];
-    size_t payload_len = sinricpro_extract_payload(message, payload, sizeof(payload));
+    size_t payload_len = sinricpro_extract_payload(message, scratch, scratch_len);
 
     if (payload_len == 0) {
         return false;
@@ -154,7 +154,7 @@ bool sinricpro_verify_signature(const char *key, const char *message,
 
     // Calculate expected signature
     char calculated_sig[SINRICPRO_SIGNATURE_MAX_LEN];
-    if (!sinricpro_calculate_signature(key, payload, calculated_sig, sizeof(calculated_sig))) {
+    if (!sinricpro_calculate_signature(key, scratch, calculated_sig, sizeof(calculated_sig))) {
         return false;
     }
 
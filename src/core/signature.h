@@ -64,13 +64,16 @@ bool sinricpro_calculate_signature(const char *key, const char *payload,
 /**
  * @brief Verify signature of an incoming message
  *
- * @param key       The secret key (app_secret)
- * @param message   The complete JSON message with signature
- * @param signature The expected signature to verify against
+ * @param key         The secret key (app_secret)
+ * @param message     The complete JSON message with signature
+ * @param signature   The expected signature to verify against
+ * @param scratch     Buffer for the extracted payload
+ * @param scratch_len Size of scratch buffer
  * @return true if signature matches, false otherwise
  */
 bool sinricpro_verify_signature(const char *key, const char *message,
-                                const char *signature);
+                                const char *signature,
+                                char *scratch, size_t scratch_len);
 
 /**
  * @brief Base64 encode a byte array
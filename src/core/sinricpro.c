@@ -5,8 +5,21 @@
 
 #include "sinricpro/sinricpro.h"
 #include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "core/websocket_client.h"
 #include "core/message_queue.h"
+#include "core/event_ring.h"
+#include "core/device_table.h"
+#include "core/prescan.h"
+#include "core/response_cache.h"
+#include "core/pending_response.h"
+#include "core/event_scheduler.h"
+#include "core/inflight_events.h"
+#include "core/state_restore.h"
+#if SINRICPRO_JOURNAL_ENABLED
+#include "core/event_journal.h"
+#include "pico/flash.h"
+#endif
 #include "core/signature.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
@@ -19,43 +32,266 @@
 #include "pico/cyw43_arch.h"
 #include "cJSON.h"
 
+#if SINRICPRO_MULTICORE
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+// Requests from core 0 to the network core
+typedef enum {
+    CORE1_IDLE = 0,
+    CORE1_CONNECT,
+    CORE1_DISCONNECT,
+    CORE1_REANNOUNCE,
+    CORE1_LINK_STATUS,
+    CORE1_STOP
+} core1_request_t;
+#endif
+
+// Units of work done by sinricpro_handle(), in order. A budgeted call that
+// runs out resumes at the same phase on the next call
+typedef enum {
+    WORK_TIMEOUTS = 0,  // One deferred response past its timeout
+    WORK_UNANSWERED,    // One event given up after its last send
+    WORK_HELD,          // One device's values held back by its limiters
+    WORK_RESTORE,       // One restored state, once due
+    WORK_SNAPSHOT,      // One capability slot of a state snapshot
+    WORK_JOURNAL,       // One journaled event (SINRICPRO_JOURNAL_ENABLED)
+    WORK_RECEIVE,       // One received message
+    WORK_EVENTS,        // One posted event (at most SINRICPRO_EVENT_BATCH per call)
+    WORK_SCHEDULE,      // One event released within the connection-wide budget
+    WORK_TRANSMIT,      // One queued frame (core 1 sends with SINRICPRO_MULTICORE)
+    WORK_DONE
+} work_phase_t;
+
 // SDK state
 typedef struct {
     sinricpro_config_t config;
     sinricpro_state_t state;
 
-    // Device registry
-    sinricpro_device_t *devices[SINRICPRO_MAX_DEVICES];
+    // Device registry (built-in storage unless a pool is set)
+    sinricpro_device_t *builtin_devices[SINRICPRO_MAX_DEVICES];
+    uint8_t builtin_table[SINRICPRO_DEVICE_TABLE_SIZE];
+    sinricpro_device_t **devices;
+    size_t device_capacity;
     size_t device_count;
+    sinricpro_device_table_t device_table;
+
+    // Devices added while connected, announced once additions settle
+    bool reannounce_pending;
+    uint32_t registry_changed_ms;
+
+    // Registry changes (under the registry lock). A change while the
+    // deviceids header streams bumps stale_announces, and core 0 announces
+    // the list again
+    uint32_t registry_seq;
+    uint32_t announced_seq;
+    volatile uint32_t stale_announces;
+    uint32_t stale_announces_seen;
 
     // Message queue
     sinricpro_queue_t rx_queue;
     sinricpro_queue_t tx_queue;
 
+    // Events waiting for the connection-wide budget
+    sinricpro_event_sched_t event_sched;
+    uint32_t last_deferred_scan_ms;     // Trailing-edge values held by device limiters
+    bool deferred_scan;                 // Scan in progress, at deferred_device
+    size_t deferred_device;
+    uint64_t capture_us;                // sinricpro_set_capture_time() for the next event
+
+    // Sent events awaiting the server's response
+    sinricpro_inflight_table_t inflight;
+    uint32_t events_acked;
+    uint32_t events_rejected;
+
+    // Server state restore: requests from one source arriving before
+    // restore_until_ms are restores, applied one at a time once they settle
+    sinricpro_restore_table_t restore;
+    bool restore_window;
+    uint32_t restore_until_ms;
+    char restore_source[32];            // payload clientId of the first restore
+    bool restore_sourced;
+    uint32_t restore_last_ms;           // Last restore received or applied
+    bool restore_applying;              // restore_last_ms is an apply
+    bool restore_echo;                  // Devices have restored_actions set
+    uint32_t restore_echo_until_ms;
+    uint32_t restore_echoes_dropped;
+
+    // State snapshot in progress: next device and capability slot
+    sinricpro_snapshot_mode_t snapshot_mode;    // SINRICPRO_SNAPSHOT_OFF = none
+    size_t snapshot_device;
+    uint8_t snapshot_slot;
+    uint32_t snapshots_started;
+    uint32_t snapshot_events;
+
+#if SINRICPRO_JOURNAL_ENABLED
+    // Events raised while offline, replayed after reconnecting
+    sinricpro_journal_t journal;
+    sinricpro_event_limiter_t journal_replay;
+#endif
+
     // Callbacks
     sinricpro_state_callback_t state_callback;
     void *state_callback_data;
+    sinricpro_delivery_callback_t delivery_callback;
+    void *delivery_callback_data;
+
+    // Server list passed to the WebSocket client
+    sinricpro_ws_server_t servers[SINRICPRO_MAX_SERVERS];
+    size_t server_count;
 
     // Connection state
     bool wifi_connected;
     uint32_t last_connect_attempt;
 
-    // Device ID list for WebSocket headers
-    char device_ids_header[SINRICPRO_MAX_DEVICES * (SINRICPRO_DEVICE_ID_LENGTH + 1) + 1];
+    // Where the last budgeted sinricpro_handle_budget() call stopped
+    work_phase_t work_phase;
+
+    // Inbound pre-filter counters and request token bucket
+    uint32_t rx_malformed;
+    uint32_t rx_not_request;
+    uint32_t rx_unknown_device;
+    uint32_t rx_unsupported_action;
+    uint32_t rx_rate_limited;
+    uint32_t rx_bad_signature;
+    sinricpro_event_limiter_t rx_limiter;
+
+    // Responses to recent requests, for retries
+    sinricpro_response_cache_t response_cache;
+
+    // Deferred responses, and the request being dispatched so its
+    // callback can defer the response
+    sinricpro_pending_table_t pending;
+    cJSON *current_response;
+    const sinricpro_device_t *current_device;
+    sinricpro_pending_t current_pending;
+    uint32_t responses_dropped;
+
+    // Request latency: arrival time of the request being handled, and
+    // whether it is being handled in the receive callback
+    uint32_t request_arrival_us;
+    bool express_active;
+    bool handling;                      // Inside handle_work()
+    bool disconnect_pending;            // Asked for from an express callback
+    uint32_t requests_express;
+    uint32_t requests_queued;
+    uint32_t latency_express[SINRICPRO_LATENCY_BUCKETS];
+    uint32_t latency_queued[SINRICPRO_LATENCY_BUCKETS];
+
+#if SINRICPRO_MULTICORE
+    // Network core control (written by core 0, cleared by core 1)
+    sinricpro_ws_config_t ws_config;
+    volatile core1_request_t core1_request;
+    bool core1_launched;
+
+    // WebSocket state published by core 1, applied on core 0
+    volatile sinricpro_ws_state_t ws_state;
+    volatile uint32_t ws_state_seq;
+    uint32_t ws_state_seen;
+
+    // WiFi link status read by core 1 on request (CORE1_LINK_STATUS)
+    volatile int link_status;
+    volatile uint32_t link_status_seq;
+#endif
 
 } sinricpro_ctx_t;
 
+_Static_assert((SINRICPRO_DEVICE_TABLE_SIZE & (SINRICPRO_DEVICE_TABLE_SIZE - 1)) == 0,
+               "SINRICPRO_DEVICE_TABLE_SIZE must be a power of two");
+_Static_assert(SINRICPRO_DEVICE_TABLE_SIZE >= 2 * SINRICPRO_MAX_DEVICES,
+               "SINRICPRO_DEVICE_TABLE_SIZE must be at least twice SINRICPRO_MAX_DEVICES");
+_Static_assert(SINRICPRO_RX_RATE_PER_SEC > 0 && SINRICPRO_RX_RATE_PER_SEC <= 1000 &&
+               SINRICPRO_RX_BURST > 0,
+               "Inbound request limit out of range");
+_Static_assert(SINRICPRO_MAX_DEVICES <= SINRICPRO_DEVICE_POOL_MAX &&
+               SINRICPRO_DEVICE_POOL_MAX < 255,
+               "Device table slots and indices are 8-bit");
+_Static_assert(SINRICPRO_TX_EVENT_DEPTH > 0 && SINRICPRO_TX_EVENT_DEPTH < SINRICPRO_MESSAGE_QUEUE_SIZE,
+               "SINRICPRO_TX_EVENT_DEPTH must leave transmit queue room for responses");
+
 static sinricpro_ctx_t ctx;
 static bool sdk_initialized = false;
 
+// Kept outside ctx so re-initialization doesn't claim another spinlock
+static sinricpro_event_ring_t event_ring;
+
+// Message-sized buffers, static so express dispatch doesn't stack them up
+// inside the lwIP receive callback. Core 0 only; handle_work() doesn't nest
+static char work_buffer[SINRICPRO_MAX_MESSAGE_SIZE];    // Received or queued frame
+static char frame_buffer[SINRICPRO_MAX_MESSAGE_SIZE];   // Outgoing frame being built
+static char sign_buffer[SINRICPRO_MAX_MESSAGE_SIZE];    // Payload text for the HMAC
+
+#if SINRICPRO_MULTICORE
+// Guards registry changes against core 1 reading device IDs for the handshake
+static spin_lock_t *registry_lock;
+#endif
+
 // Forward declarations
 static void on_ws_message(const char *message, size_t length, void *user_data);
+static bool express_ready(void);
 static void on_ws_state(sinricpro_ws_state_t state, void *user_data);
+static void apply_ws_state(sinricpro_ws_state_t ws_state);
+static bool transmit_one(char *buffer, size_t buffer_size);
+static void handle_work(uint32_t budget_us, bool limited);
+static bool do_work(work_phase_t phase, char *buffer, size_t buffer_size, int *events);
+static size_t work_remaining(void);
 static void process_incoming_message(const char *message, size_t length);
+static bool prefilter_message(const char *message, size_t length, sinricpro_prescan_t *scan);
+static bool rx_admit(uint32_t now);
+static bool answer_from_cache(const char *message, const sinricpro_prescan_t *scan);
+static void send_response(const char *frame, size_t length);
+static bool queue_response(const char *frame, size_t length);
+static void record_latency(uint32_t *histogram, uint32_t latency_us);
+static size_t serialize_signed(cJSON *message, char *output, size_t output_len);
 static void process_request(cJSON *message);
+static bool dispatch_request(sinricpro_device_t *device, sinricpro_action_t action_id,
+                             const char *action, cJSON *message, cJSON *response);
+static bool park_restore(sinricpro_device_t *device, sinricpro_action_t action_id,
+                         cJSON *message, cJSON *response);
+static bool is_restore(const sinricpro_device_t *device, sinricpro_action_t action_id,
+                       const char *source, uint32_t now);
+static void answer_restore(cJSON *responses, bool success);
+static bool apply_restored_state(void);
+static bool is_restore_echo(uint8_t device, sinricpro_action_t action);
+static bool publish_snapshot(void);
+static bool is_event_response(const sinricpro_prescan_t *scan);
+static void process_event_response(cJSON *message);
+static size_t finish_response(cJSON *response, bool success, char *frame, size_t frame_len);
+static void send_deferred(cJSON *response, bool success, cJSON *value);
+static bool expire_pending_response(void);
+static bool flush_deferred_events(void);
 static bool send_message(cJSON *message);
-static void update_device_ids_header(void);
+static bool schedule_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                           uint64_t captured_us);
+static bool budget_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                         uint64_t captured_us);
+#if SINRICPRO_JOURNAL_ENABLED
+static bool journal_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                          uint64_t captured_us);
+static bool replay_journal(void);
+static bool replay_entry(const sinricpro_journal_entry_t *entry);
+#endif
+static bool release_scheduled_event(void);
+static void track_event(cJSON *event, uint32_t now);
+static bool expire_unanswered_event(void);
+static void report_delivery(cJSON *event, sinricpro_delivery_status_t status, uint32_t latency_ms);
+static uint8_t device_position(const char *device_id);
+static bool expand_posted_event(void);
+static bool queue_event_value(uint8_t position, sinricpro_action_t action_id,
+                              const sinricpro_event_value_t *v, uint64_t captured_us);
+static cJSON *create_event_value(sinricpro_action_t action, const sinricpro_event_value_t *v);
+static bool device_id_at(size_t index, char *id, size_t size, void *user_data);
+static uint8_t registered_position(const sinricpro_device_t *device, uint8_t hint);
+static uint32_t registry_lock_begin(void);
+static void registry_lock_end(uint32_t save);
 static void set_state(sinricpro_state_t new_state);
+static void check_reannounce(void);
+#if SINRICPRO_MULTICORE
+static void core1_main(void);
+static void flush_tx_queue(char *buffer, size_t buffer_size);
+static bool core1_post(core1_request_t request);
+#endif
+static int wifi_link_status(void);
 
 bool sinricpro_init(const sinricpro_config_t *config) {
     if (!config || !config->app_key || !config->app_secret) {
@@ -64,9 +300,26 @@ bool sinricpro_init(const sinricpro_config_t *config) {
     }
 
     // Store configuration
+    if (sdk_initialized) {
+        sinricpro_pending_clear(&ctx.pending);
+        sinricpro_sched_clear(&ctx.event_sched);
+        sinricpro_inflight_clear(&ctx.inflight);
+        sinricpro_restore_clear(&ctx.restore);
+#if SINRICPRO_JOURNAL_ENABLED
+        sinricpro_journal_flush(&ctx.journal);
+#endif
+    }
     memset(&ctx, 0, sizeof(ctx));
     memcpy(&ctx.config, config, sizeof(sinricpro_config_t));
 
+    ctx.devices = ctx.builtin_devices;
+    ctx.device_capacity = SINRICPRO_MAX_DEVICES;
+    ctx.device_table.slots = ctx.builtin_table;
+    ctx.device_table.size = SINRICPRO_DEVICE_TABLE_SIZE;
+
+    sinricpro_event_limiter_init_bucket(&ctx.rx_limiter, 1000 / SINRICPRO_RX_RATE_PER_SEC,
+                                        SINRICPRO_RX_BURST);
+
     // Set debug mode globally
     sinricpro_debug_set_enabled(ctx.config.enable_debug);
 
@@ -82,6 +335,23 @@ bool sinricpro_init(const sinricpro_config_t *config) {
         ctx.config.server_port = ctx.config.use_ssl ? 443 : 80;
     }
 
+    // Build the failover list; a single entry when none is given
+    if (ctx.config.servers && ctx.config.server_count > 0) {
+        for (size_t i = 0; i < ctx.config.server_count && i < SINRICPRO_MAX_SERVERS; i++) {
+            const sinricpro_server_t *server = &ctx.config.servers[i];
+            if (!server->url) continue;
+
+            ctx.servers[ctx.server_count].host = server->url;
+            ctx.servers[ctx.server_count].port = server->port ? server->port : ctx.config.server_port;
+            ctx.server_count++;
+        }
+    }
+    if (ctx.server_count == 0) {
+        ctx.servers[0].host = ctx.config.server_url;
+        ctx.servers[0].port = ctx.config.server_port;
+        ctx.server_count = 1;
+    }
+
     if (ctx.config.connect_timeout_ms == 0) {
         ctx.config.connect_timeout_ms = 30000;
     }
@@ -91,10 +361,37 @@ bool sinricpro_init(const sinricpro_config_t *config) {
     if (ctx.config.reconnect_delay_ms == 0) {
         ctx.config.reconnect_delay_ms = SINRICPRO_WEBSOCKET_RECONNECT_DELAY_MS;
     }
+#if SINRICPRO_MULTICORE
+    if (ctx.config.express_dispatch) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] express_dispatch is ignored with SINRICPRO_MULTICORE\n");
+        ctx.config.express_dispatch = false;
+    }
+#else
+    // The whole request path then runs on top of lwIP and mbedTLS
+    if (ctx.config.express_dispatch && PICO_STACK_SIZE < SINRICPRO_EXPRESS_STACK_SIZE) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] express_dispatch needs PICO_STACK_SIZE >= %u, ignored\n",
+                              (unsigned)SINRICPRO_EXPRESS_STACK_SIZE);
+        ctx.config.express_dispatch = false;
+    }
+#endif
 
     // Initialize queues
     sinricpro_queue_init(&ctx.rx_queue);
     sinricpro_queue_init(&ctx.tx_queue);
+    sinricpro_event_ring_init(&event_ring);
+#if SINRICPRO_MULTICORE
+    if (!registry_lock) {
+        registry_lock = spin_lock_instance(spin_lock_claim_unused(true));
+    }
+#endif
+    sinricpro_sched_init(&ctx.event_sched);
+    sinricpro_inflight_init(&ctx.inflight);
+    sinricpro_restore_init(&ctx.restore);
+#if SINRICPRO_JOURNAL_ENABLED
+    sinricpro_journal_init(&ctx.journal);
+    sinricpro_event_limiter_init_bucket(&ctx.journal_replay,
+                                        SINRICPRO_JOURNAL_REPLAY_INTERVAL_MS, 1);
+#endif
 
     // Initialize WebSocket client
     sinricpro_ws_init();
@@ -119,8 +416,7 @@ bool sinricpro_begin(void) {
     }
 
     // Check if WiFi is already connected
-    int wifi_status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
-    if (wifi_status != CYW43_LINK_UP) {
+    if (wifi_link_status() != CYW43_LINK_UP) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] WiFi not connected. Connect to WiFi before calling sinricpro_begin()\n");
         set_state(SINRICPRO_STATE_ERROR);
         return false;
@@ -130,21 +426,20 @@ bool sinricpro_begin(void) {
     set_state(SINRICPRO_STATE_WIFI_CONNECTED);
     SINRICPRO_DEBUG_PRINTF("[SinricPro] WiFi already connected\n");
 
-    // Update device IDs header
-    update_device_ids_header();
-
     // Connect WebSocket
     set_state(SINRICPRO_STATE_WS_CONNECTING);
 
     sinricpro_ws_config_t ws_config = {
-        .host = ctx.config.server_url,
-        .port = ctx.config.server_port,
+        .servers = ctx.servers,
+        .server_count = ctx.server_count,
         .path = "/",
         .use_ssl = ctx.config.use_ssl,
+        .warm_standby = ctx.config.warm_standby,
         .app_key = ctx.config.app_key,
-        .device_ids = ctx.device_ids_header,
+        .device_id_at = device_id_at,
         .platform = SINRICPRO_PLATFORM,
         .sdk_version = SINRICPRO_SDK_VERSION,
+        .restore_states = ctx.config.restore_states,
         .on_message = on_ws_message,
         .on_state_change = on_ws_state,
         .user_data = NULL,
@@ -154,92 +449,194 @@ bool sinricpro_begin(void) {
         .enable_debug = ctx.config.enable_debug
     };
 
+#if SINRICPRO_MULTICORE
+    // lwIP is polled from core 1 only, so the connect happens there
+    ctx.ws_config = ws_config;
+    return core1_post(CORE1_CONNECT);
+#else
     return sinricpro_ws_connect(&ws_config);
+#endif
 }
 
 void sinricpro_handle(void) {
-    if (!sdk_initialized) return;
-
-    // Handle WebSocket
-    sinricpro_ws_handle();
-
-    // Process received messages
-    char message[SINRICPRO_MAX_MESSAGE_SIZE];
-    size_t length;
-    sinricpro_interface_t interface;
+    handle_work(0, false);
+}
 
-    while (sinricpro_queue_pop(&ctx.rx_queue, &interface, message,
-                               sizeof(message), &length)) {
-        process_incoming_message(message, length);
-    }
+size_t sinricpro_handle_budget(uint32_t budget_us) {
+    if (!sdk_initialized) return 0;
 
-    // Send queued messages
-    if (sinricpro_ws_is_connected()) {
-        while (sinricpro_queue_pop(&ctx.tx_queue, &interface, message,
-                                   sizeof(message), &length)) {
-            sinricpro_ws_send(message, length);
-        }
-    }
+    handle_work(budget_us, true);
+    return work_remaining();
 }
 
 void sinricpro_disconnect(void) {
+    // Closing the pcb from its own receive callback; handle_work() does it
+    if (ctx.express_active) {
+        ctx.disconnect_pending = true;
+        return;
+    }
+
+#if SINRICPRO_MULTICORE
+    core1_post(CORE1_DISCONNECT);
+#else
     sinricpro_ws_disconnect();
+#endif
     set_state(SINRICPRO_STATE_WIFI_CONNECTED);
 }
 
 void sinricpro_stop(void) {
+    if (ctx.express_active) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] sinricpro_stop() called from a device callback, ignored\n");
+        return;
+    }
+
+#if SINRICPRO_MULTICORE
+    // Close the connection and park core 1 before tearing down cyw43
+    if (ctx.core1_launched) {
+        core1_post(CORE1_STOP);
+        while (ctx.core1_request != CORE1_IDLE) {
+            tight_loop_contents();
+        }
+        multicore_reset_core1();
+        ctx.core1_launched = false;
+    }
+    set_state(SINRICPRO_STATE_WIFI_CONNECTED);
+#else
     sinricpro_disconnect();
+#endif
     cyw43_arch_deinit();
+    sinricpro_pending_clear(&ctx.pending);
+    sinricpro_sched_clear(&ctx.event_sched);
+    sinricpro_inflight_clear(&ctx.inflight);
+    sinricpro_restore_clear(&ctx.restore);
+#if SINRICPRO_JOURNAL_ENABLED
+    sinricpro_journal_flush(&ctx.journal);
+#endif
     ctx.wifi_connected = false;
     set_state(SINRICPRO_STATE_DISCONNECTED);
 }
 
+bool sinricpro_set_device_pool(sinricpro_device_pool_t *pool) {
+    if (!pool || !pool->devices || !pool->table ||
+        pool->capacity == 0 || pool->capacity > SINRICPRO_DEVICE_POOL_MAX ||
+        (pool->table_size & (pool->table_size - 1)) != 0 ||
+        pool->table_size < 2 * pool->capacity) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid device pool\n");
+        return false;
+    }
+
+    if (pool->capacity < ctx.device_count) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Device pool smaller than registry\n");
+        return false;
+    }
+
+    // Move already registered devices (positions are unchanged)
+    for (size_t i = 0; i < ctx.device_count; i++) {
+        pool->devices[i] = ctx.devices[i];
+    }
+
+    uint32_t save = registry_lock_begin();
+    ctx.devices = pool->devices;
+    ctx.device_capacity = pool->capacity;
+    ctx.device_table.slots = pool->table;
+    ctx.device_table.size = pool->table_size;
+    sinricpro_device_table_build(&ctx.device_table, ctx.devices, ctx.device_count);
+    registry_lock_end(save);
+
+    return true;
+}
+
 bool sinricpro_add_device(sinricpro_device_t *device) {
-    if (!device || ctx.device_count >= SINRICPRO_MAX_DEVICES) {
+    if (!device || !ctx.devices || ctx.device_count >= ctx.device_capacity) {
         return false;
     }
 
     // Check for duplicate
-    for (size_t i = 0; i < ctx.device_count; i++) {
-        if (strcmp(ctx.devices[i]->device_id, device->device_id) == 0) {
-            SINRICPRO_WARN_PRINTF("[SinricPro] Device %s already registered\n", device->device_id);
-            return false;
-        }
+    if (sinricpro_device_table_find(&ctx.device_table, ctx.devices, &device->key) >= 0) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] Device %s already registered\n", device->device_id);
+        return false;
     }
 
-    ctx.devices[ctx.device_count++] = device;
+    uint32_t save = registry_lock_begin();
+    device->index = (uint8_t)ctx.device_count;
+    ctx.devices[ctx.device_count] = device;
+    sinricpro_device_table_insert(&ctx.device_table, ctx.devices, ctx.device_count);
+    ctx.device_count++;
+    ctx.registry_seq++;
+    registry_lock_end(save);
     SINRICPRO_DEBUG_PRINTF("[SinricPro] Added device: %s\n", device->device_id);
 
+    // Announce to the server once a burst of additions has settled
+    if (ctx.state != SINRICPRO_STATE_DISCONNECTED) {
+        ctx.reannounce_pending = true;
+        ctx.registry_changed_ms = to_ms_since_boot(get_absolute_time());
+    }
+
     return true;
 }
 
 bool sinricpro_remove_device(const char *device_id) {
-    if (!device_id) return false;
+    sinricpro_device_key_t key;
+    if (!device_id || !sinricpro_device_key_from_id(device_id, strlen(device_id), &key)) {
+        return false;
+    }
 
-    for (size_t i = 0; i < ctx.device_count; i++) {
-        if (strcmp(ctx.devices[i]->device_id, device_id) == 0) {
-            // Shift remaining devices
-            for (size_t j = i; j < ctx.device_count - 1; j++) {
-                ctx.devices[j] = ctx.devices[j + 1];
-            }
-            ctx.device_count--;
-            return true;
-        }
+    int found = sinricpro_device_table_find(&ctx.device_table, ctx.devices, &key);
+    if (found < 0) {
+        return false;
     }
 
-    return false;
+    // Its deferred responses can no longer be completed
+    const char *removed_id = ctx.devices[found]->device_id;
+    cJSON *response;
+    while ((response = sinricpro_pending_take_device(&ctx.pending, removed_id)) != NULL) {
+        send_deferred(response, false, NULL);
+    }
+
+    // And its restores will never be applied
+    cJSON *responses;
+    cJSON *request;
+    while ((request = sinricpro_restore_take_device(&ctx.restore, (uint8_t)found,
+                                                    &responses)) != NULL) {
+        answer_restore(responses, false);
+        cJSON_Delete(request);
+    }
+
+    // Move the last device into the freed position
+    size_t last = ctx.device_count - 1;
+    uint32_t save = registry_lock_begin();
+    sinricpro_device_table_remove(&ctx.device_table, ctx.devices, (size_t)found);
+    if ((size_t)found != last) {
+        sinricpro_device_table_move(&ctx.device_table, ctx.devices, last, (size_t)found);
+        ctx.devices[found] = ctx.devices[last];
+        ctx.devices[found]->index = (uint8_t)found;
+    }
+    ctx.devices[last] = NULL;
+    ctx.device_count--;
+    ctx.registry_seq++;
+    registry_lock_end(save);
+
+    // Records keyed by registry position follow the move
+    sinricpro_sched_remove_device(&ctx.event_sched, (uint8_t)found, (uint8_t)last);
+    sinricpro_restore_move_device(&ctx.restore, (uint8_t)last, (uint8_t)found);
+
+    // A snapshot already past the freed position would skip the moved device
+    if ((size_t)found < ctx.snapshot_device) {
+        ctx.snapshot_device = (size_t)found;
+        ctx.snapshot_slot = 0;
+    }
+
+    return true;
 }
 
 sinricpro_device_t *sinricpro_find_device(const char *device_id) {
-    if (!device_id) return NULL;
-
-    for (size_t i = 0; i < ctx.device_count; i++) {
-        if (strcmp(ctx.devices[i]->device_id, device_id) == 0) {
-            return ctx.devices[i];
-        }
+    sinricpro_device_key_t key;
+    if (!device_id || !sinricpro_device_key_from_id(device_id, strlen(device_id), &key)) {
+        return NULL;
     }
 
-    return NULL;
+    int found = sinricpro_device_table_find(&ctx.device_table, ctx.devices, &key);
+    return found >= 0 ? ctx.devices[found] : NULL;
 }
 
 size_t sinricpro_device_count(void) {
@@ -254,11 +651,131 @@ bool sinricpro_is_connected(void) {
     return ctx.state == SINRICPRO_STATE_CONNECTED;
 }
 
+bool sinricpro_get_stats(sinricpro_stats_t *stats) {
+    if (!sdk_initialized || !stats) return false;
+
+    sinricpro_ws_stats_t ws_stats;
+    sinricpro_ws_get_stats(&ws_stats);
+
+    sinricpro_queue_stats_t rx_stats;
+    sinricpro_queue_stats_t tx_stats;
+    sinricpro_queue_get_stats(&ctx.rx_queue, &rx_stats);
+    sinricpro_queue_get_stats(&ctx.tx_queue, &tx_stats);
+
+    memset(stats, 0, sizeof(sinricpro_stats_t));
+    stats->active_server = ws_stats.active_server;
+    stats->standby_ready = ws_stats.standby_state == WS_STANDBY_READY;
+    stats->failovers = ws_stats.failovers;
+    stats->cold_reconnects = ws_stats.cold_reconnects;
+    stats->connect_failures = ws_stats.connect_failures;
+    stats->standby_drops = ws_stats.standby_drops;
+    stats->last_recovery_ms = ws_stats.last_recovery_ms;
+    stats->reannounces = ws_stats.reannounces;
+    stats->rx_latency_avg_us = rx_stats.latency_avg_us;
+    stats->rx_latency_max_us = rx_stats.latency_max_us;
+    stats->rx_dropped = rx_stats.dropped;
+    stats->tx_latency_avg_us = tx_stats.latency_avg_us;
+    stats->tx_latency_max_us = tx_stats.latency_max_us;
+    stats->tx_dropped = tx_stats.dropped;
+    stats->events_posted = event_ring.posted;
+    stats->events_dropped = event_ring.dropped;
+    stats->rx_malformed = ctx.rx_malformed;
+    stats->rx_not_request = ctx.rx_not_request;
+    stats->rx_unknown_device = ctx.rx_unknown_device;
+    stats->rx_unsupported_action = ctx.rx_unsupported_action;
+    stats->rx_rate_limited = ctx.rx_rate_limited;
+    stats->rx_bad_signature = ctx.rx_bad_signature;
+    stats->reply_cache_hits = ctx.response_cache.hits;
+    stats->reply_cache_misses = ctx.response_cache.misses;
+    stats->reply_cache_expired = ctx.response_cache.expired;
+    for (int c = 0; c < SINRICPRO_EVENT_CLASS_COUNT; c++) {
+        const sinricpro_sched_class_stats_t *sched = &ctx.event_sched.classes[c];
+        stats->events_released[c] = sched->released;
+        stats->events_shed[c] = sched->shed;
+        stats->events_coalesced[c] = sched->coalesced;
+        stats->event_delay_avg_ms[c] = sched->released ?
+            (uint32_t)(sched->delay_total_ms / sched->released) : 0;
+        stats->event_delay_max_ms[c] = sched->delay_max_ms;
+    }
+    stats->responses_deferred = ctx.pending.deferred;
+    stats->responses_timed_out = ctx.pending.timed_out;
+    stats->deferrals_rejected = ctx.pending.rejected;
+    stats->responses_dropped = ctx.responses_dropped;
+
+    const sinricpro_clock_t *clock = sinricpro_json_clock();
+    stats->clock_syncs = clock->syncs;
+    stats->clock_steps = clock->steps;
+    stats->clock_drift_ppm = clock->drift_ppb / 1000;
+    stats->clock_last_correction_ms = clock->last_correction_ms;
+
+    const sinricpro_inflight_table_t *inflight = &ctx.inflight;
+    stats->events_acked = ctx.events_acked;
+    stats->events_rejected = ctx.events_rejected;
+    stats->events_retransmitted = inflight->retransmitted;
+    stats->events_superseded = inflight->superseded;
+    stats->events_unanswered = inflight->expired;
+    stats->event_ack_latency_avg_ms = inflight->answered ?
+        (uint32_t)(inflight->latency_total_ms / inflight->answered) : 0;
+    stats->event_ack_latency_max_ms = inflight->latency_max_ms;
+    stats->restores_received = ctx.restore.received;
+    stats->restores_coalesced = ctx.restore.coalesced;
+    stats->restores_applied = ctx.restore.applied;
+    stats->restore_echoes_dropped = ctx.restore_echoes_dropped;
+    stats->snapshots_started = ctx.snapshots_started;
+    stats->snapshot_events = ctx.snapshot_events;
+#if SINRICPRO_JOURNAL_ENABLED
+    stats->journal_appended = ctx.journal.appended;
+    stats->journal_replayed = ctx.journal.replayed;
+    stats->journal_compacted = ctx.journal.compacted;
+    stats->journal_lost = ctx.journal.lost;
+    stats->journal_corrupt = ctx.journal.corrupt;
+#endif
+    stats->requests_express = ctx.requests_express;
+    stats->requests_queued = ctx.requests_queued;
+    memcpy(stats->latency_express, ctx.latency_express, sizeof(stats->latency_express));
+    memcpy(stats->latency_queued, ctx.latency_queued, sizeof(stats->latency_queued));
+    return true;
+}
+
+sinricpro_pending_t sinricpro_defer_response(const sinricpro_device_t *device) {
+    if (!ctx.current_response || device != ctx.current_device) {
+        return SINRICPRO_PENDING_NONE;
+    }
+
+    if (ctx.current_pending == SINRICPRO_PENDING_NONE) {
+        ctx.current_pending = sinricpro_pending_add(&ctx.pending, ctx.current_response,
+                                                    to_ms_since_boot(get_absolute_time()));
+        if (ctx.current_pending == SINRICPRO_PENDING_NONE) {
+            SINRICPRO_WARN_PRINTF("[SinricPro] Too many pending responses, answering now\n");
+        }
+    }
+    return ctx.current_pending;
+}
+
+bool sinricpro_complete_response(sinricpro_pending_t handle, bool success, cJSON *value) {
+    sinricpro_pending_entry_t *entry = sinricpro_pending_find(&ctx.pending, handle);
+
+    // Not from inside the callback that deferred it: that response is still being built
+    if (!entry || entry->response == ctx.current_response) {
+        cJSON_Delete(value);
+        return false;
+    }
+
+    ctx.pending.completed++;
+    send_deferred(sinricpro_pending_release(&ctx.pending, entry), success, value);
+    return true;
+}
+
 void sinricpro_on_state_change(sinricpro_state_callback_t callback, void *user_data) {
     ctx.state_callback = callback;
     ctx.state_callback_data = user_data;
 }
 
+void sinricpro_on_event_delivery(sinricpro_delivery_callback_t callback, void *user_data) {
+    ctx.delivery_callback = callback;
+    ctx.delivery_callback_data = user_data;
+}
+
 bool sinricpro_send_event(const char *device_id, const char *action, cJSON *value_json) {
     if (!device_id || !action) return false;
 
@@ -275,10 +792,70 @@ bool sinricpro_send_event(const char *device_id, const char *action, cJSON *valu
         }
     }
 
-    bool result = send_message(event);
-    cJSON_Delete(event);
+    uint64_t captured_us = ctx.capture_us ? ctx.capture_us : time_us_64();
+    ctx.capture_us = 0;
+
+    return schedule_event(device_position(device_id),
+                          sinricpro_action_from_name(action, strlen(action)), event, captured_us);
+}
+
+void sinricpro_set_capture_time(uint64_t captured_us) {
+    ctx.capture_us = captured_us;
+}
+
+bool sinricpro_publish_snapshot(sinricpro_snapshot_mode_t mode) {
+    if (mode == SINRICPRO_SNAPSHOT_OFF || !sinricpro_is_connected()) return false;
+
+    ctx.snapshot_mode = mode;
+    ctx.snapshot_device = 0;
+    ctx.snapshot_slot = 0;
+    ctx.snapshots_started++;
+    return true;
+}
+
+uint64_t sinricpro_get_time_ms(void) {
+    return sinricpro_json_timestamp_synced() ? sinricpro_json_time_ms(time_us_64()) : 0;
+}
+
+bool sinricpro_post_event(const sinricpro_device_t *device,
+                          sinricpro_action_t action,
+                          const sinricpro_event_value_t *value) {
+    if (!device) {
+        return false;
+    }
+
+    // Only actions create_event_value() can expand
+    switch (action) {
+        case SINRICPRO_ACTION_SET_POWER_STATE:
+        case SINRICPRO_ACTION_SET_POWER_LEVEL:
+        case SINRICPRO_ACTION_SET_BRIGHTNESS:
+        case SINRICPRO_ACTION_SET_COLOR:
+        case SINRICPRO_ACTION_SET_COLOR_TEMPERATURE:
+        case SINRICPRO_ACTION_SET_RANGE_VALUE:
+        case SINRICPRO_ACTION_SET_LOCK_STATE:
+        case SINRICPRO_ACTION_SET_MODE:
+        case SINRICPRO_ACTION_MOTION:
+        case SINRICPRO_ACTION_CONTACT:
+        case SINRICPRO_ACTION_DOORBELL_PRESS:
+        case SINRICPRO_ACTION_CURRENT_TEMPERATURE:
+        case SINRICPRO_ACTION_AIR_QUALITY:
+            break;
+        default:
+            return false;
+    }
 
-    return result;
+    sinricpro_event_desc_t desc;
+    desc.device = device;
+    desc.device_index = device->index;
+    desc.action = (uint8_t)action;
+    desc.captured_us = time_us_64();
+    if (value) {
+        desc.value = *value;
+    } else {
+        memset(&desc.value, 0, sizeof(desc.value));
+    }
+
+    return sinricpro_event_ring_post(&event_ring, &desc);
 }
 
 const char *sinricpro_get_version(void) {
@@ -303,27 +880,126 @@ static void set_state(sinricpro_state_t new_state) {
     }
 }
 
-static void update_device_ids_header(void) {
-    ctx.device_ids_header[0] = '\0';
+static void check_reannounce(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
 
-    for (size_t i = 0; i < ctx.device_count; i++) {
-        if (i > 0) {
-            strcat(ctx.device_ids_header, ";");
-        }
-        strcat(ctx.device_ids_header, ctx.devices[i]->device_id);
+    // The list the server got mixes registry states
+    uint32_t stale = ctx.stale_announces;
+    if (stale != ctx.stale_announces_seen) {
+        ctx.stale_announces_seen = stale;
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Registry changed during handshake\n");
+        ctx.reannounce_pending = true;
+        ctx.registry_changed_ms = now;
+    }
+
+    if (!ctx.reannounce_pending) return;
+    if ((now - ctx.registry_changed_ms) < SINRICPRO_REANNOUNCE_DELAY_MS) {
+        return;
+    }
+
+    ctx.reannounce_pending = false;
+    SINRICPRO_DEBUG_PRINTF("[SinricPro] Announcing %u devices\n", (unsigned)ctx.device_count);
+#if SINRICPRO_MULTICORE
+    core1_post(CORE1_REANNOUNCE);
+#else
+    sinricpro_ws_reannounce();
+#endif
+}
+
+// Copied under the lock: a removal may free the device right after. The
+// list is streamed one ID per call, so a change between calls is flagged
+static bool device_id_at(size_t index, char *id, size_t size, void *user_data) {
+    uint32_t save = registry_lock_begin();
+    if (index == 0) {
+        ctx.announced_seq = ctx.registry_seq;
+    } else if (ctx.announced_seq != ctx.registry_seq) {
+        ctx.announced_seq = ctx.registry_seq;
+        ctx.stale_announces++;
+    }
+
+    const sinricpro_device_t *device = index < ctx.device_count ? ctx.devices[index] : NULL;
+    if (device) {
+        size_t len = strnlen(device->device_id, size - 1);
+        memcpy(id, device->device_id, len);
+        id[len] = '\0';
     }
+    registry_lock_end(save);
+    return device != NULL;
+}
+
+// With SINRICPRO_MULTICORE, core 1 reads the registry while streaming the
+// handshake; core 0 holds this lock while changing it
+static uint32_t registry_lock_begin(void) {
+#if SINRICPRO_MULTICORE
+    return registry_lock ? spin_lock_blocking(registry_lock) : 0;
+#else
+    return 0;
+#endif
+}
+
+static void registry_lock_end(uint32_t save) {
+#if SINRICPRO_MULTICORE
+    if (registry_lock) spin_unlock(registry_lock, save);
+#else
+    (void)save;
+#endif
 }
 
 static void on_ws_message(const char *message, size_t length, void *user_data) {
+    if (express_ready()) {
+        // Handle the request here and write the response before returning
+        ctx.express_active = true;
+        ctx.request_arrival_us = time_us_32();
+        process_incoming_message(message, length);
+        ctx.express_active = false;
+        return;
+    }
+
     // Queue message for processing
     sinricpro_queue_push(&ctx.rx_queue, SINRICPRO_IF_WEBSOCKET, message, length);
 }
 
+// Express dispatch is only safe when the response can be written from this
+// callback (not nested in a write) and nothing queued would be overtaken
+static bool express_ready(void) {
+#if SINRICPRO_MULTICORE
+    return false;
+#else
+    return ctx.config.express_dispatch && !ctx.express_active &&
+           sinricpro_queue_is_empty(&ctx.rx_queue) &&
+           sinricpro_queue_is_empty(&ctx.tx_queue) &&
+           sinricpro_ws_can_send_now();
+#endif
+}
+
 static void on_ws_state(sinricpro_ws_state_t ws_state, void *user_data) {
+#if SINRICPRO_MULTICORE
+    // Called on core 1: user callbacks must run on core 0
+    ctx.ws_state = ws_state;
+    __dmb();
+    ctx.ws_state_seq++;
+#else
+    apply_ws_state(ws_state);
+#endif
+}
+
+static void apply_ws_state(sinricpro_ws_state_t ws_state) {
     switch (ws_state) {
         case WS_STATE_CONNECTED:
+            // Responses to events sent before the drop may have been lost
+            sinricpro_inflight_mark_resend(&ctx.inflight);
+            if (ctx.config.restore_states) {
+                // The server follows the handshake with each device's state
+                ctx.restore_window = true;
+                ctx.restore_until_ms = to_ms_since_boot(get_absolute_time()) +
+                                       SINRICPRO_RESTORE_WINDOW_MS;
+                ctx.restore_sourced = false;
+            }
             set_state(SINRICPRO_STATE_CONNECTED);
             SINRICPRO_DEBUG_PRINTF("[SinricPro] Connected to server\n");
+            if (ctx.config.snapshot_on_connect != SINRICPRO_SNAPSHOT_OFF) {
+                sinricpro_publish_snapshot(ctx.config.snapshot_on_connect);
+            }
             break;
 
         case WS_STATE_DISCONNECTED:
@@ -340,7 +1016,269 @@ static void on_ws_state(sinricpro_ws_state_t ws_state, void *user_data) {
     }
 }
 
+static void handle_work(uint32_t budget_us, bool limited) {
+    if (!sdk_initialized) return;
+
+    // From a device callback: the buffers and the pcb are in use
+    if (ctx.handling || ctx.express_active) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] sinricpro_handle() called from a device callback, ignored\n");
+        return;
+    }
+    ctx.handling = true;
+
+    uint32_t start = time_us_32();
+
+    // A capture time set for an event that was never sent doesn't carry over
+    ctx.capture_us = 0;
+
+#if SINRICPRO_MULTICORE
+    // Network runs on core 1; pick up its latest state change here
+    uint32_t seq = ctx.ws_state_seq;
+    if (seq != ctx.ws_state_seen) {
+        ctx.ws_state_seen = seq;
+        __dmb();
+        apply_ws_state(ctx.ws_state);
+    }
+#else
+    // Handle WebSocket
+    sinricpro_ws_handle();
+#endif
+
+    if (ctx.disconnect_pending) {
+        ctx.disconnect_pending = false;
+        sinricpro_disconnect();
+    }
+
+    check_reannounce();
+
+    // Timeouts and other upkeep, then received messages, posted events and
+    // queued frames. At least one unit runs per call so a small budget
+    // still makes progress
+    int events = 0;
+    bool progressed = false;
+    work_phase_t phase = ctx.work_phase;
+
+    while (phase != WORK_DONE) {
+        if (limited && progressed && (time_us_32() - start) >= budget_us) {
+            break;
+        }
+
+        if (do_work(phase, work_buffer, sizeof(work_buffer), &events)) {
+            progressed = true;
+        } else {
+            phase++;
+        }
+    }
+    ctx.work_phase = phase == WORK_DONE ? WORK_TIMEOUTS : phase;
+    ctx.handling = false;
+}
+
+// One unit of the given phase; false when the phase has nothing left
+static bool do_work(work_phase_t phase, char *buffer, size_t buffer_size, int *events) {
+    size_t length;
+    sinricpro_interface_t interface;
+
+    switch (phase) {
+        case WORK_TIMEOUTS:
+            return expire_pending_response();
+
+        case WORK_UNANSWERED:
+            return expire_unanswered_event();
+
+        case WORK_HELD:
+            return flush_deferred_events();
+
+        case WORK_RESTORE:
+            return apply_restored_state();
+
+        case WORK_SNAPSHOT:
+            return publish_snapshot();
+
+        case WORK_JOURNAL:
+#if SINRICPRO_JOURNAL_ENABLED
+            return replay_journal();
+#else
+            return false;
+#endif
+
+        case WORK_RECEIVE:
+            if (!sinricpro_queue_pop(&ctx.rx_queue, &interface, buffer,
+                                     buffer_size, &length)) {
+                return false;
+            }
+            ctx.request_arrival_us = ctx.rx_queue.last_enqueued_us;
+            process_incoming_message(buffer, length);
+            return true;
+
+        case WORK_EVENTS:
+            // Expand events posted from IRQs / the other core
+            if (*events >= SINRICPRO_EVENT_BATCH || !expand_posted_event()) {
+                return false;
+            }
+            (*events)++;
+            return true;
+
+        case WORK_SCHEDULE:
+            return release_scheduled_event();
+
+        case WORK_TRANSMIT:
+#if SINRICPRO_MULTICORE
+            return false;
+#else
+            return transmit_one(buffer, buffer_size);
+#endif
+
+        default:
+            return false;
+    }
+}
+
+static size_t work_remaining(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    size_t remaining = sinricpro_pending_expired_count(&ctx.pending, now) +
+                       sinricpro_restore_count(&ctx.restore) +
+                       sinricpro_queue_count(&ctx.rx_queue) +
+                       sinricpro_event_ring_count(&event_ring);
+    if (ctx.deferred_scan && ctx.deferred_device < ctx.device_count) {
+        remaining += ctx.device_count - ctx.deferred_device;
+    }
+    if (sinricpro_is_connected()) {
+        remaining += sinricpro_inflight_expired_count(&ctx.inflight, now);
+        if (ctx.snapshot_mode != SINRICPRO_SNAPSHOT_OFF) {
+            remaining += ctx.snapshot_device < ctx.device_count ?
+                         ctx.device_count - ctx.snapshot_device : 1;
+        }
+#if SINRICPRO_JOURNAL_ENABLED
+        if (sinricpro_journal_pending(&ctx.journal) && sinricpro_json_timestamp_synced()) {
+            remaining++;
+        }
+#endif
+    }
+    if (sinricpro_is_connected() &&
+        sinricpro_queue_count(&ctx.tx_queue) < SINRICPRO_TX_EVENT_DEPTH) {
+        remaining += sinricpro_inflight_resend_count(&ctx.inflight, now);
+        if (!sinricpro_inflight_full(&ctx.inflight) &&
+            sinricpro_event_limiter_time_remaining(&ctx.event_sched.budget) == 0) {
+            remaining += sinricpro_sched_count(&ctx.event_sched);
+        }
+    }
+#if !SINRICPRO_MULTICORE
+    if (sinricpro_ws_is_connected()) {
+        remaining += sinricpro_queue_count(&ctx.tx_queue);
+    }
+#endif
+    return remaining;
+}
+
+static bool transmit_one(char *buffer, size_t buffer_size) {
+    size_t length;
+    sinricpro_interface_t interface;
+
+    if (!sinricpro_ws_is_connected()) return false;
+
+    if (!sinricpro_queue_pop(&ctx.tx_queue, &interface, buffer,
+                             buffer_size, &length)) {
+        return false;
+    }
+    sinricpro_ws_send(buffer, length);
+    return true;
+}
+
+#if SINRICPRO_MULTICORE
+static uint32_t core1_stack[SINRICPRO_CORE1_STACK_SIZE / sizeof(uint32_t)];
+
+static void flush_tx_queue(char *buffer, size_t buffer_size) {
+    while (transmit_one(buffer, buffer_size)) {
+    }
+}
+
+static bool core1_post(core1_request_t request) {
+    if (!ctx.core1_launched) {
+        ctx.core1_request = CORE1_IDLE;
+        multicore_launch_core1_with_stack(core1_main, core1_stack, sizeof(core1_stack));
+        ctx.core1_launched = true;
+    }
+
+    // One request at a time; core 1 clears it on the next loop iteration
+    while (ctx.core1_request != CORE1_IDLE) {
+        tight_loop_contents();
+    }
+
+    __dmb();
+    ctx.core1_request = request;
+    return true;
+}
+
+// Network core: cyw43 polling, lwIP, TLS and the WebSocket transport
+static void core1_main(void) {
+    // Static: the core 1 stack is reserved for mbedTLS
+    static char tx_buffer[SINRICPRO_MAX_MESSAGE_SIZE];
+
+#if SINRICPRO_JOURNAL_ENABLED
+    // Lets core 0 pause this core while it writes the journal
+    flash_safe_execute_core_init();
+#endif
+
+    while (true) {
+        core1_request_t request = ctx.core1_request;
+
+        if (request != CORE1_IDLE) {
+            __dmb();
+            if (request == CORE1_CONNECT) {
+                sinricpro_ws_connect(&ctx.ws_config);
+            } else if (request == CORE1_REANNOUNCE) {
+                sinricpro_ws_reannounce();
+            } else if (request == CORE1_LINK_STATUS) {
+                ctx.link_status = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+                __dmb();
+                ctx.link_status_seq++;
+            } else {
+                sinricpro_ws_disconnect();
+            }
+            ctx.core1_request = CORE1_IDLE;
+
+            if (request == CORE1_STOP) {
+                // Wait for multicore_reset_core1()
+                while (true) {
+                    tight_loop_contents();
+                }
+            }
+        }
+
+        sinricpro_ws_handle();
+        flush_tx_queue(tx_buffer, sizeof(tx_buffer));
+    }
+}
+#endif
+
+// CYW43_LINK_* of the station interface. Once core 1 runs it owns the
+// driver, so it reads the status and hands it over
+static int wifi_link_status(void) {
+#if SINRICPRO_MULTICORE
+    if (ctx.core1_launched) {
+        uint32_t seq = ctx.link_status_seq;
+        core1_post(CORE1_LINK_STATUS);
+        while (ctx.link_status_seq == seq) {
+            tight_loop_contents();
+        }
+        __dmb();
+        return ctx.link_status;
+    }
+#endif
+    return cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+}
+
 static void process_incoming_message(const char *message, size_t length) {
+    // Drop what can't be for us before paying for parsing and HMAC
+    sinricpro_prescan_t scan;
+    if (!prefilter_message(message, length, &scan)) {
+        return;
+    }
+
+    if (!is_event_response(&scan) && answer_from_cache(message, &scan)) {
+        return;
+    }
+
     // Parse JSON
     cJSON *json = cJSON_ParseWithLength(message, length);
     if (!json) {
@@ -352,18 +1290,22 @@ static void process_incoming_message(const char *message, size_t length) {
     // Format: {"timestamp": 1767667003}
     cJSON *timestamp_item = cJSON_GetObjectItem(json, "timestamp");
     if (timestamp_item && cJSON_IsNumber(timestamp_item)) {
-        uint32_t server_timestamp = (uint32_t)cJSON_GetNumberValue(timestamp_item);
-        sinricpro_json_set_timestamp_offset(server_timestamp);
-        SINRICPRO_DEBUG_PRINTF("[SinricPro] Server time synced: %lu\n", (unsigned long)server_timestamp);
+        // Taken at arrival, not after waiting in the receive queue
+        uint64_t arrived_us = time_us_64() - (uint32_t)(time_us_32() - ctx.request_arrival_us);
+        sinricpro_json_sync_clock(cJSON_GetNumberValue(timestamp_item), arrived_us);
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Server time synced: %lu (correction %ld ms)\n",
+                               (unsigned long)sinricpro_json_get_timestamp(),
+                               (long)sinricpro_json_clock()->last_correction_ms);
         cJSON_Delete(json);
         return;
     }
 
     // Verify signature for normal messages
     const char *signature = sinricpro_json_get_signature(json);
-    if (!signature || !sinricpro_verify_signature(ctx.config.app_secret,
-                                                   message, signature)) {
+    if (!signature || !sinricpro_verify_signature(ctx.config.app_secret, message, signature,
+                                                   sign_buffer, sizeof(sign_buffer))) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid signature\n");
+        ctx.rx_bad_signature++;
         cJSON_Delete(json);
         return;
     }
@@ -377,26 +1319,172 @@ static void process_incoming_message(const char *message, size_t length) {
 
     if (strcmp(type, SINRICPRO_TYPE_REQUEST) == 0) {
         process_request(json);
+    } else if (strcmp(type, SINRICPRO_TYPE_RESPONSE) == 0) {
+        process_event_response(json);
     }
-    // Response and event types are typically not received from server
 
     cJSON_Delete(json);
 }
 
-static void process_request(cJSON *message) {
-    const char *device_id = sinricpro_json_get_device_id(message);
-    const char *action = sinricpro_json_get_action(message);
-
-    if (!device_id || !action) {
-        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid request: missing deviceId or action\n");
-        return;
+static bool prefilter_message(const char *message, size_t length, sinricpro_prescan_t *scan) {
+    if (!sinricpro_prescan(message, length, scan)) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Dropped malformed message\n");
+        ctx.rx_malformed++;
+        return false;
     }
 
-    SINRICPRO_DEBUG_PRINTF("[SinricPro] Request: %s -> %s\n", device_id, action);
+    // Control messages (the timestamp sent on connect) have no payload;
+    // responses to our events skip the request checks
+    if (scan->has_payload && !is_event_response(scan)) {
+        size_t request_len = strlen(SINRICPRO_TYPE_REQUEST);
+        if (!scan->type || scan->type_len != request_len ||
+            memcmp(scan->type, SINRICPRO_TYPE_REQUEST, request_len) != 0) {
+            ctx.rx_not_request++;
+            return false;
+        }
 
-    // Find device
-    sinricpro_device_t *device = sinricpro_find_device(device_id);
-    if (!device) {
+        sinricpro_device_key_t key;
+        int found = -1;
+        if (scan->device_id &&
+            sinricpro_device_key_from_id(scan->device_id, scan->device_id_len, &key)) {
+            found = sinricpro_device_table_find(&ctx.device_table, ctx.devices, &key);
+        }
+        if (found < 0) {
+            SINRICPRO_DEBUG_PRINTF("[SinricPro] Dropped request for unknown device\n");
+            ctx.rx_unknown_device++;
+            return false;
+        }
+
+        // Custom handle_request devices may accept actions outside the vocabulary
+        sinricpro_device_t *device = ctx.devices[found];
+        sinricpro_action_t action = scan->action
+            ? sinricpro_action_from_name(scan->action, scan->action_len)
+            : SINRICPRO_ACTION_UNKNOWN;
+        bool supported = scan->action &&
+            ((device->model && sinricpro_device_has_action(device, action)) ||
+             (device->actions && action != SINRICPRO_ACTION_UNKNOWN && device->actions[action]) ||
+             device->handle_request);
+        if (!supported) {
+            SINRICPRO_DEBUG_PRINTF("[SinricPro] Dropped unsupported action for %s\n",
+                                   device->device_id);
+            ctx.rx_unsupported_action++;
+            return false;
+        }
+
+        // Only requests are limited: event acks and the timestamp always get in
+        if (!rx_admit(to_ms_since_boot(get_absolute_time()))) {
+            ctx.rx_rate_limited++;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The server's answer to an event still awaiting one
+static bool is_event_response(const sinricpro_prescan_t *scan) {
+    size_t response_len = strlen(SINRICPRO_TYPE_RESPONSE);
+    return scan->type && scan->type_len == response_len &&
+           memcmp(scan->type, SINRICPRO_TYPE_RESPONSE, response_len) == 0 &&
+           sinricpro_inflight_has_token(&ctx.inflight, scan->reply_token, scan->reply_token_len);
+}
+
+// Token bucket: SINRICPRO_RX_BURST deep, refilled at SINRICPRO_RX_RATE_PER_SEC
+static bool rx_admit(uint32_t now) {
+    return !sinricpro_event_limiter_check_at(&ctx.rx_limiter, now);
+}
+
+// A retried request gets the response already sent, without running the
+// device again. The retry is still authenticated.
+static bool answer_from_cache(const char *message, const sinricpro_prescan_t *scan) {
+    if (!scan->reply_token) return false;
+
+    // The device is still acting on it (or will once the restore is
+    // applied); the deferred response will answer
+    if (sinricpro_pending_has_token(&ctx.pending, scan->reply_token, scan->reply_token_len) ||
+        sinricpro_restore_has_token(&ctx.restore, scan->reply_token, scan->reply_token_len)) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Retried request still pending, dropped\n");
+        return true;
+    }
+
+    const sinricpro_cached_response_t *cached = sinricpro_response_cache_find(
+        &ctx.response_cache, scan->reply_token, scan->reply_token_len,
+        to_ms_since_boot(get_absolute_time()));
+    if (!cached) return false;
+
+    char signature[SINRICPRO_SIGNATURE_MAX_LEN];
+    if (!scan->hmac || scan->hmac_len >= sizeof(signature)) {
+        ctx.rx_bad_signature++;
+        return true;
+    }
+    memcpy(signature, scan->hmac, scan->hmac_len);
+    signature[scan->hmac_len] = '\0';
+
+    if (!sinricpro_verify_signature(ctx.config.app_secret, message, signature,
+                                    sign_buffer, sizeof(sign_buffer))) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid signature\n");
+        ctx.rx_bad_signature++;
+        return true;
+    }
+
+    SINRICPRO_DEBUG_PRINTF("[SinricPro] Retried request %s, resending response\n",
+                           cached->reply_token);
+    send_response(cached->frame, cached->frame_len);
+    return true;
+}
+
+// Written directly when handling a request in the receive callback (the
+// queue is empty then, so order is kept), queued otherwise
+static void send_response(const char *frame, size_t length) {
+    uint32_t latency = time_us_32() - ctx.request_arrival_us;
+
+    if (ctx.express_active && sinricpro_ws_send(frame, length)) {
+        ctx.requests_express++;
+        record_latency(ctx.latency_express, latency);
+        return;
+    }
+
+    if (queue_response(frame, length)) {
+        ctx.requests_queued++;
+        record_latency(ctx.latency_queued, latency);
+    }
+}
+
+// Responses rank above events: release_scheduled_event() keeps at most
+// SINRICPRO_TX_EVENT_DEPTH frames queued, so a response finds room and
+// waits behind only those
+static bool queue_response(const char *frame, size_t length) {
+    if (!sinricpro_queue_push(&ctx.tx_queue, SINRICPRO_IF_WEBSOCKET, frame, length)) {
+        ctx.responses_dropped++;
+        SINRICPRO_WARN_PRINTF("[SinricPro] Transmit queue full, response dropped\n");
+        return false;
+    }
+    return true;
+}
+
+// Log2 buckets from 0.5 ms, see SINRICPRO_LATENCY_BUCKETS
+static void record_latency(uint32_t *histogram, uint32_t latency_us) {
+    size_t bucket = 0;
+    for (uint32_t t = latency_us / 500; t && bucket < SINRICPRO_LATENCY_BUCKETS - 1; t >>= 1) {
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+
+static void process_request(cJSON *message) {
+    const char *device_id = sinricpro_json_get_device_id(message);
+    const char *action = sinricpro_json_get_action(message);
+
+    if (!device_id || !action) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid request: missing deviceId or action\n");
+        return;
+    }
+
+    SINRICPRO_DEBUG_PRINTF("[SinricPro] Request: %s -> %s\n", device_id, action);
+
+    // Find device
+    sinricpro_device_t *device = sinricpro_find_device(device_id);
+    if (!device) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] Device not found: %s\n", device_id);
         return;
     }
@@ -408,13 +1496,224 @@ static void process_request(cJSON *message) {
         return;
     }
 
-    // Handle request via device's request handler
+    sinricpro_action_t action_id = sinricpro_action_from_name(action, strlen(action));
+
+    // Owned by the restore table until applied
+    if (park_restore(device, action_id, message, response)) {
+        return;
+    }
+
+    // A live request replaces a restore of the same property still waiting
+    cJSON *responses = NULL;
+    cJSON *stale = action_id != SINRICPRO_ACTION_UNKNOWN ?
+                   sinricpro_restore_take_action(&ctx.restore, device->index, action_id, &responses) :
+                   NULL;
+    if (stale) {
+        answer_restore(responses, false);
+        cJSON_Delete(stale);
+    }
+
+    // Let the callback defer the response
+    ctx.current_response = response;
+    ctx.current_device = device;
+    ctx.current_pending = SINRICPRO_PENDING_NONE;
+
+    bool success = dispatch_request(device, action_id, action, message, response);
+
+    sinricpro_pending_t deferred = ctx.current_pending;
+    ctx.current_response = NULL;
+    ctx.current_device = NULL;
+    ctx.current_pending = SINRICPRO_PENDING_NONE;
+
+    if (deferred != SINRICPRO_PENDING_NONE) {
+        // Owned by the pending table until completed or timed out
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Response to %s deferred\n", action);
+        return;
+    }
+
+    size_t frame_len = finish_response(response, success, frame_buffer, sizeof(frame_buffer));
+    if (frame_len > 0) {
+        send_response(frame_buffer, frame_len);
+    }
+    cJSON_Delete(response);
+}
+
+// Resolve the action once: composed devices route it to a capability,
+// others dispatch through their own table
+static bool dispatch_request(sinricpro_device_t *device, sinricpro_action_t action_id,
+                             const char *action, cJSON *message, cJSON *response) {
     bool success = false;
-    if (device->handle_request) {
-        success = device->handle_request(device, action, message, response);
+    bool routed = false;
+    if (device->model) {
+        success = sinricpro_device_route_request(device, action_id, message, response, &routed);
+    }
+
+    if (!routed) {
+        sinricpro_action_handler_t handler = NULL;
+        if (device->actions && action_id != SINRICPRO_ACTION_UNKNOWN) {
+            handler = device->actions[action_id];
+        }
+
+        if (handler) {
+            success = handler(device, message, response);
+        } else if (device->handle_request) {
+            success = device->handle_request(device, action, message, response);
+        } else {
+            SINRICPRO_WARN_PRINTF("[SinricPro] Unknown action: %s\n", action);
+        }
     }
 
-    // Update success flag in response
+    // The server set this value itself
+    if (success && action_id != SINRICPRO_ACTION_UNKNOWN) {
+        device->unacked_actions &= ~(1u << action_id);
+    }
+    return success;
+}
+
+// Right after connecting, requests restore the server's last state: keep
+// them, with their responses, for apply_restored_state(). They can't be
+// told apart from user commands, so every request in the window waits.
+// False when the request is handled normally (window closed, table full)
+static bool park_restore(sinricpro_device_t *device, sinricpro_action_t action_id,
+                         cJSON *message, cJSON *response) {
+    if (!ctx.restore_window) return false;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    cJSON *payload = cJSON_GetObjectItem(message, "payload");
+    const char *source = sinricpro_json_get_string(payload, "clientId", "");
+    if (!is_restore(device, action_id, source, now)) {
+        ctx.restore_window = false;
+        return false;
+    }
+
+    cJSON *request = cJSON_CreateObject();
+    if (!payload || !request ||
+        !cJSON_AddItemToObject(request, "payload", cJSON_Duplicate(payload, true)) ||
+        !sinricpro_restore_add(&ctx.restore, request, response, device->index, action_id)) {
+        cJSON_Delete(request);
+        return false;
+    }
+    if (!ctx.restore_sourced) {
+        snprintf(ctx.restore_source, sizeof(ctx.restore_source), "%s", source);
+        ctx.restore_sourced = true;
+    }
+    ctx.restore_last_ms = now;
+    ctx.restore_applying = false;
+    return true;
+}
+
+// Whether a request in the restore window is one of the server's restores.
+// The first that isn't ends the window: one arriving after
+// SINRICPRO_RESTORE_WINDOW_MS, from another source (payload clientId) than
+// the first restore, for a property already restored (the server sends
+// each once), or for an action with no state to restore
+static bool is_restore(const sinricpro_device_t *device, sinricpro_action_t action_id,
+                       const char *source, uint32_t now) {
+    if ((int32_t)(now - ctx.restore_until_ms) >= 0) return false;
+    if (action_id == SINRICPRO_ACTION_UNKNOWN) return false;
+
+    if (ctx.restore_sourced &&
+        strncmp(source, ctx.restore_source, sizeof(ctx.restore_source) - 1) != 0) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Request from %s ends the restore window\n", source);
+        return false;
+    }
+    if (sinricpro_restore_has(&ctx.restore, device->index, action_id) ||
+        (device->restored_actions & (1u << action_id))) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Repeated request ends the restore window\n");
+        return false;
+    }
+    return true;
+}
+
+// Answer every request a restore stands for with the outcome of applying
+// it. The last response is the applied request's own; earlier ones were
+// replaced by it and report the value it left.
+static void answer_restore(cJSON *responses, bool success) {
+    cJSON *applied = cJSON_DetachItemFromArray(responses, cJSON_GetArraySize(responses) - 1);
+    const cJSON *value = cJSON_GetObjectItem(cJSON_GetObjectItem(applied, "payload"), "value");
+
+    cJSON *response;
+    while ((response = cJSON_DetachItemFromArray(responses, 0)) != NULL) {
+        send_deferred(response, success, value ? cJSON_Duplicate(value, true) : NULL);
+    }
+    if (applied) {
+        send_deferred(applied, success, NULL);
+    }
+    cJSON_Delete(responses);
+}
+
+// Apply a restored state once the burst settles, one property per interval
+// in registry order, and end echo suppression when its window closes.
+// False when none is due
+static bool apply_restored_state(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    if (ctx.restore_echo && (int32_t)(now - ctx.restore_echo_until_ms) >= 0) {
+        ctx.restore_echo = false;
+        for (size_t i = 0; i < ctx.device_count; i++) {
+            ctx.devices[i]->restored_actions = 0;
+        }
+    }
+
+    if (sinricpro_restore_count(&ctx.restore) == 0) return false;
+
+    uint32_t wait = ctx.restore_applying ? SINRICPRO_RESTORE_APPLY_INTERVAL_MS :
+                                           SINRICPRO_RESTORE_SETTLE_MS;
+    if (now - ctx.restore_last_ms < wait) return false;
+
+    sinricpro_action_t action_id;
+    cJSON *responses = NULL;
+    cJSON *request = sinricpro_restore_take(&ctx.restore, &action_id, &responses);
+    ctx.restore_last_ms = now;
+    ctx.restore_applying = true;
+
+    // Removed devices take their restores with them; checked all the same
+    const char *device_id = sinricpro_json_get_device_id(request);
+    const char *action = sinricpro_json_get_action(request);
+    sinricpro_device_t *device = device_id ? sinricpro_find_device(device_id) : NULL;
+    cJSON *response = cJSON_GetArrayItem(responses, cJSON_GetArraySize(responses) - 1);
+
+    bool success = false;
+    if (device && action && response) {
+        // With no current request the callback can't defer; it answers now
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Restore: %s -> %s\n", device_id, action);
+        success = dispatch_request(device, action_id, action, request, response);
+    }
+    if (success) {
+        device->restored_actions |= 1u << action_id;
+        ctx.restore_echo = true;
+        ctx.restore_echo_until_ms = now + SINRICPRO_RESTORE_ECHO_MS;
+    }
+    answer_restore(responses, success);
+    cJSON_Delete(request);
+    return true;
+}
+
+// The server's answer to one of our events
+static void process_event_response(cJSON *message) {
+    const char *token = sinricpro_json_get_reply_token(message);
+    if (!token) return;
+
+    uint32_t latency;
+    cJSON *event = sinricpro_inflight_take(&ctx.inflight, token, strlen(token),
+                                           to_ms_since_boot(get_absolute_time()), &latency);
+    if (!event) return;
+
+    cJSON *payload = cJSON_GetObjectItem(message, "payload");
+    if (sinricpro_json_get_bool(payload, "success", false)) {
+        ctx.events_acked++;
+        report_delivery(event, SINRICPRO_DELIVERY_ACKED, latency);
+    } else {
+        SINRICPRO_WARN_PRINTF("[SinricPro] Event rejected: %s\n",
+                              sinricpro_json_get_string(payload, "message", ""));
+        ctx.events_rejected++;
+        report_delivery(event, SINRICPRO_DELIVERY_REJECTED, latency);
+    }
+}
+
+// Set the outcome, sign and serialize, keeping the frame in case the server
+// retries the request. Returns the frame length, 0 on failure
+static size_t finish_response(cJSON *response, bool success, char *frame, size_t frame_len) {
     cJSON *payload = cJSON_GetObjectItem(response, "payload");
     if (payload) {
         cJSON *success_item = cJSON_GetObjectItem(payload, "success");
@@ -423,46 +1722,540 @@ static void process_request(cJSON *message) {
         }
     }
 
-    // Send response
-    send_message(response);
+    size_t length = serialize_signed(response, frame, frame_len);
+    if (length > 0) {
+        const char *reply_token = sinricpro_json_get_reply_token(response);
+        if (reply_token) {
+            sinricpro_response_cache_store(&ctx.response_cache, reply_token, strlen(reply_token),
+                                           frame, length, to_ms_since_boot(get_absolute_time()));
+        }
+    }
+    return length;
+}
+
+// Completed or timed-out deferred response: stamped now, queued, deleted
+static void send_deferred(cJSON *response, bool success, cJSON *value) {
+    cJSON *payload = cJSON_GetObjectItem(response, "payload");
+    if (payload) {
+        cJSON *created_at = cJSON_GetObjectItem(payload, "createdAt");
+        if (created_at) {
+            cJSON_SetNumberValue(created_at, sinricpro_json_get_timestamp());
+        }
+    }
+    if (value && !(payload && cJSON_ReplaceItemInObject(payload, "value", value))) {
+        cJSON_Delete(value);
+    }
+
+    size_t frame_len = finish_response(response, success, frame_buffer, sizeof(frame_buffer));
+    if (frame_len > 0) {
+        queue_response(frame_buffer, frame_len);
+    }
     cJSON_Delete(response);
 }
 
+// Answer one timed-out deferred response; false when none has timed out
+static bool expire_pending_response(void) {
+    cJSON *response = sinricpro_pending_take_expired(&ctx.pending,
+                                                      to_ms_since_boot(get_absolute_time()));
+    if (!response) return false;
+
+    SINRICPRO_WARN_PRINTF("[SinricPro] Deferred response timed out\n");
+    send_deferred(response, false, NULL);
+    return true;
+}
+
+// Send values held back by capability rate limits once they are allowed,
+// one device per call. A scan starts every SINRICPRO_EVENT_DEFER_SCAN_MS;
+// false when none is in progress or it has finished
+static bool flush_deferred_events(void) {
+    if (!sinricpro_is_connected()) {
+        ctx.deferred_scan = false;
+        return false;
+    }
+
+    if (!ctx.deferred_scan) {
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        if ((now - ctx.last_deferred_scan_ms) < SINRICPRO_EVENT_DEFER_SCAN_MS) return false;
+        ctx.last_deferred_scan_ms = now;
+        ctx.deferred_scan = true;
+        ctx.deferred_device = 0;
+    }
+
+    // A removal mid-scan can skip a device until the next scan
+    if (ctx.deferred_device >= ctx.device_count) {
+        ctx.deferred_scan = false;
+        return false;
+    }
+    sinricpro_device_flush_deferred(ctx.devices[ctx.deferred_device++]);
+    return true;
+}
+
 static bool send_message(cJSON *message) {
-    if (!message) return false;
+    size_t message_len = serialize_signed(message, frame_buffer, sizeof(frame_buffer));
+    if (message_len == 0) {
+        return false;
+    }
+
+    // Queue for sending
+    return sinricpro_queue_push(&ctx.tx_queue, SINRICPRO_IF_WEBSOCKET,
+                                frame_buffer, message_len);
+}
+
+// Journal an event while offline, otherwise queue it for the
+// connection-wide budget (takes ownership)
+static bool schedule_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                           uint64_t captured_us) {
+    if (is_restore_echo(device, action)) {
+        cJSON_Delete(event);
+        return true;
+    }
+    if (device < ctx.device_count && action != SINRICPRO_ACTION_UNKNOWN) {
+        ctx.devices[device]->unacked_actions |= 1u << action;
+    }
+#if SINRICPRO_JOURNAL_ENABLED
+    if (journal_event(device, action, event, captured_us)) {
+        return true;
+    }
+#endif
+    return budget_event(device, action, event, captured_us);
+}
+
+// Queue an event for the connection-wide budget (takes ownership)
+static bool budget_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                         uint64_t captured_us) {
+    if (!sinricpro_sched_add(&ctx.event_sched, event, device, action, captured_us,
+                             to_ms_since_boot(get_absolute_time()))) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] Event budget queue full, event dropped\n");
+        return false;
+    }
+    return true;
+}
+
+// Release one event if the budget allows and it can be sent. Events wait
+// here rather than in the transmit queue, where responses would queue
+// behind them
+static bool release_scheduled_event(void) {
+    if (!sinricpro_is_connected() ||
+        sinricpro_queue_count(&ctx.tx_queue) >= SINRICPRO_TX_EVENT_DEPTH) {
+        return false;
+    }
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    // Unanswered events go again first, unchanged, so the server can
+    // discard a copy it already has. They were paid for on first release.
+    cJSON *event = sinricpro_inflight_next_resend(&ctx.inflight, now);
+    if (event) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Resending unanswered event %s\n",
+                               sinricpro_json_get_reply_token(event));
+        send_message(event);
+        return true;
+    }
+
+    if (sinricpro_inflight_full(&ctx.inflight)) return false;
+
+    uint64_t captured_us;
+    event = sinricpro_sched_next(&ctx.event_sched, now, &captured_us);
+    if (!event) return false;
+
+    // Stamped from the capture time as late as possible, so events measured
+    // before the clock was synced still get server time
+    cJSON *payload = cJSON_GetObjectItem(event, "payload");
+    if (payload && captured_us != SINRICPRO_SCHED_STAMPED) {
+        cJSON_ReplaceItemInObject(payload, "createdAt",
+                                  cJSON_CreateNumber(sinricpro_json_timestamp_of(captured_us)));
+    }
+
+    if (send_message(event)) {
+        track_event(event, now);
+    } else {
+        cJSON_Delete(event);
+    }
+    return true;
+}
+
+// Keep a sent event until the server answers it (takes ownership). An
+// unanswered older value of the same property needn't be sent again.
+static void track_event(cJSON *event, uint32_t now) {
+    const char *device_id = sinricpro_json_get_device_id(event);
+    const char *action = sinricpro_json_get_action(event);
+
+    if (device_id && action &&
+        sinricpro_event_coalesces(sinricpro_action_from_name(action, strlen(action)))) {
+        cJSON *older = sinricpro_inflight_take_superseded(&ctx.inflight, device_id, action);
+        if (older) {
+            report_delivery(older, SINRICPRO_DELIVERY_SUPERSEDED, 0);
+        }
+    }
+
+    if (!sinricpro_inflight_add(&ctx.inflight, event, now)) {
+        cJSON_Delete(event);
+    }
+}
+
+// Give up on one event still unanswered after its last send. Only while
+// connected: time offline doesn't count against an event.
+static bool expire_unanswered_event(void) {
+    if (!sinricpro_is_connected()) return false;
+
+    cJSON *event = sinricpro_inflight_take_expired(&ctx.inflight,
+                                                   to_ms_since_boot(get_absolute_time()));
+    if (!event) return false;
+
+    SINRICPRO_WARN_PRINTF("[SinricPro] Event %s unanswered after %d sends\n",
+                          sinricpro_json_get_reply_token(event), SINRICPRO_EVENT_MAX_ATTEMPTS);
+    report_delivery(event, SINRICPRO_DELIVERY_FAILED, 0);
+    return true;
+}
+
+// Tell the app what became of an event, then delete it
+static void report_delivery(cJSON *event, sinricpro_delivery_status_t status, uint32_t latency_ms) {
+    const char *device_id = sinricpro_json_get_device_id(event);
+    const char *action = sinricpro_json_get_action(event);
+
+    // Whether the server holds this value, for SINRICPRO_SNAPSHOT_CHANGED; a
+    // superseded event's value is covered by the newer one
+    sinricpro_device_t *device = device_id ? sinricpro_find_device(device_id) : NULL;
+    sinricpro_action_t action_id = action ? sinricpro_action_from_name(action, strlen(action)) :
+                                            SINRICPRO_ACTION_UNKNOWN;
+    if (device && action_id != SINRICPRO_ACTION_UNKNOWN) {
+        if (status == SINRICPRO_DELIVERY_ACKED) {
+            device->unacked_actions &= ~(1u << action_id);
+        } else if (status != SINRICPRO_DELIVERY_SUPERSEDED) {
+            device->unacked_actions |= 1u << action_id;
+        }
+    }
+
+    if (ctx.delivery_callback) {
+        ctx.delivery_callback(device_id ? device_id : "", action ? action : "",
+                              status, latency_ms, ctx.delivery_callback_data);
+    }
+    cJSON_Delete(event);
+}
+
+// An event for a property just restored reports the server's own state back
+static bool is_restore_echo(uint8_t device, sinricpro_action_t action) {
+    if (!ctx.restore_echo || device >= ctx.device_count ||
+        action == SINRICPRO_ACTION_UNKNOWN ||
+        !(ctx.devices[device]->restored_actions & (1u << action))) {
+        return false;
+    }
+    ctx.restore_echoes_dropped++;
+    return true;
+}
+
+// Queue the next value of a state snapshot, one capability slot per call.
+// At most half the scheduler is used so live events still get in; the
+// event budget paces the rest. False when nothing can be queued now
+static bool publish_snapshot(void) {
+    if (ctx.snapshot_mode == SINRICPRO_SNAPSHOT_OFF || !sinricpro_is_connected()) return false;
+
+    // Restored states go first: they replace ours
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (sinricpro_restore_count(&ctx.restore) > 0 ||
+        (ctx.restore_window && (int32_t)(now - ctx.restore_until_ms) < 0) ||
+        sinricpro_sched_count(&ctx.event_sched) >= (SINRICPRO_EVENT_SCHED_SLOTS + 1) / 2) {
+        return false;
+    }
+
+    if (ctx.snapshot_device >= ctx.device_count) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] State snapshot published\n");
+        ctx.snapshot_mode = SINRICPRO_SNAPSHOT_OFF;
+        return false;
+    }
+
+    sinricpro_device_t *device = ctx.devices[ctx.snapshot_device];
+    if (!device->model || ctx.snapshot_slot >= device->model->slot_count) {
+        ctx.snapshot_device++;
+        ctx.snapshot_slot = 0;
+        return true;
+    }
+
+    sinricpro_action_t action;
+    sinricpro_event_value_t value;
+    if (!sinricpro_device_snapshot(device, ctx.snapshot_slot++, &action, &value)) return true;
+    if (ctx.snapshot_mode == SINRICPRO_SNAPSHOT_CHANGED &&
+        !(device->unacked_actions & (1u << action))) {
+        return true;
+    }
+
+    if (queue_event_value((uint8_t)ctx.snapshot_device, action, &value, time_us_64())) {
+        ctx.snapshot_events++;
+    }
+    return true;
+}
+
+// Registry position of a posted event's device, or SINRICPRO_SCHED_NO_DEVICE
+// once it is removed. Compares addresses only, so a removed device's memory
+// is never read
+static uint8_t registered_position(const sinricpro_device_t *device, uint8_t hint) {
+    if (hint < ctx.device_count && ctx.devices[hint] == device) {
+        return hint;
+    }
+
+    // Moved by a removal since the post
+    for (size_t i = 0; i < ctx.device_count; i++) {
+        if (ctx.devices[i] == device) return (uint8_t)i;
+    }
+    return SINRICPRO_SCHED_NO_DEVICE;
+}
+
+// Registry position of a device, the scheduler's fairness key
+static uint8_t device_position(const char *device_id) {
+    sinricpro_device_key_t key;
+    if (!sinricpro_device_key_from_id(device_id, strlen(device_id), &key)) {
+        return SINRICPRO_SCHED_NO_DEVICE;
+    }
+
+    int found = sinricpro_device_table_find(&ctx.device_table, ctx.devices, &key);
+    return found >= 0 ? (uint8_t)found : SINRICPRO_SCHED_NO_DEVICE;
+}
+
+#if SINRICPRO_JOURNAL_ENABLED
+// Offline: append the event to the flash journal (takes ownership on success)
+static bool journal_event(uint8_t device, sinricpro_action_t action, cJSON *event,
+                          uint64_t captured_us) {
+    if (device == SINRICPRO_SCHED_NO_DEVICE || action == SINRICPRO_ACTION_UNKNOWN) return false;
+
+    if (sinricpro_is_connected()) {
+        // A live value outdates journaled values of the same property
+        if (sinricpro_journal_pending(&ctx.journal)) {
+            ctx.devices[device]->live_actions |= 1u << action;
+        }
+        return false;
+    }
+
+    cJSON *payload = cJSON_GetObjectItem(event, "payload");
+    cJSON *value = cJSON_GetObjectItem(payload, "value");
+    char text[SINRICPRO_JOURNAL_VALUE_MAX + 8];     // cJSON wants 5 spare bytes
+    if (!value || !cJSON_PrintPreallocated(value, text, sizeof(text), false)) {
+        return false;
+    }
+
+    uint8_t flags = sinricpro_json_timestamp_synced() ? 0 : SINRICPRO_JOURNAL_TIME_SINCE_BOOT;
+    uint32_t created_at = flags ? (uint32_t)(captured_us / 1000000) :
+                                  sinricpro_json_timestamp_of(captured_us);
+    if (!sinricpro_journal_append(&ctx.journal, &ctx.devices[device]->key, action,
+                                  created_at, flags,
+                                  text, strlen(text), to_ms_since_boot(get_absolute_time()))) {
+        return false;
+    }
+
+    cJSON_Delete(event);
+    return true;
+}
+
+// Take the next journaled event once connected with server time, within
+// the replay rate and while the scheduler has room. One entry per call,
+// replayed or skipped; false when none can be taken now
+static bool replay_journal(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    sinricpro_journal_poll(&ctx.journal, now);
+
+    if (!sinricpro_journal_pending(&ctx.journal) || !sinricpro_is_connected() ||
+        !sinricpro_json_timestamp_synced() ||
+        sinricpro_sched_count(&ctx.event_sched) >= SINRICPRO_EVENT_SCHED_SLOTS ||
+        sinricpro_event_limiter_time_remaining(&ctx.journal_replay) > 0) {
+        return false;
+    }
+
+    // Only replayed entries are charged to the replay rate
+    sinricpro_journal_entry_t entry;
+    if (sinricpro_journal_next(&ctx.journal, &entry, now)) {
+        if (replay_entry(&entry)) {
+            sinricpro_event_limiter_check_at(&ctx.journal_replay, now);
+        }
+        return true;
+    }
+
+    // Caught up
+    for (size_t i = 0; i < ctx.device_count; i++) {
+        ctx.devices[i]->live_actions = 0;
+    }
+    return false;
+}
+
+// Rebuild a journaled event with its capture time; false if skipped
+static bool replay_entry(const sinricpro_journal_entry_t *entry) {
+    int found = sinricpro_device_table_find(&ctx.device_table, ctx.devices, &entry->key);
+    if (found < 0) return false;    // Device no longer registered
+    sinricpro_device_t *device = ctx.devices[found];
+
+    if (sinricpro_event_coalesces(entry->action) &&
+        (device->live_actions & (1u << entry->action))) {
+        ctx.journal.compacted++;
+        return false;
+    }
+
+    cJSON *value = cJSON_ParseWithLength(entry->value, entry->value_len);
+    cJSON *event = sinricpro_json_create_event(device->device_id,
+                                               sinricpro_action_name(entry->action));
+    cJSON *payload = cJSON_GetObjectItem(event, "payload");
+    if (!value || !payload) {
+        cJSON_Delete(value);
+        cJSON_Delete(event);
+        return false;
+    }
+
+    // Times from before the clock was synced convert only within their boot
+    uint32_t created_at = entry->created_at;
+    if (entry->flags & SINRICPRO_JOURNAL_TIME_SINCE_BOOT) {
+        created_at = entry->boot == ctx.journal.boot ?
+            sinricpro_json_timestamp_of((uint64_t)created_at * 1000000) :
+            sinricpro_json_get_timestamp();
+    }
+
+    cJSON_ReplaceItemInObject(payload, "value", value);
+    cJSON_ReplaceItemInObject(payload, "createdAt", cJSON_CreateNumber(created_at));
+    return budget_event((uint8_t)found, entry->action, event, SINRICPRO_SCHED_STAMPED);
+}
+#endif
+
+// Sign the payload and serialize the complete message; 0 on failure
+static size_t serialize_signed(cJSON *message, char *output, size_t output_len) {
+    if (!message) return 0;
 
     // Serialize payload for signing
-    char payload_str[SINRICPRO_MAX_MESSAGE_SIZE];
-    size_t payload_len = sinricpro_json_serialize_payload(message, payload_str,
-                                                          sizeof(payload_str));
+    size_t payload_len = sinricpro_json_serialize_payload(message, sign_buffer,
+                                                          sizeof(sign_buffer));
     if (payload_len == 0) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] Failed to serialize payload\n");
-        return false;
+        return 0;
     }
 
     // Calculate signature
     char signature[SINRICPRO_SIGNATURE_MAX_LEN];
-    if (!sinricpro_calculate_signature(ctx.config.app_secret, payload_str,
+    if (!sinricpro_calculate_signature(ctx.config.app_secret, sign_buffer,
                                        signature, sizeof(signature))) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] Failed to calculate signature\n");
-        return false;
+        return 0;
     }
 
     // Set signature
     sinricpro_json_set_signature(message, signature);
 
     // Serialize complete message
-    char message_str[SINRICPRO_MAX_MESSAGE_SIZE];
-    size_t message_len = sinricpro_json_serialize(message, message_str,
-                                                   sizeof(message_str));
+    size_t message_len = sinricpro_json_serialize(message, output, output_len);
     if (message_len == 0) {
         SINRICPRO_ERROR_PRINTF("[SinricPro] Failed to serialize message\n");
+    }
+
+    return message_len;
+}
+
+static cJSON *create_event_value(sinricpro_action_t action, const sinricpro_event_value_t *v) {
+    cJSON *value = cJSON_CreateObject();
+    if (!value) return NULL;
+
+    switch (action) {
+        case SINRICPRO_ACTION_SET_POWER_STATE:
+            cJSON_AddStringToObject(value, "state", v->state ? "On" : "Off");
+            break;
+        case SINRICPRO_ACTION_SET_POWER_LEVEL:
+            cJSON_AddNumberToObject(value, "powerLevel", v->level);
+            break;
+        case SINRICPRO_ACTION_SET_BRIGHTNESS:
+            cJSON_AddNumberToObject(value, "brightness", v->level);
+            break;
+        case SINRICPRO_ACTION_SET_COLOR_TEMPERATURE:
+            cJSON_AddNumberToObject(value, "colorTemperature", v->level);
+            break;
+        case SINRICPRO_ACTION_SET_RANGE_VALUE:
+            cJSON_AddNumberToObject(value, "rangeValue", v->level);
+            break;
+        case SINRICPRO_ACTION_SET_COLOR: {
+            cJSON *color = cJSON_AddObjectToObject(value, "color");
+            if (color) {
+                cJSON_AddNumberToObject(color, "r", v->color.r);
+                cJSON_AddNumberToObject(color, "g", v->color.g);
+                cJSON_AddNumberToObject(color, "b", v->color.b);
+            }
+            break;
+        }
+        case SINRICPRO_ACTION_SET_LOCK_STATE:
+            cJSON_AddStringToObject(value, "state", v->state ? "LOCKED" : "UNLOCKED");
+            break;
+        case SINRICPRO_ACTION_SET_MODE:
+            cJSON_AddStringToObject(value, "mode", v->state ? "Close" : "Open");
+            break;
+        case SINRICPRO_ACTION_MOTION:
+            cJSON_AddStringToObject(value, "state", v->state ? "detected" : "notDetected");
+            break;
+        case SINRICPRO_ACTION_CONTACT:
+            cJSON_AddStringToObject(value, "state", v->state ? "open" : "closed");
+            break;
+        case SINRICPRO_ACTION_DOORBELL_PRESS:
+            cJSON_AddStringToObject(value, "state", "pressed");
+            break;
+        case SINRICPRO_ACTION_CURRENT_TEMPERATURE:
+            cJSON_AddNumberToObject(value, "temperature", (double)v->climate.temperature);
+            cJSON_AddNumberToObject(value, "humidity", (double)v->climate.humidity);
+            break;
+        case SINRICPRO_ACTION_AIR_QUALITY:
+            cJSON_AddNumberToObject(value, "pm1", v->air.pm1);
+            cJSON_AddNumberToObject(value, "pm2_5", v->air.pm2_5);
+            cJSON_AddNumberToObject(value, "pm10", v->air.pm10);
+            break;
+        default:
+            // Requests only, or too wide for a descriptor (powerUsage)
+            cJSON_Delete(value);
+            return NULL;
+    }
+
+    return value;
+}
+
+// Expand one posted event; false when the ring is empty
+static bool expand_posted_event(void) {
+    sinricpro_event_desc_t desc;
+    if (!sinricpro_event_ring_take(&event_ring, &desc)) {
         return false;
     }
 
-    // Queue for sending
-    return sinricpro_queue_push(&ctx.tx_queue, SINRICPRO_IF_WEBSOCKET,
-                                message_str, message_len);
+    uint8_t position = registered_position(desc.device, desc.device_index);
+    if (position == SINRICPRO_SCHED_NO_DEVICE) {
+        return true;  // Device removed since the post
+    }
+    sinricpro_device_t *device = ctx.devices[position];
+
+    if (sinricpro_event_limiter_check(&device->post_limiter)) {
+        SINRICPRO_DEBUG_PRINTF("[SinricPro] Posted event rate limited\n");
+        if (desc.action < SINRICPRO_ACTION_COUNT) {
+            device->unacked_actions |= 1u << desc.action;   // Value never reported
+        }
+        return true;
+    }
+
+    // Value from the descriptor; its capture time becomes createdAt on release
+    queue_event_value(position, (sinricpro_action_t)desc.action, &desc.value,
+                      desc.captured_us);
+    return true;
+}
+
+// Build an event from a typed value and schedule it; false if not queued
+static bool queue_event_value(uint8_t position, sinricpro_action_t action_id,
+                              const sinricpro_event_value_t *v, uint64_t captured_us) {
+    const char *action = sinricpro_action_name(action_id);
+    cJSON *value = create_event_value(action_id, v);
+    if (!value) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] Cannot post action %s\n", action ? action : "?");
+        return false;
+    }
+
+    cJSON *event = sinricpro_json_create_event(ctx.devices[position]->device_id, action);
+    if (!event) {
+        cJSON_Delete(value);
+        return false;
+    }
+
+    cJSON *payload = cJSON_GetObjectItem(event, "payload");
+    if (payload) {
+        cJSON_ReplaceItemInObject(payload, "value", value);
+    } else {
+        cJSON_Delete(value);
+    }
+
+    return schedule_event(position, action_id, event, captured_us);
 }
 
 // Device base implementation
@@ -471,15 +2264,39 @@ bool sinricpro_device_init(sinricpro_device_t *device,
                            sinricpro_device_type_t type) {
     if (!device || !device_id) return false;
 
-    if (strlen(device_id) != SINRICPRO_DEVICE_ID_LENGTH) {
-        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid device ID length: %s\n", device_id);
+    sinricpro_device_key_t key;
+    if (!sinricpro_device_key_from_id(device_id, strlen(device_id), &key)) {
+        SINRICPRO_ERROR_PRINTF("[SinricPro] Invalid device ID: %s\n", device_id);
         return false;
     }
 
     memset(device, 0, sizeof(sinricpro_device_t));
     strncpy(device->device_id, device_id, SINRICPRO_DEVICE_ID_LENGTH);
     device->device_id[SINRICPRO_DEVICE_ID_LENGTH] = '\0';
+    device->key = key;
     device->type = type;
+    sinricpro_event_limiter_init_state(&device->post_limiter);
+
+    return true;
+}
+
+static int hex_nibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool sinricpro_device_key_from_id(const char *device_id, size_t len,
+                                  sinricpro_device_key_t *key) {
+    if (!device_id || !key || len != SINRICPRO_DEVICE_ID_LENGTH) return false;
+
+    for (size_t i = 0; i < sizeof(key->bytes); i++) {
+        int hi = hex_nibble(device_id[2 * i]);
+        int lo = hex_nibble(device_id[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        key->bytes[i] = (uint8_t)((hi << 4) | lo);
+    }
 
     return true;
 }
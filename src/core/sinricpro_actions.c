@@ -0,0 +1,36 @@
+/**
+ * @file sinricpro_actions.c
+ * @brief Action identifier to wire name mapping
+ */
+
+#include "sinricpro/sinricpro_actions.h"
+#include <stddef.h>
+
+static const char *const action_names[SINRICPRO_ACTION_COUNT] = {
+    [SINRICPRO_ACTION_SET_POWER_STATE]              = "setPowerState",
+    [SINRICPRO_ACTION_SET_POWER_LEVEL]              = "setPowerLevel",
+    [SINRICPRO_ACTION_ADJUST_POWER_LEVEL]           = "adjustPowerLevel",
+    [SINRICPRO_ACTION_SET_BRIGHTNESS]               = "setBrightness",
+    [SINRICPRO_ACTION_ADJUST_BRIGHTNESS]            = "adjustBrightness",
+    [SINRICPRO_ACTION_SET_COLOR]                    = "setColor",
+    [SINRICPRO_ACTION_SET_COLOR_TEMPERATURE]        = "setColorTemperature",
+    [SINRICPRO_ACTION_INCREASE_COLOR_TEMPERATURE]   = "increaseColorTemperature",
+    [SINRICPRO_ACTION_DECREASE_COLOR_TEMPERATURE]   = "decreaseColorTemperature",
+    [SINRICPRO_ACTION_SET_RANGE_VALUE]              = "setRangeValue",
+    [SINRICPRO_ACTION_ADJUST_RANGE_VALUE]           = "adjustRangeValue",
+    [SINRICPRO_ACTION_SET_LOCK_STATE]               = "setLockState",
+    [SINRICPRO_ACTION_SET_MODE]                     = "setMode",
+    [SINRICPRO_ACTION_MOTION]                       = "setMotionDetection",
+    [SINRICPRO_ACTION_CONTACT]                      = "setContactState",
+    [SINRICPRO_ACTION_DOORBELL_PRESS]               = "DoorbellPress",
+    [SINRICPRO_ACTION_CURRENT_TEMPERATURE]          = "currentTemperature",
+    [SINRICPRO_ACTION_AIR_QUALITY]                  = "airQuality",
+    [SINRICPRO_ACTION_POWER_USAGE]                  = "powerUsage",
+};
+
+const char *sinricpro_action_name(sinricpro_action_t action) {
+    if ((unsigned)action >= SINRICPRO_ACTION_COUNT) {
+        return NULL;
+    }
+    return action_names[action];
+}
@@ -0,0 +1,163 @@
+/**
+ * @file sinricpro_capability.c
+ * @brief Composed device initialization and capability routing
+ */
+
+#include "sinricpro/sinricpro_capability.h"
+#include "sinricpro/sinricpro.h"
+#include "core/sinricpro_debug.h"
+#include <string.h>
+
+_Static_assert(SINRICPRO_ACTION_COUNT <= 32, "Capability masks hold one bit per action");
+
+// First slot whose mask contains the action
+static const sinricpro_capability_slot_t *find_slot(const sinricpro_device_t *device,
+                                                    sinricpro_action_t action,
+                                                    bool event) {
+    const sinricpro_device_model_t *model = device->model;
+    if (!model || action == SINRICPRO_ACTION_UNKNOWN || action >= SINRICPRO_ACTION_COUNT) {
+        return NULL;
+    }
+
+    uint32_t bit = SINRICPRO_ACTION_BIT(action);
+    for (uint8_t i = 0; i < model->slot_count; i++) {
+        const sinricpro_capability_t *cap = model->slots[i].capability;
+        if ((event ? cap->events : cap->requests) & bit) {
+            return &model->slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+static inline void *slot_state(sinricpro_device_t *device, const sinricpro_capability_slot_t *slot) {
+    return (uint8_t *)device + slot->offset;
+}
+
+bool sinricpro_device_compose(sinricpro_device_t *device,
+                              const char *device_id,
+                              const sinricpro_device_model_t *model) {
+    if (!device || !model) return false;
+
+    if (!sinricpro_device_init(device, device_id, model->type)) {
+        return false;
+    }
+
+    device->model = model;
+
+    for (uint8_t i = 0; i < model->slot_count; i++) {
+        const sinricpro_capability_slot_t *slot = &model->slots[i];
+        if (slot->capability->init) {
+            slot->capability->init(slot_state(device, slot));
+        }
+
+        // Nothing reported yet
+        if (slot->capability->snapshot) {
+            device->unacked_actions |= slot->capability->events;
+        }
+    }
+
+    return true;
+}
+
+void *sinricpro_device_capability(sinricpro_device_t *device,
+                                  const sinricpro_capability_t *capability) {
+    if (!device || !device->model || !capability) return NULL;
+
+    const sinricpro_device_model_t *model = device->model;
+    for (uint8_t i = 0; i < model->slot_count; i++) {
+        if (model->slots[i].capability == capability) {
+            return slot_state(device, &model->slots[i]);
+        }
+    }
+
+    return NULL;
+}
+
+bool sinricpro_device_send_event(sinricpro_device_t *device,
+                                 sinricpro_action_t action,
+                                 const sinricpro_event_value_t *value) {
+    if (!device) return false;
+
+    const sinricpro_capability_slot_t *slot = find_slot(device, action, true);
+    if (!slot || !slot->capability->send) {
+        SINRICPRO_WARN_PRINTF("[SinricPro] No capability sends %s\n",
+                              sinricpro_action_name(action) ? sinricpro_action_name(action) : "?");
+        return false;
+    }
+
+    sinricpro_event_value_t none;
+    if (!value) {
+        memset(&none, 0, sizeof(none));
+        value = &none;
+    }
+
+    return slot->capability->send(slot_state(device, slot), device->device_id, action, value);
+}
+
+size_t sinricpro_device_flush_deferred(sinricpro_device_t *device) {
+    if (!device || !device->model) return 0;
+
+    size_t sent = 0;
+    const sinricpro_device_model_t *model = device->model;
+    for (uint8_t i = 0; i < model->slot_count; i++) {
+        const sinricpro_capability_t *cap = model->slots[i].capability;
+        if (!cap->limiter || !cap->send) continue;
+
+        void *state = slot_state(device, &model->slots[i]);
+        sinricpro_action_t action;
+        sinricpro_event_value_t value;
+        uint64_t captured_us;
+        if (!sinricpro_event_limiter_take_deferred(cap->limiter(state), &action, &value,
+                                                   &captured_us)) {
+            continue;
+        }
+
+        // Stamped with when the value was measured, not when it was let through
+        sinricpro_set_capture_time(captured_us);
+        if (cap->send(state, device->device_id, action, &value)) {
+            sent++;
+        }
+        sinricpro_set_capture_time(0);
+    }
+
+    return sent;
+}
+
+bool sinricpro_device_snapshot(sinricpro_device_t *device,
+                               uint8_t slot,
+                               sinricpro_action_t *action,
+                               sinricpro_event_value_t *value) {
+    if (!device || !device->model || slot >= device->model->slot_count || !action || !value) {
+        return false;
+    }
+
+    const sinricpro_capability_slot_t *entry = &device->model->slots[slot];
+    const sinricpro_capability_t *cap = entry->capability;
+    if (!cap->snapshot) return false;
+
+    void *state = slot_state(device, entry);
+    if (cap->limiter && cap->limiter(state)->deferred) return false;
+
+    memset(value, 0, sizeof(*value));
+    return cap->snapshot(state, action, value);
+}
+
+bool sinricpro_device_has_action(const sinricpro_device_t *device, sinricpro_action_t action) {
+    return device && find_slot(device, action, false) != NULL;
+}
+
+bool sinricpro_device_route_request(sinricpro_device_t *device,
+                                    sinricpro_action_t action,
+                                    const cJSON *request,
+                                    cJSON *response,
+                                    bool *handled) {
+    const sinricpro_capability_slot_t *slot = device ? find_slot(device, action, false) : NULL;
+    if (!slot || !slot->capability->handle) {
+        if (handled) *handled = false;
+        return false;
+    }
+
+    if (handled) *handled = true;
+    return slot->capability->handle(slot_state(device, slot), device, action, request, response);
+}
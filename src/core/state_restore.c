@@ -0,0 +1,181 @@
+/**
+ * @file state_restore.c
+ * @brief State restore table implementation
+ */
+
+#include "state_restore.h"
+#include "json_helpers.h"
+#include <string.h>
+
+_Static_assert(SINRICPRO_RESTORE_SLOTS > 0, "At least one restore slot is needed");
+
+// Hand an entry's request and responses to the caller and free the slot
+static cJSON *release(sinricpro_restore_entry_t *entry, cJSON **responses) {
+    cJSON *request = entry->request;
+    if (responses) {
+        *responses = entry->responses;
+    } else {
+        cJSON_Delete(entry->responses);
+    }
+    entry->request = NULL;
+    entry->responses = NULL;
+    return request;
+}
+
+void sinricpro_restore_init(sinricpro_restore_table_t *table) {
+    if (!table) return;
+    memset(table, 0, sizeof(sinricpro_restore_table_t));
+}
+
+bool sinricpro_restore_add(sinricpro_restore_table_t *table,
+                           cJSON *request,
+                           cJSON *response,
+                           uint8_t device,
+                           sinricpro_action_t action) {
+    if (!table || !request || !response) return false;
+
+    sinricpro_restore_entry_t *slot = NULL;
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (!entry->request) {
+            if (!slot) slot = entry;
+            continue;
+        }
+
+        // Latest state wins; the earlier request is answered with its outcome
+        if (entry->device == device && entry->action == (uint8_t)action) {
+            cJSON_AddItemToArray(entry->responses, response);
+            cJSON_Delete(entry->request);
+            entry->request = request;
+            table->received++;
+            table->coalesced++;
+            return true;
+        }
+    }
+
+    cJSON *responses = slot ? cJSON_CreateArray() : NULL;
+    if (!responses) return false;
+    cJSON_AddItemToArray(responses, response);
+
+    slot->request = request;
+    slot->responses = responses;
+    slot->device = device;
+    slot->action = (uint8_t)action;
+    table->received++;
+    return true;
+}
+
+cJSON *sinricpro_restore_take(sinricpro_restore_table_t *table,
+                              sinricpro_action_t *action,
+                              cJSON **responses) {
+    if (!table) return NULL;
+
+    sinricpro_restore_entry_t *next = NULL;
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (!entry->request) continue;
+
+        if (!next || entry->device < next->device ||
+            (entry->device == next->device && entry->action < next->action)) {
+            next = entry;
+        }
+    }
+    if (!next) return NULL;
+
+    if (action) *action = (sinricpro_action_t)next->action;
+    table->applied++;
+    return release(next, responses);
+}
+
+cJSON *sinricpro_restore_take_device(sinricpro_restore_table_t *table,
+                                     uint8_t device,
+                                     cJSON **responses) {
+    if (!table) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (entry->request && entry->device == device) {
+            return release(entry, responses);
+        }
+    }
+    return NULL;
+}
+
+cJSON *sinricpro_restore_take_action(sinricpro_restore_table_t *table,
+                                     uint8_t device,
+                                     sinricpro_action_t action,
+                                     cJSON **responses) {
+    if (!table) return NULL;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (entry->request && entry->device == device && entry->action == (uint8_t)action) {
+            table->coalesced++;
+            return release(entry, responses);
+        }
+    }
+    return NULL;
+}
+
+bool sinricpro_restore_has(const sinricpro_restore_table_t *table,
+                           uint8_t device,
+                           sinricpro_action_t action) {
+    if (!table) return false;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        const sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (entry->request && entry->device == device && entry->action == (uint8_t)action) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void sinricpro_restore_move_device(sinricpro_restore_table_t *table, uint8_t from, uint8_t to) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (entry->request && entry->device == from) {
+            entry->device = to;
+        }
+    }
+}
+
+bool sinricpro_restore_has_token(const sinricpro_restore_table_t *table,
+                                 const char *token, size_t len) {
+    if (!table || !token) return false;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        const sinricpro_restore_entry_t *entry = &table->entries[i];
+        if (!entry->request) continue;
+
+        const cJSON *response;
+        cJSON_ArrayForEach(response, entry->responses) {
+            const char *reply_token = sinricpro_json_get_reply_token(response);
+            if (reply_token && strlen(reply_token) == len &&
+                memcmp(reply_token, token, len) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t sinricpro_restore_count(const sinricpro_restore_table_t *table) {
+    if (!table) return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        if (table->entries[i].request) count++;
+    }
+    return count;
+}
+
+void sinricpro_restore_clear(sinricpro_restore_table_t *table) {
+    if (!table) return;
+
+    for (size_t i = 0; i < SINRICPRO_RESTORE_SLOTS; i++) {
+        cJSON_Delete(release(&table->entries[i], NULL));
+    }
+}
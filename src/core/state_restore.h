@@ -0,0 +1,166 @@
+/**
+ * @file state_restore.h
+ * @brief Server state restore requests waiting to be applied
+ *
+ * With restoredevicestates set in the handshake, the server sends every
+ * device's last known state as requests right after connecting. Those
+ * requests are kept here, with their unsent responses, one entry per
+ * device and action: a later request for the same property replaces the
+ * earlier one, whose response is answered with the later one's outcome.
+ * Once the burst settles they are applied one at a time, in registry
+ * order, so a board full of relays doesn't switch them all at once.
+ */
+
+#ifndef SINRICPRO_STATE_RESTORE_H
+#define SINRICPRO_STATE_RESTORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sinricpro/sinricpro_config.h"
+#include "sinricpro/sinricpro_actions.h"
+#include "cJSON.h"
+
+/**
+ * @brief Restore waiting to be applied
+ */
+typedef struct {
+    cJSON *request;                     // NULL = free; {"payload": ...} of the latest request
+    cJSON *responses;                   // Array of unsent responses, latest request's last
+    uint8_t device;                     // Registry position (apply order)
+    uint8_t action;                     // sinricpro_action_t
+} sinricpro_restore_entry_t;
+
+/**
+ * @brief Restore table
+ */
+typedef struct {
+    sinricpro_restore_entry_t entries[SINRICPRO_RESTORE_SLOTS];
+    uint32_t received;
+    uint32_t coalesced;                 // Replaced by a later request for the same property
+    uint32_t applied;
+} sinricpro_restore_table_t;
+
+/**
+ * @brief Initialize (empty) the table
+ *
+ * @param table Table
+ */
+void sinricpro_restore_init(sinricpro_restore_table_t *table);
+
+/**
+ * @brief Keep a restore request until it is applied
+ *
+ * @param table    Table
+ * @param request  Request (owned by the table once added)
+ * @param response Its response, sent once applied (owned by the table once added)
+ * @param device   Registry position of the device
+ * @param action   Request action
+ * @return false if the table is full (not added; the caller still owns both)
+ */
+bool sinricpro_restore_add(sinricpro_restore_table_t *table,
+                           cJSON *request,
+                           cJSON *response,
+                           uint8_t device,
+                           sinricpro_action_t action);
+
+/**
+ * @brief Take the next restore to apply
+ *
+ * Lowest registry position first, then lowest action.
+ *
+ * @param table     Table
+ * @param action    Output: request action
+ * @param responses Output: array of responses to answer (caller deletes it)
+ * @return The request (caller deletes it), or NULL if none is waiting
+ */
+cJSON *sinricpro_restore_take(sinricpro_restore_table_t *table,
+                              sinricpro_action_t *action,
+                              cJSON **responses);
+
+/**
+ * @brief Take a waiting restore of one device
+ *
+ * Call until it returns NULL.
+ *
+ * @param table     Table
+ * @param device    Registry position of the device
+ * @param responses Output: array of responses to answer (caller deletes it)
+ * @return The request (caller deletes it), or NULL if none is waiting
+ */
+cJSON *sinricpro_restore_take_device(sinricpro_restore_table_t *table,
+                                     uint8_t device,
+                                     cJSON **responses);
+
+/**
+ * @brief Take the waiting restore of one property
+ *
+ * For a live request that replaces it; counted as coalesced.
+ *
+ * @param table     Table
+ * @param device    Registry position of the device
+ * @param action    Request action
+ * @param responses Output: array of responses to answer (caller deletes it)
+ * @return The request (caller deletes it), or NULL if none is waiting
+ */
+cJSON *sinricpro_restore_take_action(sinricpro_restore_table_t *table,
+                                     uint8_t device,
+                                     sinricpro_action_t action,
+                                     cJSON **responses);
+
+/**
+ * @brief Check whether a restore of one property is waiting
+ *
+ * @param table  Table
+ * @param device Registry position of the device
+ * @param action Request action
+ * @return true if one is waiting
+ */
+bool sinricpro_restore_has(const sinricpro_restore_table_t *table,
+                           uint8_t device,
+                           sinricpro_action_t action);
+
+/**
+ * @brief Renumber a device's restores after it moved in the registry
+ *
+ * @param table Table
+ * @param from  Former registry position
+ * @param to    New registry position
+ */
+void sinricpro_restore_move_device(sinricpro_restore_table_t *table, uint8_t from, uint8_t to);
+
+/**
+ * @brief Check whether a response waits for a replyToken
+ *
+ * @param table Table
+ * @param token replyToken
+ * @param len   Token length
+ * @return true if a waiting restore will answer it
+ */
+bool sinricpro_restore_has_token(const sinricpro_restore_table_t *table,
+                                 const char *token, size_t len);
+
+/**
+ * @brief Number of restores waiting
+ *
+ * @param table Table
+ * @return Waiting restores
+ */
+size_t sinricpro_restore_count(const sinricpro_restore_table_t *table);
+
+/**
+ * @brief Drop all waiting restores, deleting their responses
+ *
+ * @param table Table
+ */
+void sinricpro_restore_clear(sinricpro_restore_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SINRICPRO_STATE_RESTORE_H
@@ -6,10 +6,12 @@
  */
 
 #include "websocket_client.h"
+#include "http_upgrade.h"
 #include "sinricpro/sinricpro_config.h"
 #include "sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 
 #include "pico/stdlib.h"
@@ -30,10 +32,47 @@
 #define WS_TX_BUFFER_SIZE   SINRICPRO_WEBSOCKET_BUFFER_SIZE
 #define WS_RX_BUFFER_SIZE   SINRICPRO_WEBSOCKET_BUFFER_SIZE
 #define WS_KEY_LENGTH       24  // Base64 encoded 16 bytes
+#define WS_HANDSHAKE_CHUNK_SIZE 256 // Upgrade request is streamed in chunks of this size
 
 // WebSocket magic GUID for handshake
 static const char *WS_MAGIC_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
+// Upgrade request pieces, emitted in order
+typedef enum {
+    WS_HS_REQUEST_LINE = 0,
+    WS_HS_HOST,
+    WS_HS_UPGRADE,
+    WS_HS_KEY,
+    WS_HS_APP_KEY,
+    WS_HS_DEVICE_IDS_NAME,
+    WS_HS_DEVICE_ID,
+    WS_HS_DEVICE_IDS_END,
+    WS_HS_RESTORE,
+    WS_HS_PLATFORM,
+    WS_HS_SDK_VERSION,
+    WS_HS_IP,
+    WS_HS_MAC,
+    WS_HS_END,
+    WS_HS_DONE
+} ws_hs_stage_t;
+
+// Streaming handshake writer
+typedef struct {
+    ws_hs_stage_t stage;
+    size_t device_index;
+    char chunk[WS_HANDSHAKE_CHUNK_SIZE];
+    size_t chunk_len;
+} ws_hs_writer_t;
+
+// Warm standby transport (connected, not yet upgraded)
+typedef struct {
+    sinricpro_ws_standby_state_t state;
+    struct altcp_pcb *pcb;
+    ip_addr_t server_ip;
+    uint8_t server;
+    uint32_t last_attempt;
+} ws_standby_t;
+
 // Connection state
 typedef struct {
     sinricpro_ws_state_t state;
@@ -42,15 +81,30 @@ typedef struct {
     // lwIP connection
     struct altcp_pcb *pcb;
     ip_addr_t server_ip;
+    struct altcp_tls_config *tls_config;
+
+    // Server selection and failover
+    uint8_t active_server;
+    uint32_t connect_started;
+    uint32_t link_lost_time;
+    bool link_lost;
+    ws_standby_t standby;
+    sinricpro_ws_stats_t stats;
 
     // Buffers
     uint8_t tx_buffer[WS_TX_BUFFER_SIZE];
     uint8_t rx_buffer[WS_RX_BUFFER_SIZE];
     size_t rx_len;
 
+    // Set while a frame is being written; a receive callback run from
+    // inside altcp_write/altcp_output must not write again
+    bool tx_busy;
+
     // WebSocket handshake
     char ws_key[WS_KEY_LENGTH + 1];
     bool handshake_complete;
+    sinricpro_http_upgrade_t upgrade;
+    ws_hs_writer_t hs;
 
     // Ping/Pong timing
     uint32_t last_ping_sent;
@@ -81,8 +135,18 @@ static err_t ws_tcp_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t
 static void ws_tcp_err(void *arg, err_t err);
 static err_t ws_tcp_sent(void *arg, struct altcp_pcb *pcb, u16_t len);
 static void ws_dns_callback(const char *name, const ip_addr_t *addr, void *arg);
-static void ws_send_handshake(void);
-static bool ws_parse_handshake_response(const char *response, size_t len);
+static bool ws_open_active(void);
+static void ws_close_active(void);
+static void ws_connect_failed(void);
+static struct altcp_pcb *ws_new_pcb(void);
+static uint8_t ws_standby_server(void);
+static void ws_standby_maintain(uint32_t now);
+static void ws_standby_close(void);
+static bool ws_promote_standby(void);
+static bool ws_send_handshake(void);
+static bool ws_handshake_continue(void);
+static bool ws_handshake_pending(void);
+static bool ws_verify_upgrade(const sinricpro_http_upgrade_t *upgrade);
 static void ws_process_frame(const uint8_t *data, size_t len);
 static void ws_set_state(sinricpro_ws_state_t new_state);
 static void ws_generate_key(char *key_out);
@@ -107,7 +171,7 @@ bool sinricpro_ws_init(void) {
 }
 
 bool sinricpro_ws_connect(const sinricpro_ws_config_t *config) {
-    if (!ws_initialized || !config || !config->host) {
+    if (!ws_initialized || !config || !config->servers || config->server_count == 0) {
         return false;
     }
 
@@ -119,52 +183,34 @@ bool sinricpro_ws_connect(const sinricpro_ws_config_t *config) {
 
     // Store config
     memcpy(&ws_ctx.config, config, sizeof(sinricpro_ws_config_t));
+    ws_ctx.active_server = 0;
 
-    // Reset state
-    ws_ctx.rx_len = 0;
-    ws_ctx.handshake_complete = false;
-    ws_ctx.ping_pending = false;
-    ws_ctx.frame_in_progress = false;
-    ws_ctx.last_pong_received = get_millis();
-
-    // Generate WebSocket key
-    ws_generate_key(ws_ctx.ws_key);
-
-    // Start DNS lookup
-    ws_set_state(WS_STATE_DNS_LOOKUP);
-
-    err_t err = dns_gethostbyname(config->host, &ws_ctx.server_ip,
-                                  ws_dns_callback, NULL);
-
-    if (err == ERR_OK) {
-        // Already cached - proceed to connect
-        ws_dns_callback(config->host, &ws_ctx.server_ip, NULL);
-    } else if (err != ERR_INPROGRESS) {
-        SINRICPRO_ERROR_PRINTF("[WS] DNS lookup failed: %d\n", err);
-        ws_set_state(WS_STATE_ERROR);
-        return false;
+    // A standby to the active server's own host is a second TLS session the
+    // server's idle close keeps tearing down; it gains nothing
+    if (ws_ctx.config.warm_standby && ws_standby_server() == ws_ctx.active_server) {
+        SINRICPRO_WARN_PRINTF("[WS] Warm standby disabled: needs two distinct servers\n");
+        ws_ctx.config.warm_standby = false;
     }
 
-    return true;
+    return ws_open_active();
 }
 
 void sinricpro_ws_disconnect(void) {
-    if (ws_ctx.pcb) {
-        // Send close frame if connected
-        if (ws_ctx.state == WS_STATE_CONNECTED) {
-            uint8_t close_frame[6];
-            size_t len = ws_encode_frame(WS_OPCODE_CLOSE, NULL, 0,
-                                         close_frame, sizeof(close_frame));
-            altcp_write(ws_ctx.pcb, close_frame, len, TCP_WRITE_FLAG_COPY);
-            altcp_output(ws_ctx.pcb);
-        }
+    ws_close_active();
+    ws_standby_close();
+}
 
-        altcp_close(ws_ctx.pcb);
-        ws_ctx.pcb = NULL;
+void sinricpro_ws_reannounce(void) {
+    if (ws_ctx.state != WS_STATE_WS_HANDSHAKE && ws_ctx.state != WS_STATE_CONNECTED) {
+        return;  // The next upgrade request reads the current list
     }
 
-    ws_ctx.last_disconnect_time = get_millis();
-    ws_set_state(WS_STATE_DISCONNECTED);
+    SINRICPRO_DEBUG_PRINTF("[WS] Re-announcing devices\n");
+    ws_ctx.stats.reannounces++;
+    ws_close_active();
+
+    // Skip the reconnect delay; ws_handle() promotes the standby if ready
+    ws_ctx.last_disconnect_time = get_millis() - ws_ctx.reconnect_delay_ms;
 }
 
 void sinricpro_ws_handle(void) {
@@ -186,26 +232,47 @@ void sinricpro_ws_handle(void) {
                     uint32_t pong_age = now - ws_ctx.last_pong_received;
                     if (pong_age > ws_ctx.config.ping_timeout_ms) {
                         SINRICPRO_DEBUG_PRINTF("[WS] Ping timeout (%lu ms)\n", (unsigned long)pong_age);
-                        sinricpro_ws_disconnect();
+                        ws_close_active();
                     }
                 } else {
                     sinricpro_ws_send_ping();
                 }
             }
+
+            ws_standby_maintain(now);
             break;
 
         case WS_STATE_DISCONNECTED:
         case WS_STATE_ERROR:
-            // Auto-reconnect
-            if (ws_ctx.auto_reconnect && ws_ctx.config.host) {
-                if ((now - ws_ctx.last_disconnect_time) >= ws_ctx.reconnect_delay_ms) {
-                    SINRICPRO_DEBUG_PRINTF("[WS] Attempting reconnect...\n");
-                    sinricpro_ws_connect(&ws_ctx.config);
-                }
+            if (!ws_ctx.auto_reconnect || !ws_ctx.config.servers) {
+                break;
+            }
+
+            // Failover: switch to the pre-connected standby without waiting
+            if (ws_promote_standby()) {
+                break;
+            }
+
+            // Cold reconnect
+            if ((now - ws_ctx.last_disconnect_time) >= ws_ctx.reconnect_delay_ms) {
+                SINRICPRO_DEBUG_PRINTF("[WS] Attempting reconnect...\n");
+                ws_ctx.stats.cold_reconnects++;
+                ws_open_active();
             }
             break;
 
         default:
+            // Upgrade request stalled on ERR_MEM with nothing in flight
+            if (ws_ctx.state == WS_STATE_WS_HANDSHAKE && ws_handshake_pending()) {
+                ws_handshake_continue();
+            }
+
+            // DNS, TCP, TLS or upgrade still in progress
+            if (ws_ctx.config.connect_timeout_ms > 0 &&
+                (now - ws_ctx.connect_started) >= ws_ctx.config.connect_timeout_ms) {
+                SINRICPRO_ERROR_PRINTF("[WS] Connect timeout\n");
+                ws_connect_failed();
+            }
             break;
     }
 }
@@ -231,14 +298,18 @@ bool sinricpro_ws_send(const char *message, size_t length) {
 
     SINRICPRO_DEBUG_PRINTF("[WS TX] (%zu bytes): %.*s\n", length, (int)length, message);
 
+    ws_ctx.tx_busy = true;
     err_t err = altcp_write(ws_ctx.pcb, ws_ctx.tx_buffer, frame_len,
                             TCP_WRITE_FLAG_COPY);
+    if (err == ERR_OK) {
+        altcp_output(ws_ctx.pcb);
+    }
+    ws_ctx.tx_busy = false;
+
     if (err != ERR_OK) {
         SINRICPRO_ERROR_PRINTF("[WS] Send failed: %d\n", err);
         return false;
     }
-
-    altcp_output(ws_ctx.pcb);
     return true;
 }
 
@@ -270,10 +341,24 @@ bool sinricpro_ws_is_connected(void) {
     return ws_ctx.state == WS_STATE_CONNECTED;
 }
 
+bool sinricpro_ws_can_send_now(void) {
+    return ws_ctx.state == WS_STATE_CONNECTED && ws_ctx.pcb && !ws_ctx.tx_busy;
+}
+
 uint32_t sinricpro_ws_get_last_pong_age(void) {
     return get_millis() - ws_ctx.last_pong_received;
 }
 
+void sinricpro_ws_get_stats(sinricpro_ws_stats_t *stats) {
+    if (!stats) return;
+
+    memcpy(stats, &ws_ctx.stats, sizeof(sinricpro_ws_stats_t));
+    stats->active_server = ws_ctx.active_server;
+    stats->standby_server = ws_ctx.standby.server;
+    stats->active_state = ws_ctx.state;
+    stats->standby_state = ws_ctx.standby.state;
+}
+
 void sinricpro_ws_set_reconnect(bool enabled, uint32_t delay_ms) {
     ws_ctx.auto_reconnect = enabled;
     if (delay_ms > 0) {
@@ -289,6 +374,11 @@ static void ws_set_state(sinricpro_ws_state_t new_state) {
     if (ws_ctx.state != new_state) {
         ws_ctx.state = new_state;
 
+        if (new_state == WS_STATE_CONNECTED && ws_ctx.link_lost) {
+            ws_ctx.stats.last_recovery_ms = get_millis() - ws_ctx.link_lost_time;
+            ws_ctx.link_lost = false;
+        }
+
         if (ws_ctx.config.on_state_change) {
             ws_ctx.config.on_state_change(new_state, ws_ctx.config.user_data);
         }
@@ -309,10 +399,117 @@ static void ws_generate_key(char *key_out) {
     key_out[olen] = '\0';
 }
 
+static const sinricpro_ws_server_t *ws_server(uint8_t index) {
+    return &ws_ctx.config.servers[index % ws_ctx.config.server_count];
+}
+
+static bool ws_open_active(void) {
+    const sinricpro_ws_server_t *server = ws_server(ws_ctx.active_server);
+
+    // Reset state
+    ws_ctx.rx_len = 0;
+    ws_ctx.handshake_complete = false;
+    sinricpro_http_upgrade_init(&ws_ctx.upgrade);
+    ws_ctx.ping_pending = false;
+    ws_ctx.frame_in_progress = false;
+    ws_ctx.last_pong_received = get_millis();
+    ws_ctx.connect_started = get_millis();
+
+    // Generate WebSocket key
+    ws_generate_key(ws_ctx.ws_key);
+
+    // Start DNS lookup
+    ws_set_state(WS_STATE_DNS_LOOKUP);
+
+    err_t err = dns_gethostbyname(server->host, &ws_ctx.server_ip,
+                                  ws_dns_callback, NULL);
+
+    if (err == ERR_OK) {
+        // Already cached - proceed to connect
+        ws_dns_callback(server->host, &ws_ctx.server_ip, NULL);
+    } else if (err != ERR_INPROGRESS) {
+        SINRICPRO_ERROR_PRINTF("[WS] DNS lookup failed: %d\n", err);
+        ws_connect_failed();
+        return false;
+    }
+
+    return true;
+}
+
+static void ws_close_active(void) {
+    if (ws_ctx.pcb) {
+        // Send close frame if connected
+        if (ws_ctx.state == WS_STATE_CONNECTED) {
+            uint8_t close_frame[6];
+            size_t len = ws_encode_frame(WS_OPCODE_CLOSE, NULL, 0,
+                                         close_frame, sizeof(close_frame));
+            altcp_write(ws_ctx.pcb, close_frame, len, TCP_WRITE_FLAG_COPY);
+            altcp_output(ws_ctx.pcb);
+        }
+
+        altcp_close(ws_ctx.pcb);
+        ws_ctx.pcb = NULL;
+    }
+
+    if (ws_ctx.state == WS_STATE_CONNECTED && !ws_ctx.link_lost) {
+        ws_ctx.link_lost = true;
+        ws_ctx.link_lost_time = get_millis();
+    }
+
+    ws_ctx.last_disconnect_time = get_millis();
+    ws_set_state(WS_STATE_DISCONNECTED);
+}
+
+// An attempt on the active server failed: move on to the next one in the list
+static void ws_connect_failed(void) {
+    if (ws_ctx.pcb) {
+        // Detached first: lwIP calls the err callback from altcp_abort(),
+        // which would count the failure and rotate the server again
+        altcp_arg(ws_ctx.pcb, NULL);
+        altcp_err(ws_ctx.pcb, NULL);
+        altcp_recv(ws_ctx.pcb, NULL);
+        altcp_sent(ws_ctx.pcb, NULL);
+        altcp_abort(ws_ctx.pcb);
+        ws_ctx.pcb = NULL;
+    }
+
+    ws_ctx.stats.connect_failures++;
+    if (ws_ctx.config.server_count > 1) {
+        ws_ctx.active_server = (ws_ctx.active_server + 1) % ws_ctx.config.server_count;
+    }
+
+    ws_ctx.last_disconnect_time = get_millis();
+    ws_set_state(WS_STATE_ERROR);
+}
+
+static struct altcp_pcb *ws_new_pcb(void) {
+    if (!ws_ctx.config.use_ssl) {
+        SINRICPRO_DEBUG_PRINTF("[WS] Plain TCP\n");
+        return altcp_new(NULL);
+    }
+
+    // TLS config is shared by the active and standby connections
+    if (!ws_ctx.tls_config) {
+        SINRICPRO_DEBUG_PRINTF("[WS] Create TLS config\n");
+        ws_ctx.tls_config = altcp_tls_create_config_client(NULL, 0);  // No client cert
+        if (!ws_ctx.tls_config) {
+            SINRICPRO_ERROR_PRINTF("[WS] Failed to create TLS config\n");
+            return NULL;
+        }
+    }
+
+    return altcp_tls_new(ws_ctx.tls_config, IPADDR_TYPE_V4);
+}
+
 static void ws_dns_callback(const char *name, const ip_addr_t *addr, void *arg) {
+    // Stale result from an attempt that already timed out
+    if (ws_ctx.state != WS_STATE_DNS_LOOKUP) {
+        return;
+    }
+
     if (!addr) {
         SINRICPRO_ERROR_PRINTF("[WS] DNS lookup failed for %s\n", name);
-        ws_set_state(WS_STATE_ERROR);
+        ws_connect_failed();
         return;
     }
 
@@ -322,30 +519,10 @@ static void ws_dns_callback(const char *name, const ip_addr_t *addr, void *arg)
     // Create TCP connection
     ws_set_state(WS_STATE_TCP_CONNECTING);
 
-    struct altcp_pcb *pcb;
-
-    if (ws_ctx.config.use_ssl) {
-        SINRICPRO_DEBUG_PRINTF("[WS] Create TLS PCB\n");
-        // Create TLS PCB
-        struct altcp_tls_config *tls_config = altcp_tls_create_config_client(
-            NULL, 0);  // No client cert
-
-        if (!tls_config) {
-            SINRICPRO_ERROR_PRINTF("[WS] Failed to create TLS config\n");
-            ws_set_state(WS_STATE_ERROR);
-            return;
-        }
-
-        pcb = altcp_tls_new(tls_config, IPADDR_TYPE_V4);
-    } else {
-        SINRICPRO_DEBUG_PRINTF("[WS] Plain TCP\n");
-        // Plain TCP
-        pcb = altcp_new(NULL);
-    }
-
+    struct altcp_pcb *pcb = ws_new_pcb();
     if (!pcb) {
         SINRICPRO_ERROR_PRINTF("[WS] Failed to create PCB\n");
-        ws_set_state(WS_STATE_ERROR);
+        ws_connect_failed();
         return;
     }
 
@@ -358,21 +535,19 @@ static void ws_dns_callback(const char *name, const ip_addr_t *addr, void *arg)
     altcp_sent(pcb, ws_tcp_sent);
 
     // Connect
-    err_t err = altcp_connect(pcb, &ws_ctx.server_ip, ws_ctx.config.port,
+    err_t err = altcp_connect(pcb, &ws_ctx.server_ip, ws_server(ws_ctx.active_server)->port,
                               ws_tcp_connected);
 
     if (err != ERR_OK) {
         SINRICPRO_ERROR_PRINTF("[WS] Connect failed: %d\n", err);
-        altcp_close(pcb);
-        ws_ctx.pcb = NULL;
-        ws_set_state(WS_STATE_ERROR);
+        ws_connect_failed();
     }
 }
 
 static err_t ws_tcp_connected(void *arg, struct altcp_pcb *pcb, err_t err) {
     if (err != ERR_OK) {
         SINRICPRO_ERROR_PRINTF("[WS] TCP connect error: %d\n", err);
-        ws_set_state(WS_STATE_ERROR);
+        ws_connect_failed();
         return err;
     }
 
@@ -384,88 +559,186 @@ static err_t ws_tcp_connected(void *arg, struct altcp_pcb *pcb, err_t err) {
     }
 
     ws_set_state(WS_STATE_WS_HANDSHAKE);
-    ws_send_handshake();
+    if (!ws_send_handshake()) {
+        return ERR_ABRT;
+    }
 
     return ERR_OK;
 }
 
-static void ws_send_handshake(void) {
-    char request[512];
-    const char *path = ws_ctx.config.path ? ws_ctx.config.path : "/";
+// Format the current piece into out; returns its length, or -1 if it doesn't fit
+static int ws_hs_piece(char *out, size_t size) {
+    const sinricpro_ws_config_t *cfg = &ws_ctx.config;
+    int len = 0;
 
-    // Build HTTP upgrade request with SinricPro headers
-    int len = snprintf(request, sizeof(request),
-        "GET %s HTTP/1.1\r\n"
-        "Host: %s\r\n"
-        "Upgrade: websocket\r\n"
-        "Connection: Upgrade\r\n"
-        "Sec-WebSocket-Key: %s\r\n"
-        "Sec-WebSocket-Version: 13\r\n",
-        path,
-        ws_ctx.config.host,
-        ws_ctx.ws_key);
+    switch (ws_ctx.hs.stage) {
+        case WS_HS_REQUEST_LINE:
+            len = snprintf(out, size, "GET %s HTTP/1.1\r\n", cfg->path ? cfg->path : "/");
+            break;
 
-    // Add SinricPro specific headers
-    if (ws_ctx.config.app_key) {
-        len += snprintf(request + len, sizeof(request) - len,
-            "appkey: %s\r\n", ws_ctx.config.app_key);
-    }
+        case WS_HS_HOST:
+            len = snprintf(out, size, "Host: %s\r\n", ws_server(ws_ctx.active_server)->host);
+            break;
 
-    if (ws_ctx.config.device_ids) {
-        len += snprintf(request + len, sizeof(request) - len,
-            "deviceids: %s\r\n", ws_ctx.config.device_ids);
-    }
+        case WS_HS_UPGRADE:
+            len = snprintf(out, size, "Upgrade: websocket\r\nConnection: Upgrade\r\n");
+            break;
 
-    len += snprintf(request + len, sizeof(request) - len,
-        "restoredevicestates: false\r\n");
+        case WS_HS_KEY:
+            len = snprintf(out, size, "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n",
+                           ws_ctx.ws_key);
+            break;
 
-    if (ws_ctx.config.platform) {
-        len += snprintf(request + len, sizeof(request) - len,
-            "platform: %s\r\n", ws_ctx.config.platform);
-    }
+        // Add SinricPro specific headers
+        case WS_HS_APP_KEY:
+            if (cfg->app_key) {
+                len = snprintf(out, size, "appkey: %s\r\n", cfg->app_key);
+            }
+            break;
 
-    if (ws_ctx.config.sdk_version) {
-        len += snprintf(request + len, sizeof(request) - len,
-            "SDKVersion: %s\r\n", ws_ctx.config.sdk_version);
+        case WS_HS_DEVICE_IDS_NAME:
+            if (cfg->device_id_at) {
+                len = snprintf(out, size, "deviceids: ");
+            }
+            break;
+
+        case WS_HS_DEVICE_ID:
+            if (cfg->device_id_at) {
+                char id[SINRICPRO_DEVICE_ID_LENGTH + 1];
+                if (cfg->device_id_at(ws_ctx.hs.device_index, id, sizeof(id), cfg->user_data)) {
+                    len = snprintf(out, size, "%s%s", ws_ctx.hs.device_index > 0 ? ";" : "", id);
+                }
+            }
+            break;
+
+        case WS_HS_DEVICE_IDS_END:
+            if (cfg->device_id_at) {
+                len = snprintf(out, size, "\r\n");
+            }
+            break;
+
+        case WS_HS_RESTORE:
+            len = snprintf(out, size, "restoredevicestates: %s\r\n",
+                           cfg->restore_states ? "true" : "false");
+            break;
+
+        case WS_HS_PLATFORM:
+            if (cfg->platform) {
+                len = snprintf(out, size, "platform: %s\r\n", cfg->platform);
+            }
+            break;
+
+        case WS_HS_SDK_VERSION:
+            if (cfg->sdk_version) {
+                len = snprintf(out, size, "SDKVersion: %s\r\n", cfg->sdk_version);
+            }
+            break;
+
+        // Add IP and MAC address (required by SinricPro server)
+        case WS_HS_IP: {
+            extern struct netif *netif_default;
+            if (netif_default && netif_is_up(netif_default)) {
+                len = snprintf(out, size, "ip: %s\r\n",
+                               ip4addr_ntoa(netif_ip4_addr(netif_default)));
+            }
+            break;
+        }
+
+        case WS_HS_MAC: {
+            extern cyw43_t cyw43_state;
+            len = snprintf(out, size, "mac: %02x:%02x:%02x:%02x:%02x:%02x\r\n",
+                           cyw43_state.mac[0], cyw43_state.mac[1], cyw43_state.mac[2],
+                           cyw43_state.mac[3], cyw43_state.mac[4], cyw43_state.mac[5]);
+            break;
+        }
+
+        case WS_HS_END:
+            len = snprintf(out, size, "\r\n");
+            break;
+
+        default:
+            break;
     }
 
-    // Add IP and MAC address (required by SinricPro server)
-    char ip_str[16];
-    char mac_str[18];
+    return (len < 0 || (size_t)len >= size) ? -1 : len;
+}
 
-    // Get IP address
-    extern struct netif *netif_default;
-    if (netif_default && netif_is_up(netif_default)) {
-        snprintf(ip_str, sizeof(ip_str), "%s", ip4addr_ntoa(netif_ip4_addr(netif_default)));
-        len += snprintf(request + len, sizeof(request) - len,
-            "ip: %s\r\n", ip_str);
+static void ws_hs_advance(void) {
+    if (ws_ctx.hs.stage == WS_HS_DEVICE_ID && ws_ctx.config.device_id_at) {
+        char id[SINRICPRO_DEVICE_ID_LENGTH + 1];
+        ws_ctx.hs.device_index++;
+        if (ws_ctx.config.device_id_at(ws_ctx.hs.device_index, id, sizeof(id),
+                                       ws_ctx.config.user_data)) {
+            return;
+        }
     }
+    ws_ctx.hs.stage++;
+}
 
-    // Get MAC address
-    extern cyw43_t cyw43_state;
-    snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
-             cyw43_state.mac[0], cyw43_state.mac[1], cyw43_state.mac[2],
-             cyw43_state.mac[3], cyw43_state.mac[4], cyw43_state.mac[5]);
-    len += snprintf(request + len, sizeof(request) - len,
-        "mac: %s\r\n", mac_str);
+// Pack as many pieces as fit into the chunk and write it out, until the
+// request is complete or the send buffer is full (resumed from ws_tcp_sent)
+static bool ws_handshake_continue(void) {
+    ws_hs_writer_t *hs = &ws_ctx.hs;
+
+    while (hs->stage != WS_HS_DONE || hs->chunk_len > 0) {
+        while (hs->stage != WS_HS_DONE) {
+            int len = ws_hs_piece(hs->chunk + hs->chunk_len,
+                                  sizeof(hs->chunk) - hs->chunk_len);
+            if (len < 0) {
+                if (hs->chunk_len == 0) {
+                    SINRICPRO_ERROR_PRINTF("[WS] Handshake header too long\n");
+                    ws_connect_failed();
+                    return false;
+                }
+                break;  // Flush first
+            }
+            hs->chunk_len += len;
+            ws_hs_advance();
+        }
 
-    len += snprintf(request + len, sizeof(request) - len, "\r\n");
+        if (altcp_sndbuf(ws_ctx.pcb) < hs->chunk_len) {
+            return true;  // Wait for sent callback
+        }
 
-    err_t err = altcp_write(ws_ctx.pcb, request, len, TCP_WRITE_FLAG_COPY);
-    if (err == ERR_OK) {
-        altcp_output(ws_ctx.pcb);
-        SINRICPRO_DEBUG_PRINTF("[WS] Handshake sent\n");
-    } else {
-        SINRICPRO_ERROR_PRINTF("[WS] Failed to send handshake: %d\n", err);
-        ws_set_state(WS_STATE_ERROR);
+        u8_t flags = TCP_WRITE_FLAG_COPY;
+        if (hs->stage != WS_HS_DONE) {
+            flags |= TCP_WRITE_FLAG_MORE;
+        }
+
+        err_t err = altcp_write(ws_ctx.pcb, hs->chunk, hs->chunk_len, flags);
+        if (err == ERR_MEM) {
+            return true;  // Wait for sent callback
+        }
+        if (err != ERR_OK) {
+            SINRICPRO_ERROR_PRINTF("[WS] Failed to send handshake: %d\n", err);
+            ws_connect_failed();
+            return false;
+        }
+        hs->chunk_len = 0;
     }
+
+    altcp_output(ws_ctx.pcb);
+    SINRICPRO_DEBUG_PRINTF("[WS] Handshake sent\n");
+    return true;
+}
+
+static bool ws_handshake_pending(void) {
+    return ws_ctx.pcb && (ws_ctx.hs.stage != WS_HS_DONE || ws_ctx.hs.chunk_len > 0);
+}
+
+static bool ws_send_handshake(void) {
+    ws_ctx.hs.stage = WS_HS_REQUEST_LINE;
+    ws_ctx.hs.device_index = 0;
+    ws_ctx.hs.chunk_len = 0;
+
+    return ws_handshake_continue();
 }
 
 static err_t ws_tcp_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t err) {
     if (!p) {
         // Connection closed
         SINRICPRO_WARN_PRINTF("[WS] Connection closed by server\n");
-        sinricpro_ws_disconnect();
+        ws_close_active();
         return ERR_OK;
     }
 
@@ -474,53 +747,56 @@ static err_t ws_tcp_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t
         return err;
     }
 
-    // Copy data to receive buffer
-    struct pbuf *q = p;
-    while (q != NULL) {
-        size_t copy_len = q->len;
-        if (ws_ctx.rx_len + copy_len > WS_RX_BUFFER_SIZE) {
-            copy_len = WS_RX_BUFFER_SIZE - ws_ctx.rx_len;
-        }
+    bool upgrade_failed = false;
 
-        memcpy(ws_ctx.rx_buffer + ws_ctx.rx_len, q->payload, copy_len);
-        ws_ctx.rx_len += copy_len;
-        q = q->next;
-    }
+    for (struct pbuf *q = p; q != NULL; q = q->next) {
+        const uint8_t *data = (const uint8_t *)q->payload;
+        size_t len = q->len;
 
-    altcp_recved(pcb, p->tot_len);
-    pbuf_free(p);
+        // Feed the upgrade response parser until the header block ends
+        if (!ws_ctx.handshake_complete) {
+            size_t used = 0;
+            sinricpro_http_upgrade_result_t result =
+                sinricpro_http_upgrade_feed(&ws_ctx.upgrade, data, len, &used);
 
-    // Process received data
-    if (!ws_ctx.handshake_complete) {
-        // Look for end of HTTP response
-        ws_ctx.rx_buffer[ws_ctx.rx_len] = '\0';
-        char *header_end = strstr((char *)ws_ctx.rx_buffer, "\r\n\r\n");
+            if (result == HTTP_UPGRADE_MORE) {
+                continue;
+            }
 
-        if (header_end) {
-            size_t header_len = (header_end + 4) - (char *)ws_ctx.rx_buffer;
+            if (result == HTTP_UPGRADE_ERROR || !ws_verify_upgrade(&ws_ctx.upgrade)) {
+                upgrade_failed = true;
+                break;
+            }
 
-            if (ws_parse_handshake_response((char *)ws_ctx.rx_buffer, header_len)) {
-                ws_ctx.handshake_complete = true;
-                ws_set_state(WS_STATE_CONNECTED);
-                ws_ctx.last_pong_received = get_millis();
-                SINRICPRO_DEBUG_PRINTF("[WS] Connected!\n");
+            ws_ctx.handshake_complete = true;
+            ws_ctx.rx_len = 0;
+            ws_set_state(WS_STATE_CONNECTED);
+            ws_ctx.last_pong_received = get_millis();
+            SINRICPRO_DEBUG_PRINTF("[WS] Connected!\n");
 
-                // Remove header from buffer
-                if (ws_ctx.rx_len > header_len) {
-                    memmove(ws_ctx.rx_buffer, ws_ctx.rx_buffer + header_len,
-                            ws_ctx.rx_len - header_len);
-                    ws_ctx.rx_len -= header_len;
-                } else {
-                    ws_ctx.rx_len = 0;
-                }
-            } else {
-                SINRICPRO_ERROR_PRINTF("[WS] Handshake failed\n");
-                ws_set_state(WS_STATE_ERROR);
-                sinricpro_ws_disconnect();
-            }
+            // Frame bytes in the same segment go to the frame decoder
+            data += used;
+            len -= used;
         }
+
+        // Copy data to receive buffer
+        if (ws_ctx.rx_len + len > WS_RX_BUFFER_SIZE) {
+            len = WS_RX_BUFFER_SIZE - ws_ctx.rx_len;
+        }
+        memcpy(ws_ctx.rx_buffer + ws_ctx.rx_len, data, len);
+        ws_ctx.rx_len += len;
+    }
+
+    if (upgrade_failed) {
+        SINRICPRO_ERROR_PRINTF("[WS] Handshake failed\n");
+        pbuf_free(p);
+        ws_connect_failed();
+        return ERR_ABRT;
     }
 
+    altcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
     if (ws_ctx.handshake_complete && ws_ctx.rx_len > 0) {
         ws_process_frame(ws_ctx.rx_buffer, ws_ctx.rx_len);
     }
@@ -530,26 +806,42 @@ static err_t ws_tcp_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t
 
 static void ws_tcp_err(void *arg, err_t err) {
     SINRICPRO_ERROR_PRINTF("[WS] TCP error: %d\n", err);
-    ws_ctx.pcb = NULL;
-    ws_ctx.last_disconnect_time = get_millis();
+    ws_ctx.pcb = NULL;  // Already freed by lwIP
+
+    if (ws_ctx.state != WS_STATE_CONNECTED) {
+        ws_connect_failed();
+        return;
+    }
+
+    ws_ctx.link_lost = true;
+    ws_ctx.link_lost_time = get_millis();
+    ws_ctx.last_disconnect_time = ws_ctx.link_lost_time;
     ws_set_state(WS_STATE_ERROR);
 }
 
 static err_t ws_tcp_sent(void *arg, struct altcp_pcb *pcb, u16_t len) {
-    // Data sent successfully
+    // Send buffer space freed: resume a handshake that was waiting for it
+    if (ws_ctx.state == WS_STATE_WS_HANDSHAKE && ws_handshake_pending()) {
+        if (!ws_handshake_continue()) {
+            return ERR_ABRT;
+        }
+    }
     return ERR_OK;
 }
 
-static bool ws_parse_handshake_response(const char *response, size_t len) {
-    // Check for "101 Switching Protocols"
-    if (!strstr(response, "101")) {
-        SINRICPRO_ERROR_PRINTF("[WS] Server rejected upgrade: %.100s\n", response);
+static bool ws_verify_upgrade(const sinricpro_http_upgrade_t *upgrade) {
+    if (!upgrade->upgrade_websocket || !upgrade->connection_upgrade) {
+        SINRICPRO_ERROR_PRINTF("[WS] Missing Upgrade/Connection header\n");
         return false;
     }
 
-    // Verify Sec-WebSocket-Accept
-    char *accept_header = strstr(response, "Sec-WebSocket-Accept:");
-    if (!accept_header) {
+    // No extensions are offered, so the server must not select any (RFC 6455 4.1)
+    if (upgrade->extensions[0] != '\0') {
+        SINRICPRO_ERROR_PRINTF("[WS] Unexpected extensions: %s\n", upgrade->extensions);
+        return false;
+    }
+
+    if (upgrade->accept[0] == '\0') {
         SINRICPRO_ERROR_PRINTF("[WS] Missing Sec-WebSocket-Accept header\n");
         return false;
     }
@@ -567,7 +859,7 @@ static bool ws_parse_handshake_response(const char *response, size_t len) {
                           &olen, sha1_hash, 20);
 
     // Check if server accept matches
-    if (!strstr(accept_header, expected_accept)) {
+    if (strcmp(upgrade->accept, expected_accept) != 0) {
         SINRICPRO_ERROR_PRINTF("[WS] Invalid Sec-WebSocket-Accept\n");
         return false;
     }
@@ -677,7 +969,7 @@ static void ws_process_frame(const uint8_t *data, size_t len) {
 
             case WS_OPCODE_CLOSE:
                 SINRICPRO_DEBUG_PRINTF("[WS] Server sent close frame\n");
-                sinricpro_ws_disconnect();
+                ws_close_active();
                 return;
 
             default:
@@ -752,3 +1044,171 @@ static size_t ws_encode_frame(uint8_t opcode, const uint8_t *data, size_t len,
 
     return offset + len;
 }
+
+// ============================================================================
+// Warm Standby
+// ============================================================================
+
+static void ws_standby_drop(void) {
+    if (ws_ctx.standby.state == WS_STANDBY_READY) {
+        ws_ctx.stats.standby_drops++;
+    }
+    ws_ctx.standby.pcb = NULL;
+    ws_ctx.standby.state = WS_STANDBY_IDLE;
+    ws_ctx.standby.last_attempt = get_millis();
+}
+
+static err_t ws_standby_recv(void *arg, struct altcp_pcb *pcb, struct pbuf *p, err_t err) {
+    if (!p) {
+        SINRICPRO_DEBUG_PRINTF("[WS] Standby closed by server\n");
+        ws_standby_close();
+        return ERR_OK;
+    }
+
+    // Nothing is expected before the upgrade request is sent
+    altcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void ws_standby_err(void *arg, err_t err) {
+    SINRICPRO_DEBUG_PRINTF("[WS] Standby error: %d\n", err);
+    ws_standby_drop();  // PCB already freed by lwIP
+}
+
+static err_t ws_standby_connected(void *arg, struct altcp_pcb *pcb, err_t err) {
+    if (err != ERR_OK) {
+        ws_standby_close();
+        return err;
+    }
+
+    SINRICPRO_DEBUG_PRINTF("[WS] Standby ready (server %u)\n", ws_ctx.standby.server);
+    ws_ctx.standby.state = WS_STANDBY_READY;
+    return ERR_OK;
+}
+
+static void ws_standby_dns_callback(const char *name, const ip_addr_t *addr, void *arg) {
+    ws_standby_t *standby = (ws_standby_t *)arg;
+
+    if (standby->state != WS_STANDBY_RESOLVING) {
+        return;
+    }
+
+    if (!addr) {
+        ws_standby_drop();
+        return;
+    }
+
+    ip_addr_copy(standby->server_ip, *addr);
+
+    struct altcp_pcb *pcb = ws_new_pcb();
+    if (!pcb) {
+        ws_standby_drop();
+        return;
+    }
+
+    standby->pcb = pcb;
+    standby->state = WS_STANDBY_CONNECTING;
+
+    altcp_arg(pcb, standby);
+    altcp_recv(pcb, ws_standby_recv);
+    altcp_err(pcb, ws_standby_err);
+    altcp_sent(pcb, NULL);
+
+    if (altcp_connect(pcb, &standby->server_ip, ws_server(standby->server)->port,
+                      ws_standby_connected) != ERR_OK) {
+        ws_standby_close();
+    }
+}
+
+// Next server after the active one on another host or port, or the active
+// server if the list has no other
+static uint8_t ws_standby_server(void) {
+    const sinricpro_ws_server_t *active = ws_server(ws_ctx.active_server);
+
+    for (size_t i = 1; i < ws_ctx.config.server_count; i++) {
+        uint8_t index = (uint8_t)((ws_ctx.active_server + i) % ws_ctx.config.server_count);
+        const sinricpro_ws_server_t *server = ws_server(index);
+        if (server->port != active->port || strcasecmp(server->host, active->host) != 0) {
+            return index;
+        }
+    }
+    return ws_ctx.active_server;
+}
+
+static void ws_standby_maintain(uint32_t now) {
+    if (!ws_ctx.config.warm_standby || ws_ctx.standby.state != WS_STANDBY_IDLE) {
+        return;
+    }
+
+    if ((now - ws_ctx.standby.last_attempt) < ws_ctx.reconnect_delay_ms) {
+        return;
+    }
+
+    // Distinct from the active server, checked in sinricpro_ws_connect()
+    ws_ctx.standby.server = ws_standby_server();
+    ws_ctx.standby.state = WS_STANDBY_RESOLVING;
+    ws_ctx.standby.last_attempt = now;
+
+    const char *host = ws_server(ws_ctx.standby.server)->host;
+    err_t err = dns_gethostbyname(host, &ws_ctx.standby.server_ip,
+                                  ws_standby_dns_callback, &ws_ctx.standby);
+
+    if (err == ERR_OK) {
+        ws_standby_dns_callback(host, &ws_ctx.standby.server_ip, &ws_ctx.standby);
+    } else if (err != ERR_INPROGRESS) {
+        ws_standby_drop();
+    }
+}
+
+static void ws_standby_close(void) {
+    if (ws_ctx.standby.pcb) {
+        altcp_arg(ws_ctx.standby.pcb, NULL);
+        altcp_err(ws_ctx.standby.pcb, NULL);
+        altcp_recv(ws_ctx.standby.pcb, NULL);
+        if (altcp_close(ws_ctx.standby.pcb) != ERR_OK) {
+            altcp_abort(ws_ctx.standby.pcb);
+        }
+    }
+
+    ws_standby_drop();
+}
+
+static bool ws_promote_standby(void) {
+    if (ws_ctx.standby.state != WS_STANDBY_READY || !ws_ctx.standby.pcb) {
+        return false;
+    }
+
+    SINRICPRO_DEBUG_PRINTF("[WS] Failover to standby (server %u)\n", ws_ctx.standby.server);
+
+    struct altcp_pcb *pcb = ws_ctx.standby.pcb;
+    ws_ctx.pcb = pcb;
+    ws_ctx.active_server = ws_ctx.standby.server;
+    ip_addr_copy(ws_ctx.server_ip, ws_ctx.standby.server_ip);
+
+    ws_ctx.standby.pcb = NULL;
+    ws_ctx.standby.state = WS_STANDBY_IDLE;
+    ws_ctx.standby.last_attempt = get_millis();
+
+    // Hand the transport over to the active callbacks
+    altcp_arg(pcb, NULL);
+    altcp_recv(pcb, ws_tcp_recv);
+    altcp_err(pcb, ws_tcp_err);
+    altcp_sent(pcb, ws_tcp_sent);
+
+    ws_ctx.rx_len = 0;
+    ws_ctx.handshake_complete = false;
+    sinricpro_http_upgrade_init(&ws_ctx.upgrade);
+    ws_ctx.ping_pending = false;
+    ws_ctx.frame_in_progress = false;
+    ws_ctx.last_pong_received = get_millis();
+    ws_ctx.connect_started = get_millis();
+    ws_generate_key(ws_ctx.ws_key);
+
+    ws_ctx.stats.failovers++;
+
+    // Transport is already up, only the HTTP upgrade is left
+    ws_set_state(WS_STATE_WS_HANDSHAKE);
+    ws_send_handshake();
+    return true;
+}
@@ -31,6 +31,16 @@ typedef enum {
     WS_STATE_ERROR
 } sinricpro_ws_state_t;
 
+/**
+ * @brief Warm standby connection state
+ */
+typedef enum {
+    WS_STANDBY_IDLE = 0,                // No standby connection
+    WS_STANDBY_RESOLVING,               // DNS lookup in progress
+    WS_STANDBY_CONNECTING,              // TCP/TLS connect in progress
+    WS_STANDBY_READY                    // Connected, waiting for promotion
+} sinricpro_ws_standby_state_t;
+
 /**
  * @brief WebSocket opcode types (RFC 6455)
  */
@@ -64,19 +74,45 @@ typedef void (*sinricpro_ws_state_callback_t)(sinricpro_ws_state_t state,
                                                void *user_data);
 
 /**
- * @brief WebSocket client configuration
+ * @brief Device ID iterator for the handshake deviceids header
+ *
+ * Called while the upgrade request is being streamed, so the ID list is
+ * never assembled in one buffer. The ID is copied out because the registry
+ * may change between calls.
+ *
+ * @param index     Zero-based device position
+ * @param id        Output buffer for the NUL-terminated device ID
+ * @param size      Buffer size
+ * @param user_data User data pointer
+ * @return false past the last device
+ */
+typedef bool (*sinricpro_ws_device_id_callback_t)(size_t index, char *id, size_t size,
+                                                  void *user_data);
+
+/**
+ * @brief Server endpoint
  */
 typedef struct {
     const char *host;                   // Server hostname
     uint16_t port;                      // Server port (443 for WSS)
+} sinricpro_ws_server_t;
+
+/**
+ * @brief WebSocket client configuration
+ */
+typedef struct {
+    const sinricpro_ws_server_t *servers;   // Ordered server list (must stay valid)
+    size_t server_count;                // Number of servers (at least 1)
     const char *path;                   // Path (e.g., "/")
     bool use_ssl;                       // Use TLS/SSL
+    bool warm_standby;                  // Keep a pre-connected standby transport
 
     // Custom headers (for SinricPro authentication)
     const char *app_key;                // SinricPro app key
-    const char *device_ids;             // Semicolon-separated device IDs
+    sinricpro_ws_device_id_callback_t device_id_at;   // Device IDs for "deviceids"
     const char *platform;               // Platform identifier
     const char *sdk_version;            // SDK version string
+    bool restore_states;                // Ask for device states ("restoredevicestates")
 
     // Callbacks
     sinricpro_ws_message_callback_t on_message;
@@ -92,6 +128,22 @@ typedef struct {
     bool enable_debug;                  // Enable message logging
 } sinricpro_ws_config_t;
 
+/**
+ * @brief Connection and failover statistics
+ */
+typedef struct {
+    uint8_t active_server;              // Index of the server in use
+    uint8_t standby_server;             // Index of the standby target
+    sinricpro_ws_state_t active_state;
+    sinricpro_ws_standby_state_t standby_state;
+    uint32_t failovers;                 // Recoveries by promoting the standby
+    uint32_t cold_reconnects;           // Recoveries by a full DNS/TCP/TLS handshake
+    uint32_t connect_failures;          // Attempts that failed or timed out
+    uint32_t standby_drops;             // Standby connections lost while idle
+    uint32_t last_recovery_ms;          // Link loss to upgrade complete, last recovery
+    uint32_t reannounces;               // Reconnects requested by sinricpro_ws_reannounce()
+} sinricpro_ws_stats_t;
+
 /**
  * @brief Initialize WebSocket client subsystem
  *
@@ -129,6 +181,16 @@ void sinricpro_ws_disconnect(void);
  */
 void sinricpro_ws_handle(void);
 
+/**
+ * @brief Re-send the device list
+ *
+ * The device list is only sent in the upgrade request, so a connection
+ * whose upgrade already carried the list is closed and re-established at
+ * once (through the warm standby when it is ready). Does nothing while
+ * disconnected or before the upgrade request starts.
+ */
+void sinricpro_ws_reannounce(void);
+
 /**
  * @brief Send a text message over WebSocket
  *
@@ -159,6 +221,16 @@ sinricpro_ws_state_t sinricpro_ws_get_state(void);
  */
 bool sinricpro_ws_is_connected(void);
 
+/**
+ * @brief Check if a frame may be written from the current context
+ *
+ * False while connecting or while sinricpro_ws_send() is writing, so a
+ * receive callback run from inside the write doesn't re-enter altcp_write.
+ *
+ * @return true if sinricpro_ws_send() can be called now
+ */
+bool sinricpro_ws_can_send_now(void);
+
 /**
  * @brief Get time since last successful ping/pong
  *
@@ -166,6 +238,13 @@ bool sinricpro_ws_is_connected(void);
  */
 uint32_t sinricpro_ws_get_last_pong_age(void);
 
+/**
+ * @brief Get connection and failover statistics
+ *
+ * @param stats Output statistics
+ */
+void sinricpro_ws_get_stats(sinricpro_ws_stats_t *stats);
+
 /**
  * @brief Set reconnect behavior
  *
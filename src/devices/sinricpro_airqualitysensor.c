@@ -4,28 +4,28 @@
  */
 
 #include "sinricpro/sinricpro_airqualitysensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/air_quality_sensor.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-static bool airqualitysensor_handle_request(sinricpro_device_t *device,
-                                              const char *action,
-                                              const cJSON *request,
-                                              cJSON *response);
+static const sinricpro_capability_slot_t airqualitysensor_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_airqualitysensor_t, air_quality_sensor,
+                         sinricpro_capability_air_quality_sensor),
+};
+
+static const sinricpro_device_model_t airqualitysensor_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_AIR_QUALITY_SENSOR, airqualitysensor_slots);
 
 bool sinricpro_airqualitysensor_init(sinricpro_airqualitysensor_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_AIR_QUALITY_SENSOR)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &airqualitysensor_model)) {
         return false;
     }
 
-    device->base.handle_request = airqualitysensor_handle_request;
-
-    sinricpro_air_quality_sensor_init(&device->air_quality_sensor);
-
     SINRICPRO_DEBUG_PRINTF("[AirQualitySensor] Initialized device: %s\n", device_id);
     return true;
 }
@@ -39,12 +39,3 @@ bool sinricpro_airqualitysensor_send_event(sinricpro_airqualitysensor_t *device,
                                                      device->base.device_id,
                                                      pm1, pm2_5, pm10);
 }
-
-static bool airqualitysensor_handle_request(sinricpro_device_t *device,
-                                              const char *action,
-                                              const cJSON *request,
-                                              cJSON *response) {
-    // Air quality sensor is event-only, no incoming commands
-    SINRICPRO_WARN_PRINTF("[AirQualitySensor] Unknown action: %s\n", action);
-    return false;
-}
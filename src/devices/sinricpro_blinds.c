@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/sinricpro_blinds.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "sinricpro/capabilities/range_controller.h"
 #include "core/json_helpers.h"
@@ -11,23 +12,22 @@
 #include <stdio.h>
 #include <string.h>
 
-static bool blinds_handle_request(sinricpro_device_t *device,
-                                    const char *action,
-                                    const cJSON *request,
-                                    cJSON *response);
+static const sinricpro_capability_slot_t blinds_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_blinds_t, power_state, sinricpro_capability_power_state),
+    SINRICPRO_CAPABILITY(sinricpro_blinds_t, range_controller,
+                         sinricpro_capability_range_controller),
+};
+
+static const sinricpro_device_model_t blinds_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_BLINDS, blinds_slots);
 
 bool sinricpro_blinds_init(sinricpro_blinds_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_BLINDS)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &blinds_model)) {
         return false;
     }
 
-    device->base.handle_request = blinds_handle_request;
-
-    sinricpro_power_state_init(&device->power_state);
-    sinricpro_range_controller_init(&device->range_controller);
-
     SINRICPRO_DEBUG_PRINTF("[Blinds] Initialized device: %s\n", device_id);
     return true;
 }
@@ -76,28 +76,3 @@ int sinricpro_blinds_get_position(const sinricpro_blinds_t *device) {
     if (!device) return 0;
     return sinricpro_range_controller_get_value(&device->range_controller);
 }
-
-static bool blinds_handle_request(sinricpro_device_t *device,
-                                    const char *action,
-                                    const cJSON *request,
-                                    cJSON *response) {
-    sinricpro_blinds_t *blinds = (sinricpro_blinds_t *)device;
-
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&blinds->power_state,
-                                                     device, request, response);
-    }
-
-    if (strcmp(action, "setRangeValue") == 0) {
-        return sinricpro_range_controller_handle_set_request(&blinds->range_controller,
-                                                              device, request, response);
-    }
-
-    if (strcmp(action, "adjustRangeValue") == 0) {
-        return sinricpro_range_controller_handle_adjust_request(&blinds->range_controller,
-                                                                 device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Blinds] Unknown action: %s\n", action);
-    return false;
-}
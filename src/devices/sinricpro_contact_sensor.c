@@ -4,17 +4,19 @@
  */
 
 #include "sinricpro/sinricpro_contact_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/contact_sensor.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-// Forward declaration
-static bool contact_sensor_handle_request(sinricpro_device_t *device,
-                                          const char *action,
-                                          const cJSON *request,
-                                          cJSON *response);
+static const sinricpro_capability_slot_t contact_sensor_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_contact_sensor_t, contact, sinricpro_capability_contact_sensor),
+};
+
+static const sinricpro_device_model_t contact_sensor_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_CONTACT_SENSOR, contact_sensor_slots);
 
 bool sinricpro_contact_sensor_init(sinricpro_contact_sensor_t *device,
                                    const char *device_id) {
@@ -22,18 +24,10 @@ bool sinricpro_contact_sensor_init(sinricpro_contact_sensor_t *device,
         return false;
     }
 
-    // Initialize base device
-    if (!sinricpro_device_init(&device->base, device_id,
-                               SINRICPRO_DEVICE_TYPE_CONTACT_SENSOR)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &contact_sensor_model)) {
         return false;
     }
 
-    // Set request handler
-    device->base.handle_request = contact_sensor_handle_request;
-
-    // Initialize capabilities
-    sinricpro_contact_sensor_cap_init(&device->contact);
-
     SINRICPRO_DEBUG_PRINTF("[ContactSensor] Initialized device: %s\n", device_id);
     return true;
 }
@@ -48,15 +42,3 @@ bool sinricpro_contact_sensor_send_event(sinricpro_contact_sensor_t *device,
                                                    device->base.device_id,
                                                    is_open);
 }
-
-// Handle incoming requests (sensors typically don't receive many commands)
-static bool contact_sensor_handle_request(sinricpro_device_t *device,
-                                          const char *action,
-                                          const cJSON *request,
-                                          cJSON *response) {
-    // Contact sensors are event-only devices
-    // Could implement state query if needed in future
-
-    SINRICPRO_WARN_PRINTF("[ContactSensor] Unknown action: %s\n", action);
-    return false;
-}
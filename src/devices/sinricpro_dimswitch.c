@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/sinricpro_dimswitch.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "sinricpro/capabilities/power_level.h"
 #include "core/json_helpers.h"
@@ -11,30 +12,23 @@
 #include <stdio.h>
 #include <string.h>
 
-// Forward declaration
-static bool dimswitch_handle_request(sinricpro_device_t *device,
-                                     const char *action,
-                                     const cJSON *request,
-                                     cJSON *response);
+static const sinricpro_capability_slot_t dimswitch_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_dimswitch_t, power_state, sinricpro_capability_power_state),
+    SINRICPRO_CAPABILITY(sinricpro_dimswitch_t, power_level, sinricpro_capability_power_level),
+};
+
+static const sinricpro_device_model_t dimswitch_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_DIMSWITCH, dimswitch_slots);
 
 bool sinricpro_dimswitch_init(sinricpro_dimswitch_t *device, const char *device_id) {
     if (!device || !device_id) {
         return false;
     }
 
-    // Initialize base device
-    if (!sinricpro_device_init(&device->base, device_id,
-                               SINRICPRO_DEVICE_TYPE_DIMSWITCH)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &dimswitch_model)) {
         return false;
     }
 
-    // Set request handler
-    device->base.handle_request = dimswitch_handle_request;
-
-    // Initialize capabilities
-    sinricpro_power_state_init(&device->power_state);
-    sinricpro_power_level_init(&device->power_level);
-
     SINRICPRO_DEBUG_PRINTF("[DimSwitch] Initialized device: %s\n", device_id);
     return true;
 }
@@ -95,33 +89,3 @@ int sinricpro_dimswitch_get_power_level(const sinricpro_dimswitch_t *device) {
 
     return sinricpro_power_level_get_value(&device->power_level);
 }
-
-// ============================================================================
-// Internal Functions
-// ============================================================================
-
-static bool dimswitch_handle_request(sinricpro_device_t *device,
-                                     const char *action,
-                                     const cJSON *request,
-                                     cJSON *response) {
-    // Cast to dimswitch device
-    sinricpro_dimswitch_t *dimswitch = (sinricpro_dimswitch_t *)device;
-
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&dimswitch->power_state,
-                                                    device, request, response);
-    }
-
-    if (strcmp(action, "setPowerLevel") == 0) {
-        return sinricpro_power_level_handle_set_request(&dimswitch->power_level,
-                                                        device, request, response);
-    }
-
-    if (strcmp(action, "adjustPowerLevel") == 0) {
-        return sinricpro_power_level_handle_adjust_request(&dimswitch->power_level,
-                                                           device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[DimSwitch] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/sinricpro_doorbell.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "sinricpro/capabilities/doorbell.h"
 #include "core/json_helpers.h"
@@ -11,23 +12,21 @@
 #include <stdio.h>
 #include <string.h>
 
-static bool doorbell_handle_request(sinricpro_device_t *device,
-                                      const char *action,
-                                      const cJSON *request,
-                                      cJSON *response);
+static const sinricpro_capability_slot_t doorbell_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_doorbell_t, power_state, sinricpro_capability_power_state),
+    SINRICPRO_CAPABILITY(sinricpro_doorbell_t, doorbell, sinricpro_capability_doorbell),
+};
+
+static const sinricpro_device_model_t doorbell_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_DOORBELL, doorbell_slots);
 
 bool sinricpro_doorbell_init(sinricpro_doorbell_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_DOORBELL)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &doorbell_model)) {
         return false;
     }
 
-    device->base.handle_request = doorbell_handle_request;
-
-    sinricpro_power_state_init(&device->power_state);
-    sinricpro_doorbell_cap_init(&device->doorbell);
-
     SINRICPRO_DEBUG_PRINTF("[Doorbell] Initialized device: %s\n", device_id);
     return true;
 }
@@ -51,18 +50,3 @@ bool sinricpro_doorbell_send_power_state_event(sinricpro_doorbell_t *device, boo
                                              device->base.device_id,
                                              state);
 }
-
-static bool doorbell_handle_request(sinricpro_device_t *device,
-                                      const char *action,
-                                      const cJSON *request,
-                                      cJSON *response) {
-    sinricpro_doorbell_t *doorbell = (sinricpro_doorbell_t *)device;
-
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&doorbell->power_state,
-                                                     device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Doorbell] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/sinricpro_fan.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "sinricpro/capabilities/power_level.h"
 #include "core/json_helpers.h"
@@ -11,23 +12,21 @@
 #include <stdio.h>
 #include <string.h>
 
-static bool fan_handle_request(sinricpro_device_t *device,
-                                const char *action,
-                                const cJSON *request,
-                                cJSON *response);
+static const sinricpro_capability_slot_t fan_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_fan_t, power_state, sinricpro_capability_power_state),
+    SINRICPRO_CAPABILITY(sinricpro_fan_t, power_level, sinricpro_capability_power_level),
+};
+
+static const sinricpro_device_model_t fan_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_FAN, fan_slots);
 
 bool sinricpro_fan_init(sinricpro_fan_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_FAN)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &fan_model)) {
         return false;
     }
 
-    device->base.handle_request = fan_handle_request;
-
-    sinricpro_power_state_init(&device->power_state);
-    sinricpro_power_level_init(&device->power_level);
-
     SINRICPRO_DEBUG_PRINTF("[Fan] Initialized device: %s\n", device_id);
     return true;
 }
@@ -76,28 +75,3 @@ int sinricpro_fan_get_power_level(const sinricpro_fan_t *device) {
     if (!device) return 0;
     return sinricpro_power_level_get_value(&device->power_level);
 }
-
-static bool fan_handle_request(sinricpro_device_t *device,
-                                const char *action,
-                                const cJSON *request,
-                                cJSON *response) {
-    sinricpro_fan_t *fan = (sinricpro_fan_t *)device;
-
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&fan->power_state,
-                                                    device, request, response);
-    }
-
-    if (strcmp(action, "setPowerLevel") == 0) {
-        return sinricpro_power_level_handle_set_request(&fan->power_level,
-                                                        device, request, response);
-    }
-
-    if (strcmp(action, "adjustPowerLevel") == 0) {
-        return sinricpro_power_level_handle_adjust_request(&fan->power_level,
-                                                           device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Fan] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,28 +4,28 @@
  */
 
 #include "sinricpro/sinricpro_garagedoor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/door_controller.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-static bool garagedoor_handle_request(sinricpro_device_t *device,
-                                        const char *action,
-                                        const cJSON *request,
-                                        cJSON *response);
+static const sinricpro_capability_slot_t garagedoor_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_garagedoor_t, door_controller,
+                         sinricpro_capability_door_controller),
+};
+
+static const sinricpro_device_model_t garagedoor_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_GARAGE_DOOR, garagedoor_slots);
 
 bool sinricpro_garagedoor_init(sinricpro_garagedoor_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_GARAGE_DOOR)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &garagedoor_model)) {
         return false;
     }
 
-    device->base.handle_request = garagedoor_handle_request;
-
-    sinricpro_door_controller_init(&device->door_controller);
-
     SINRICPRO_DEBUG_PRINTF("[GarageDoor] Initialized device: %s\n", device_id);
     return true;
 }
@@ -48,18 +48,3 @@ bool sinricpro_garagedoor_is_closed(const sinricpro_garagedoor_t *device) {
     if (!device) return false;
     return sinricpro_door_controller_is_closed(&device->door_controller);
 }
-
-static bool garagedoor_handle_request(sinricpro_device_t *device,
-                                        const char *action,
-                                        const cJSON *request,
-                                        cJSON *response) {
-    sinricpro_garagedoor_t *door = (sinricpro_garagedoor_t *)device;
-
-    if (strcmp(action, "setMode") == 0) {
-        return sinricpro_door_controller_handle_request(&door->door_controller,
-                                                         device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[GarageDoor] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,6 +4,7 @@
  */
 
 #include "sinricpro/sinricpro_light.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "sinricpro/capabilities/brightness.h"
 #include "sinricpro/capabilities/color.h"
@@ -13,32 +14,25 @@
 #include <stdio.h>
 #include <string.h>
 
-// Forward declaration
-static bool light_handle_request(sinricpro_device_t *device,
-                                  const char *action,
-                                  const cJSON *request,
-                                  cJSON *response);
+static const sinricpro_capability_slot_t light_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_light_t, power_state, sinricpro_capability_power_state),
+    SINRICPRO_CAPABILITY(sinricpro_light_t, brightness, sinricpro_capability_brightness),
+    SINRICPRO_CAPABILITY(sinricpro_light_t, color, sinricpro_capability_color),
+    SINRICPRO_CAPABILITY(sinricpro_light_t, color_temp, sinricpro_capability_color_temperature),
+};
+
+static const sinricpro_device_model_t light_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_LIGHT, light_slots);
 
 bool sinricpro_light_init(sinricpro_light_t *device, const char *device_id) {
     if (!device || !device_id) {
         return false;
     }
 
-    // Initialize base device
-    if (!sinricpro_device_init(&device->base, device_id,
-                               SINRICPRO_DEVICE_TYPE_LIGHT)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &light_model)) {
         return false;
     }
 
-    // Set request handler
-    device->base.handle_request = light_handle_request;
-
-    // Initialize capabilities
-    sinricpro_power_state_init(&device->power_state);
-    sinricpro_brightness_init(&device->brightness);
-    sinricpro_color_init(&device->color);
-    sinricpro_color_temp_init(&device->color_temp);
-
     SINRICPRO_DEBUG_PRINTF("[Light] Initialized device: %s\n", device_id);
     return true;
 }
@@ -164,49 +158,3 @@ int sinricpro_light_get_color_temp(const sinricpro_light_t *device) {
 
     return sinricpro_color_temp_get_value(&device->color_temp);
 }
-
-// ============================================================================
-// Internal Functions
-// ============================================================================
-
-static bool light_handle_request(sinricpro_device_t *device,
-                                  const char *action,
-                                  const cJSON *request,
-                                  cJSON *response) {
-    // Cast to light device
-    sinricpro_light_t *light = (sinricpro_light_t *)device;
-
-    // PowerState
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&light->power_state,
-                                                    device, request, response);
-    }
-
-    // Brightness
-    if (strcmp(action, "setBrightness") == 0) {
-        return sinricpro_brightness_handle_set_request(&light->brightness,
-                                                       device, request, response);
-    }
-
-    if (strcmp(action, "adjustBrightness") == 0) {
-        return sinricpro_brightness_handle_adjust_request(&light->brightness,
-                                                          device, request, response);
-    }
-
-    // Color
-    if (strcmp(action, "setColor") == 0) {
-        return sinricpro_color_handle_request(&light->color,
-                                              device, request, response);
-    }
-
-    // Color Temperature
-    if (strcmp(action, "setColorTemperature") == 0 ||
-        strcmp(action, "increaseColorTemperature") == 0 ||
-        strcmp(action, "decreaseColorTemperature") == 0) {
-        return sinricpro_color_temp_handle_request(&light->color_temp,
-                                                   device, action, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Light] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,28 +4,27 @@
  */
 
 #include "sinricpro/sinricpro_lock.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/lock_controller.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-static bool lock_handle_request(sinricpro_device_t *device,
-                                 const char *action,
-                                 const cJSON *request,
-                                 cJSON *response);
+static const sinricpro_capability_slot_t lock_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_lock_t, lock_controller, sinricpro_capability_lock_controller),
+};
+
+static const sinricpro_device_model_t lock_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_LOCK, lock_slots);
 
 bool sinricpro_lock_init(sinricpro_lock_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_LOCK)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &lock_model)) {
         return false;
     }
 
-    device->base.handle_request = lock_handle_request;
-
-    sinricpro_lock_controller_init(&device->lock_controller);
-
     SINRICPRO_DEBUG_PRINTF("[Lock] Initialized device: %s\n", device_id);
     return true;
 }
@@ -48,18 +47,3 @@ bool sinricpro_lock_is_locked(const sinricpro_lock_t *device) {
     if (!device) return false;
     return sinricpro_lock_controller_is_locked(&device->lock_controller);
 }
-
-static bool lock_handle_request(sinricpro_device_t *device,
-                                 const char *action,
-                                 const cJSON *request,
-                                 cJSON *response) {
-    sinricpro_lock_t *lock = (sinricpro_lock_t *)device;
-
-    if (strcmp(action, "setLockState") == 0) {
-        return sinricpro_lock_controller_handle_request(&lock->lock_controller,
-                                                         device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Lock] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,28 +4,27 @@
  */
 
 #include "sinricpro/sinricpro_powersensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_sensor.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-static bool powersensor_handle_request(sinricpro_device_t *device,
-                                         const char *action,
-                                         const cJSON *request,
-                                         cJSON *response);
+static const sinricpro_capability_slot_t powersensor_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_powersensor_t, power_sensor, sinricpro_capability_power_sensor),
+};
+
+static const sinricpro_device_model_t powersensor_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_POWER_SENSOR, powersensor_slots);
 
 bool sinricpro_powersensor_init(sinricpro_powersensor_t *device, const char *device_id) {
     if (!device || !device_id) return false;
 
-    if (!sinricpro_device_init(&device->base, device_id, SINRICPRO_DEVICE_TYPE_POWER_SENSOR)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &powersensor_model)) {
         return false;
     }
 
-    device->base.handle_request = powersensor_handle_request;
-
-    sinricpro_power_sensor_init(&device->power_sensor);
-
     SINRICPRO_DEBUG_PRINTF("[PowerSensor] Initialized device: %s\n", device_id);
     return true;
 }
@@ -43,12 +42,3 @@ bool sinricpro_powersensor_send_power_event(sinricpro_powersensor_t *device,
                                               voltage, current, power,
                                               apparent_power, reactive_power, factor);
 }
-
-static bool powersensor_handle_request(sinricpro_device_t *device,
-                                         const char *action,
-                                         const cJSON *request,
-                                         cJSON *response) {
-    // Power sensor is event-only, no incoming commands
-    SINRICPRO_WARN_PRINTF("[PowerSensor] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,35 +4,29 @@
  */
 
 #include "sinricpro/sinricpro_switch.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/power_state.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-// Forward declaration
-static bool switch_handle_request(sinricpro_device_t *device,
-                                  const char *action,
-                                  const cJSON *request,
-                                  cJSON *response);
+static const sinricpro_capability_slot_t switch_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_switch_t, power_state, sinricpro_capability_power_state),
+};
+
+static const sinricpro_device_model_t switch_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_SWITCH, switch_slots);
 
 bool sinricpro_switch_init(sinricpro_switch_t *device, const char *device_id) {
     if (!device || !device_id) {
         return false;
     }
 
-    // Initialize base device
-    if (!sinricpro_device_init(&device->base, device_id,
-                               SINRICPRO_DEVICE_TYPE_SWITCH)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &switch_model)) {
         return false;
     }
 
-    // Set request handler
-    device->base.handle_request = switch_handle_request;
-
-    // Initialize capabilities
-    sinricpro_power_state_init(&device->power_state);
-
     SINRICPRO_DEBUG_PRINTF("[Switch] Initialized device: %s\n", device_id);
     return true;
 }
@@ -61,23 +55,3 @@ bool sinricpro_switch_get_power_state(const sinricpro_switch_t *device) {
 
     return sinricpro_power_state_get_state(&device->power_state);
 }
-
-// ============================================================================
-// Internal Functions
-// ============================================================================
-
-static bool switch_handle_request(sinricpro_device_t *device,
-                                  const char *action,
-                                  const cJSON *request,
-                                  cJSON *response) {
-    // Cast to switch device
-    sinricpro_switch_t *sw = (sinricpro_switch_t *)device;
-
-    if (strcmp(action, "setPowerState") == 0) {
-        return sinricpro_power_state_handle_request(&sw->power_state,
-                                                    device, request, response);
-    }
-
-    SINRICPRO_WARN_PRINTF("[Switch] Unknown action: %s\n", action);
-    return false;
-}
@@ -4,17 +4,20 @@
  */
 
 #include "sinricpro/sinricpro_temperature_sensor.h"
+#include "sinricpro/sinricpro_capability.h"
 #include "sinricpro/capabilities/temperature_sensor.h"
 #include "core/json_helpers.h"
 #include "core/sinricpro_debug.h"
 #include <stdio.h>
 #include <string.h>
 
-// Forward declaration
-static bool temp_sensor_handle_request(sinricpro_device_t *device,
-                                       const char *action,
-                                       const cJSON *request,
-                                       cJSON *response);
+static const sinricpro_capability_slot_t temp_sensor_slots[] = {
+    SINRICPRO_CAPABILITY(sinricpro_temperature_sensor_t, temp_humidity,
+                         sinricpro_capability_temperature_sensor),
+};
+
+static const sinricpro_device_model_t temp_sensor_model =
+    SINRICPRO_DEVICE_MODEL(SINRICPRO_DEVICE_TYPE_TEMPERATURE_SENSOR, temp_sensor_slots);
 
 bool sinricpro_temperature_sensor_init(sinricpro_temperature_sensor_t *device,
                                        const char *device_id) {
@@ -22,18 +25,10 @@ bool sinricpro_temperature_sensor_init(sinricpro_temperature_sensor_t *device,
         return false;
     }
 
-    // Initialize base device
-    if (!sinricpro_device_init(&device->base, device_id,
-                               SINRICPRO_DEVICE_TYPE_TEMPERATURE_SENSOR)) {
+    if (!sinricpro_device_compose(&device->base, device_id, &temp_sensor_model)) {
         return false;
     }
 
-    // Set request handler
-    device->base.handle_request = temp_sensor_handle_request;
-
-    // Initialize capabilities
-    sinricpro_temperature_sensor_cap_init(&device->temp_humidity);
-
     SINRICPRO_DEBUG_PRINTF("[TempSensor] Initialized device: %s\n", device_id);
     return true;
 }
@@ -50,15 +45,3 @@ bool sinricpro_temperature_sensor_send_event(sinricpro_temperature_sensor_t *dev
                                                        temperature,
                                                        humidity);
 }
-
-// Handle incoming requests (sensors typically don't receive many commands)
-static bool temp_sensor_handle_request(sinricpro_device_t *device,
-                                       const char *action,
-                                       const cJSON *request,
-                                       cJSON *response) {
-    // Temperature sensors are event-only devices
-    // Could implement state query if needed in future
-
-    SINRICPRO_WARN_PRINTF("[TempSensor] Unknown action: %s\n", action);
-    return false;
-}
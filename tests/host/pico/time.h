@@ -0,0 +1,31 @@
+/**
+ * @file time.h
+ * @brief Host stand-in for pico/time.h with a clock the test sets
+ *
+ * Only what the modules under test use. Time advances when the test
+ * changes host_clock_ms, never on its own.
+ */
+
+#ifndef SINRICPRO_HOST_PICO_TIME_H
+#define SINRICPRO_HOST_PICO_TIME_H
+
+#include <stdint.h>
+
+typedef uint64_t absolute_time_t;
+
+// Milliseconds since boot, wrapping like the Pico's 32-bit millisecond clock
+extern uint32_t host_clock_ms;
+
+static inline absolute_time_t get_absolute_time(void) {
+    return (absolute_time_t)host_clock_ms * 1000u;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+static inline uint64_t time_us_64(void) {
+    return (uint64_t)host_clock_ms * 1000u;
+}
+
+#endif // SINRICPRO_HOST_PICO_TIME_H
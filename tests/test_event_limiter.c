@@ -0,0 +1,245 @@
+/**
+ * @file test_event_limiter.c
+ * @brief Host test of the event limiter on recorded event timings
+ *
+ * Replays each trace through both policies the way a capability uses its
+ * limiter: an allowed event is sent, a blocked one is deferred, and the
+ * SDK's scan every SINRICPRO_EVENT_DEFER_SCAN_MS releases the latest
+ * deferred value once the limiter allows it. The per-event decisions and
+ * the releases are checked against the expected sequence, once from a
+ * normal boot time and once across the 32-bit millisecond clock wrap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "event_limiter.h"
+#include "pico/time.h"
+
+#define STATE_MS        1000    // Limit used for the expectations below
+#define BUCKET_BURST    3
+#define TRACE_START_MS  10000u
+#define WRAP_START_MS   (UINT32_MAX - 499u)     // Clock wraps 500 ms into the trace
+#define SETTLE_MS       3000    // Replayed past the last event for releases
+#define MAX_EVENTS      64
+#define MAX_RELEASES    4
+
+uint32_t host_clock_ms;
+
+static int failures;
+
+#define CHECK(cond, ...)                                            \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);             \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+// =============================================================================
+// Recorded Traces
+// =============================================================================
+
+// Event times in ms from the start of the trace; periodic traces have no
+// list and repeat every period_ms
+typedef struct {
+    const char *name;
+    const uint32_t *times;
+    size_t count;
+    uint32_t period_ms;
+} trace_t;
+
+// Deferred value (the event's index) released by a scan, at ms into the trace
+typedef struct {
+    size_t index;
+    uint32_t at_ms;
+} release_t;
+
+// Per event 'S' (sent) or 'D' (deferred), then the releases in order
+typedef struct {
+    const char *decisions;
+    size_t release_count;
+    release_t releases[MAX_RELEASES];
+} expect_t;
+
+typedef struct {
+    trace_t trace;
+    expect_t distance;
+    expect_t bucket;
+} case_t;
+
+static const uint32_t double_press[] = { 0, 300 };
+static const uint32_t on_off_on[] = { 0, 400, 850 };
+static const uint32_t contact_bounce[] = { 0, 20, 45, 70, 2000, 2030 };
+static const uint32_t lights_scene[] = { 0, 150, 300, 5000, 5100, 12000 };
+
+#define LIST(name, times) { name, times, sizeof(times) / sizeof(times[0]), 0 }
+
+static const case_t cases[] = {
+    { LIST("double press", double_press),
+      { "SD", 1, { { 1, 1000 } } },
+      { "SS", 0, { { 0 } } } },
+    { LIST("on-off-on", on_off_on),
+      { "SDD", 1, { { 2, 1000 } } },
+      { "SSS", 0, { { 0 } } } },
+    { LIST("contact bounce", contact_bounce),
+      { "SDDDSD", 2, { { 3, 1000 }, { 5, 3000 } } },
+      { "SSSDSD", 2, { { 3, 1000 }, { 5, 3000 } } } },
+    { LIST("scene changes", lights_scene),
+      { "SDDSDS", 2, { { 2, 1000 }, { 4, 6000 } } },
+      { "SSSSSS", 0, { { 0 } } } },
+    { { "dimmer drag (10/s, 2 s)", NULL, 20, 100 },
+      { "SDDDDDDDDD" "SDDDDDDDDD", 1, { { 19, 2000 } } },
+      { "SSSDDDDDDD" "SDDDDDDDDD", 1, { { 19, 2000 } } } },
+    { { "motion retrigger (2.5 s)", NULL, 24, 2500 },
+      { "SSSSSSSSSSSSSSSSSSSSSSSS", 0, { { 0 } } },
+      { "SSSSSSSSSSSSSSSSSSSSSSSS", 0, { { 0 } } } },
+    { { "stuck button (5/s, 12 s)", NULL, 60, 200 },
+      { "SDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDD", 1, { { 59, 12000 } } },
+      { "SSSDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDDSDDDD", 1, { { 59, 12000 } } } },
+};
+
+// =============================================================================
+// Replay
+// =============================================================================
+
+static uint32_t event_offset(const trace_t *trace, size_t i) {
+    return trace->times ? trace->times[i] : (uint32_t)i * trace->period_ms;
+}
+
+// A capability's send: blocked values wait in the limiter
+static bool send(sinricpro_event_limiter_t *limiter, size_t index) {
+    if (sinricpro_event_limiter_check(limiter)) {
+        sinricpro_event_value_t latest = { .level = (int32_t)index };
+        sinricpro_event_limiter_defer(limiter, SINRICPRO_ACTION_SET_BRIGHTNESS, &latest);
+        return false;
+    }
+    return true;
+}
+
+static void replay(const trace_t *trace, sinricpro_event_limiter_t *limiter,
+                   const expect_t *expect, const char *policy, uint32_t start_ms) {
+    char decisions[MAX_EVENTS + 1] = {0};
+    release_t releases[MAX_RELEASES];
+    size_t release_count = 0;
+    size_t next = 0;
+
+    sinricpro_event_limiter_set_trailing(limiter, true);
+
+    uint32_t end = event_offset(trace, trace->count - 1) + SETTLE_MS;
+    for (uint32_t t = 0; t <= end; t++) {
+        host_clock_ms = start_ms + t;
+
+        while (next < trace->count && event_offset(trace, next) == t) {
+            decisions[next] = send(limiter, next) ? 'S' : 'D';
+            next++;
+        }
+
+        if (t % SINRICPRO_EVENT_DEFER_SCAN_MS != 0) continue;
+
+        sinricpro_action_t action;
+        sinricpro_event_value_t value;
+        uint64_t captured_us;
+        if (!sinricpro_event_limiter_take_deferred(limiter, &action, &value, &captured_us)) {
+            continue;
+        }
+
+        // The release goes through the same check as any other send
+        size_t index = (size_t)value.level;
+        CHECK(send(limiter, index), "%s/%s: release of event %u blocked at %u ms",
+              trace->name, policy, (unsigned)index, (unsigned)t);
+        CHECK(captured_us == (uint64_t)(uint32_t)(start_ms + event_offset(trace, index)) * 1000u,
+              "%s/%s: release of event %u has the wrong capture time",
+              trace->name, policy, (unsigned)index);
+        if (release_count < MAX_RELEASES) {
+            releases[release_count++] = (release_t){ index, t };
+        }
+    }
+
+    CHECK(strcmp(decisions, expect->decisions) == 0, "%s/%s at %u: decisions %s, expected %s",
+          trace->name, policy, (unsigned)start_ms, decisions, expect->decisions);
+    CHECK(release_count == expect->release_count, "%s/%s at %u: %u releases, expected %u",
+          trace->name, policy, (unsigned)start_ms, (unsigned)release_count,
+          (unsigned)expect->release_count);
+    for (size_t i = 0; i < release_count && i < expect->release_count; i++) {
+        CHECK(releases[i].index == expect->releases[i].index &&
+              releases[i].at_ms == expect->releases[i].at_ms,
+              "%s/%s at %u: release %u is event %u at %u ms, expected event %u at %u ms",
+              trace->name, policy, (unsigned)start_ms, (unsigned)i,
+              (unsigned)releases[i].index, (unsigned)releases[i].at_ms,
+              (unsigned)expect->releases[i].index, (unsigned)expect->releases[i].at_ms);
+    }
+}
+
+static void test_traces(uint32_t start_ms) {
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        sinricpro_event_limiter_t distance;
+        sinricpro_event_limiter_t bucket;
+        sinricpro_event_limiter_init(&distance, STATE_MS);
+        sinricpro_event_limiter_init_bucket(&bucket, STATE_MS, BUCKET_BURST);
+
+        replay(&cases[c].trace, &distance, &cases[c].distance, "distance", start_ms);
+        replay(&cases[c].trace, &bucket, &cases[c].bucket, "bucket", start_ms);
+    }
+}
+
+// =============================================================================
+// Clock Wrap
+// =============================================================================
+
+// next_event_time wraps past zero while the clock hasn't yet
+static void test_next_event_time_wrap(void) {
+    sinricpro_event_limiter_t limiter;
+    sinricpro_event_limiter_init(&limiter, STATE_MS);
+
+    uint32_t start = UINT32_MAX - 100u;
+    CHECK(!sinricpro_event_limiter_check_at(&limiter, start), "wrap: first event blocked");
+    CHECK(limiter.next_event_time == STATE_MS - 101u, "wrap: next_event_time %u",
+          (unsigned)limiter.next_event_time);
+
+    host_clock_ms = start + 50u;
+    CHECK(sinricpro_event_limiter_time_remaining(&limiter) == STATE_MS - 50u,
+          "wrap: %u ms remaining before the wrap",
+          (unsigned)sinricpro_event_limiter_time_remaining(&limiter));
+    CHECK(sinricpro_event_limiter_check_at(&limiter, start + 50u),
+          "wrap: event before the clock wraps allowed");
+
+    host_clock_ms = 500u;
+    CHECK(sinricpro_event_limiter_time_remaining(&limiter) == STATE_MS - 601u,
+          "wrap: %u ms remaining after the wrap",
+          (unsigned)sinricpro_event_limiter_time_remaining(&limiter));
+    CHECK(sinricpro_event_limiter_check_at(&limiter, 500u), "wrap: early event after the wrap allowed");
+    CHECK(!sinricpro_event_limiter_check_at(&limiter, STATE_MS - 101u),
+          "wrap: event at next_event_time blocked");
+}
+
+// A limiter idle for longer than half the clock range is not held back
+static void test_long_idle(void) {
+    sinricpro_event_limiter_t limiter;
+    sinricpro_event_limiter_init(&limiter, STATE_MS);
+
+    CHECK(!sinricpro_event_limiter_check_at(&limiter, TRACE_START_MS), "idle: first event blocked");
+
+    uint32_t later = TRACE_START_MS + 30u * 24u * 3600u * 1000u;
+    host_clock_ms = later;
+    CHECK(sinricpro_event_limiter_time_remaining(&limiter) == 0, "idle: %u ms remaining",
+          (unsigned)sinricpro_event_limiter_time_remaining(&limiter));
+    CHECK(!sinricpro_event_limiter_check_at(&limiter, later), "idle: event after 30 days blocked");
+}
+
+int main(void) {
+    test_traces(TRACE_START_MS);
+    test_traces(WRAP_START_MS);
+    test_next_event_time_wrap();
+    test_long_idle();
+
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("event limiter: all traces passed\n");
+    return EXIT_SUCCESS;
+}